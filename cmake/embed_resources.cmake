@@ -0,0 +1,45 @@
+# dpsg_embed_resources(<target> NAMESPACE <name> BASE_DIR <dir> FILES <file>...)
+#
+# Creates an interface library <target> providing "embedded/<name>.hpp". In
+# that header, each file is a dpsg::embedded_file in namespace
+# dpsg::embedded::<name>, named after its path relative to BASE_DIR
+# (shaders/basic.fs becomes shaders_basic_fs), and 'directory' lists all of
+# them. The header is generated at build time and regenerated whenever one of
+# the files changes.
+include(CMakeParseArguments)
+
+set(DPSG_EMBED_RESOURCES_SCRIPT
+    "${CMAKE_CURRENT_LIST_DIR}/embed_resources_generate.cmake")
+
+function(dpsg_embed_resources TARGET_NAME)
+  cmake_parse_arguments(EMBED "" "NAMESPACE;BASE_DIR" "FILES" ${ARGN})
+  get_filename_component(base_dir "${EMBED_BASE_DIR}" ABSOLUTE)
+  set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}")
+  set(header "${output_dir}/embedded/${EMBED_NAMESPACE}.hpp")
+
+  set(absolute_files)
+  set(relative_files)
+  foreach(file ${EMBED_FILES})
+    get_filename_component(absolute "${file}" ABSOLUTE)
+    file(RELATIVE_PATH relative "${base_dir}" "${absolute}")
+    list(APPEND absolute_files "${absolute}")
+    list(APPEND relative_files "${relative}")
+  endforeach(file ${EMBED_FILES})
+  # Lists can't be passed through the command line as is.
+  string(REPLACE ";" "|" relative_files "${relative_files}")
+
+  add_custom_command(OUTPUT "${header}"
+    COMMAND "${CMAKE_COMMAND}"
+            "-DNAMESPACE=${EMBED_NAMESPACE}"
+            "-DBASE_DIR=${base_dir}"
+            "-DFILES=${relative_files}"
+            "-DOUTPUT=${header}"
+            -P "${DPSG_EMBED_RESOURCES_SCRIPT}"
+    DEPENDS ${absolute_files} "${DPSG_EMBED_RESOURCES_SCRIPT}"
+    COMMENT "Embedding resources in ${header}"
+    VERBATIM)
+
+  add_library(${TARGET_NAME} INTERFACE)
+  target_sources(${TARGET_NAME} INTERFACE "${header}")
+  target_include_directories(${TARGET_NAME} INTERFACE "${output_dir}")
+endfunction(dpsg_embed_resources TARGET_NAME)
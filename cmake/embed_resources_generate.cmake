@@ -0,0 +1,42 @@
+# Writes the header described in embed_resources.cmake. Run in script mode:
+#   cmake -DNAMESPACE=<name> -DBASE_DIR=<dir> -DFILES=<a|b|...>
+#         -DOUTPUT=<header> -P embed_resources_generate.cmake
+string(REPLACE "|" ";" files "${FILES}")
+string(TOUPPER "${NAMESPACE}" guard)
+
+# CMake regular expressions have no repetition count.
+set(line_of_bytes "")
+foreach(i RANGE 15)
+  set(line_of_bytes "${line_of_bytes}0x[0-9a-f][0-9a-f], ")
+endforeach(i RANGE 15)
+
+set(content "// Generated from ${BASE_DIR} by cmake/embed_resources.cmake.\n")
+set(content "${content}#ifndef GUARD_DPSG_EMBEDDED_${guard}_HEADER\n")
+set(content "${content}#define GUARD_DPSG_EMBEDDED_${guard}_HEADER\n\n")
+set(content "${content}#include \"embedded.hpp\"\n\n")
+set(content "${content}namespace dpsg::embedded::${NAMESPACE} {\n\n")
+
+set(identifiers "")
+list(LENGTH files count)
+foreach(file ${files})
+  string(MAKE_C_IDENTIFIER "${file}" identifier)
+  file(READ "${BASE_DIR}/${file}" hex HEX)
+  string(LENGTH "${hex}" hex_length)
+  math(EXPR size "${hex_length} / 2")
+  string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1, " bytes "${hex}")
+  string(REGEX REPLACE "(${line_of_bytes})" "\\1\n    " bytes "${bytes}")
+
+  set(content "${content}constexpr inline unsigned char ${identifier}_data[] = {\n")
+  set(content "${content}    ${bytes}0x00};\n")
+  set(content "${content}constexpr inline embedded_file ${identifier}{\n")
+  set(content "${content}    \"${file}\", ${identifier}_data, ${size}};\n\n")
+  set(identifiers "${identifiers}    ${identifier},\n")
+endforeach(file ${files})
+
+set(content "${content}constexpr inline embedded_file files[] = {\n")
+set(content "${content}${identifiers}};\n")
+set(content "${content}constexpr inline embedded_directory directory{files, ${count}};\n\n")
+set(content "${content}}  // namespace dpsg::embedded::${NAMESPACE}\n\n")
+set(content "${content}#endif  // GUARD_DPSG_EMBEDDED_${guard}_HEADER\n")
+
+file(WRITE "${OUTPUT}" "${content}")
@@ -3,8 +3,10 @@
 #include "input_timer.hpp"
 #include "load_shaders.hpp"
 #include "make_window.hpp"
+#include "sampler.hpp"
 #include "stbi_wrapper.hpp"
 #include "structured_buffers.hpp"
+#include "texture_units.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/mat4x4.hpp"
@@ -105,8 +107,15 @@ void camera(dpsg::window& wdw, key_mapper& kmap) {
   auto tex2 =
       load<texture_rgba>(texture_filename("assets/awesomeface.png")).value();
 
-  texture1_u.bind(tex1, gl::texture_name::_0);
-  texture2_u.bind(tex2, gl::texture_name::_1);
+  // Filtering is set once for both textures, with as much anisotropy as the
+  // quality settings allow.
+  texture_units units;
+  sampler_cache samplers;
+  sampler_state filtering = sampler_states::repeat_trilinear;
+  filtering.max_anisotropy = samplers.quality().max_anisotropy;
+  const auto& sampler = samplers.get(filtering);
+  texture1_u.bind(tex1, sampler, units);
+  texture2_u.bind(tex2, sampler, units);
 
   // Buffers
   using layout = packed<group<3>, group<2>>;
@@ -127,7 +136,7 @@ void camera(dpsg::window& wdw, key_mapper& kmap) {
   };
   wdw.set_framebuffer_size_callback(ignore([&aspect_ratio](width w, height h) {
     aspect_ratio = static_cast<float>(w.value) / static_cast<float>(h.value);
-    glViewport(0, 0, w.value, h.value);
+    set_viewport(w, h);
   }));
 
   glm::vec3 camera_front = default_camera_front;
@@ -9,6 +9,7 @@
 #include "make_window.hpp"
 #include "stbi_wrapper.hpp"
 #include "structured_buffers.hpp"
+#include "texture_units.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/mat4x4.hpp"
@@ -104,8 +105,9 @@ void camera_class(kmap_window& wdw) {
   auto tex2 =
       load<texture_rgba>(texture_filename("assets/awesomeface.png")).value();
 
-  texture1_u.bind(tex1, gl::texture_name::_0);
-  texture2_u.bind(tex2, gl::texture_name::_1);
+  texture_units units;
+  texture1_u.bind(tex1, units);
+  texture2_u.bind(tex2, units);
 
   // Buffers
   using layout = packed<group<3>, group<2>>;
@@ -118,7 +120,7 @@ void camera_class(kmap_window& wdw) {
 
   wdw.set_framebuffer_size_callback(ignore([&cam](width w, height h) {
     cam.aspect_ratio(w, h);
-    glViewport(0, 0, w.value, h.value);
+    set_viewport(w, h);
   }));
 
   wdw.set_input_mode(cursor_mode::disabled);
@@ -0,0 +1,103 @@
+#include "bc_encoder.hpp"
+#include "mipmap.hpp"
+
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+bool compress(const char* filename, dpsg::bc_format format) {
+  int width{};
+  int height{};
+  int channels{};
+  // Rows are stored bottom first, as load() flips the images by default, so
+  // that load_compressed() textures are oriented the same way.
+  stbi_set_flip_vertically_on_load(1);
+  stbi_uc* decoded = stbi_load(filename, &width, &height, &channels, 4);
+  if (decoded == nullptr) {
+    std::cerr << filename << ": " << stbi_failure_reason() << std::endl;
+    return false;
+  }
+  // Color formats are filtered in linear space, data formats as is.
+  const bool srgb =
+      format == dpsg::bc_format::bc1 || format == dpsg::bc_format::bc3;
+  const auto chain = dpsg::build_mip_chain(decoded,
+                                           static_cast<unsigned int>(width),
+                                           static_cast<unsigned int>(height),
+                                           4,
+                                           {dpsg::mip_filter::kaiser, srgb});
+  stbi_image_free(decoded);
+
+  const auto levels = static_cast<unsigned int>(chain.levels.size());
+  const std::string output = std::string{filename} + ".dds";
+  std::ofstream file{output, std::ios::binary};
+  const auto header = dpsg::dds_header(format,
+                                       static_cast<unsigned int>(width),
+                                       static_cast<unsigned int>(height),
+                                       levels);
+  file.write(reinterpret_cast<const char*>(header.data()),  // NOLINT
+             static_cast<std::streamsize>(header.size()));
+
+  const auto start = std::chrono::steady_clock::now();
+  // With 4 channels, mip_chain rows are not padded.
+  for (const auto& image : chain.image_levels()) {
+    const auto blocks = dpsg::encode_bc(
+        image.pixels, image.width.value, image.height.value, format);
+    file.write(reinterpret_cast<const char*>(blocks.data()),  // NOLINT
+               static_cast<std::streamsize>(blocks.size()));
+  }
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  if (!file) {
+    std::cerr << output << ": write failed" << std::endl;
+    return false;
+  }
+  std::cout << output << ": " << width << "x" << height << ", " << levels
+            << " levels encoded in " << ms << "ms" << std::endl;
+  return true;
+}
+}  // namespace
+
+// Compresses images to DDS files that load_compressed() uploads as is:
+//
+//    compress_textures [--bc1|--bc3|--bc4|--bc5] image...
+//
+// BC1 (the default) suits opaque color textures, BC3 those with an alpha
+// channel, BC4 single channel masks and BC5 normal maps. Each image gets a
+// full mipmap chain (see build_mip_chain()) and is written next to it, with
+// ".dds" appended.
+int main(int argc, char** argv) {
+  dpsg::bc_format format = dpsg::bc_format::bc1;
+  int failures = 0;
+  int files = 0;
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];  // NOLINT
+    if (std::strcmp(arg, "--bc1") == 0) {
+      format = dpsg::bc_format::bc1;
+    }
+    else if (std::strcmp(arg, "--bc3") == 0) {
+      format = dpsg::bc_format::bc3;
+    }
+    else if (std::strcmp(arg, "--bc4") == 0) {
+      format = dpsg::bc_format::bc4;
+    }
+    else if (std::strcmp(arg, "--bc5") == 0) {
+      format = dpsg::bc_format::bc5;
+    }
+    else {
+      ++files;
+      failures += compress(arg, format) ? 0 : 1;
+    }
+  }
+  if (files == 0) {
+    std::cerr << "usage: " << argv[0] << " [--bc1|--bc3|--bc4|--bc5] image..."
+              << std::endl;
+    return 1;
+  }
+  return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
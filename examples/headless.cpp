@@ -0,0 +1,283 @@
+#include "make_headless_window.hpp"
+#include "opengl.hpp"
+
+#include "bc_encoder.hpp"
+#include "compressed_texture.hpp"
+#include "load_shaders.hpp"
+#include "program_cache.hpp"
+#include "shader_reloader.hpp"
+#include "shader_variants.hpp"
+#include "structured_buffers.hpp"
+#include "texture_array.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Edits a copy of the shaders a few times and checks that every program the
+// reloader swapped out was deleted.
+[[nodiscard]] bool check_reload_leaks() {
+  using namespace dpsg;
+  namespace fs = std::filesystem;
+
+  const fs::path dir = fs::temp_directory_path() / "dpsg_headless_reload";
+  fs::create_directories(dir);
+  const fs::path vs = dir / "attributes.vs";
+  const fs::path frag = dir / "basic.fs";
+  fs::copy_file(
+      "shaders/attributes.vs", vs, fs::copy_options::overwrite_existing);
+  fs::copy_file(
+      "shaders/basic.fs", frag, fs::copy_options::overwrite_existing);
+
+  shader_reloader reloader{std::chrono::milliseconds{10}};
+  auto prog =
+      reloader.load(vs_filename{vs.string()}, fs_filename{frag.string()})
+          .value();
+
+  constexpr std::size_t reloads = 3;
+  std::vector<gl::program_id> created{prog->id()};
+  for (std::size_t i = 0; i < reloads; ++i) {
+    const std::size_t generation = prog.generation();
+    std::ofstream{frag, std::ios::app} << "// edit " << i << '\n';
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (prog.generation() == generation &&
+           std::chrono::steady_clock::now() < deadline) {
+      for (const auto& error : reloader.update()) {
+        std::cerr << error.what() << std::endl;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    if (prog.generation() == generation) {
+      std::cerr << "Shader edit " << i << " wasn't picked up" << std::endl;
+      return false;
+    }
+    created.push_back(prog->id());
+  }
+
+  // A swapped out program must be gone, unless the driver already handed its
+  // name out again to a later generation, which implies it was deleted.
+  std::size_t leaked = 0;
+  for (auto it = created.begin(); it + 1 != created.end(); ++it) {
+    const bool reused =
+        std::any_of(it + 1, created.end(), [it](gl::program_id id) {
+          return id.value == it->value;
+        });
+    if (!reused && glIsProgram(it->value) == GL_TRUE) {
+      ++leaked;
+    }
+  }
+
+  std::cout << "programs created over " << reloads
+            << " reloads: " << created.size() << ", still alive after "
+            << "being swapped out: " << leaked << std::endl;
+  if (leaked != 0) {
+    std::cerr << "Reloading leaks program objects" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Loads the same program twice through an empty cache: the first load must
+// write the binary to disk and the second one must be served from it.
+[[nodiscard]] bool check_program_cache() {
+  using namespace dpsg;
+  namespace fs = std::filesystem;
+
+  const fs::path dir = fs::temp_directory_path() / "dpsg_headless_cache";
+  fs::remove_all(dir);
+  program_cache cache{dir};
+  if (!cache.enabled()) {
+    std::cout << "program binaries unsupported, skipping the cache check"
+              << std::endl;
+    return true;
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    auto prog = cache.load(vs_filename{"shaders/attributes.vs"},
+                           fs_filename{"shaders/basic.fs"});
+    if (!prog.has_value()) {
+      std::cerr << prog.error().what() << std::endl;
+      return false;
+    }
+  }
+
+  const auto& stats = cache.stats();
+  std::cout << "program cache: " << stats.hits << " hit(s), " << stats.misses
+            << " miss(es), " << stats.rejected << " rejected" << std::endl;
+  // A driver may refuse its own binary, which still counts as a lookup.
+  if (stats.hits + stats.rejected != 1) {
+    std::cerr << "The program cache didn't serve the second load"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Packs the two 512x512 RGB assets into a single array texture, which must
+// use immutable storage when the context supports it.
+[[nodiscard]] bool check_texture_array() {
+  using namespace dpsg;
+
+  texture_array_packer packer;
+  auto container = packer.add<texture_rgb>(
+      texture_filename{"assets/container.jpg"});
+  auto wall = packer.add<texture_rgb>(texture_filename{"assets/wall.jpg"});
+  if (!container.has_value() || !wall.has_value()) {
+    std::cerr << (container.has_value() ? wall : container).error().what()
+              << std::endl;
+    return false;
+  }
+  if (packer.arrays() != 1 || container.value().layer != 0 ||
+      wall.value().layer != 1) {
+    std::cerr << "Same sized images weren't packed in one array" << std::endl;
+    return false;
+  }
+
+  auto arrays = packer.build(texture_options::repeat_linear);
+  arrays[wall.value().array].bind();
+  gl::int_t immutable{GL_FALSE};
+  glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_IMMUTABLE_FORMAT,
+                      &immutable);
+  const bool expected = detail::has_texture_storage();
+  std::cout << "texture array storage: "
+            << (immutable == GL_TRUE ? "immutable" : "mutable") << std::endl;
+  if ((immutable == GL_TRUE) != expected) {
+    std::cerr << "Texture array storage doesn't match the context"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Writes a BC1 DDS file the way compress_textures does, with a single level,
+// and uploads it with load_compressed.
+[[nodiscard]] bool check_compressed_texture() {
+  using namespace dpsg;
+  namespace fs = std::filesystem;
+
+  if (!detail::supports(gl::compressed_internal_format::rgba_s3tc_dxt1)) {
+    std::cout << "S3TC unsupported, skipping the compressed texture check"
+              << std::endl;
+    return true;
+  }
+
+  int width{};
+  int height{};
+  int channels{};
+  stbi_set_flip_vertically_on_load(1);
+  stbi_uc* decoded =
+      stbi_load("assets/container.jpg", &width, &height, &channels, 4);
+  if (decoded == nullptr) {
+    std::cerr << "assets/container.jpg: " << stbi_failure_reason()
+              << std::endl;
+    return false;
+  }
+  const auto w = static_cast<unsigned int>(width);
+  const auto h = static_cast<unsigned int>(height);
+  const auto blocks = encode_bc(decoded, w, h, bc_format::bc1);
+  stbi_image_free(decoded);
+
+  const fs::path path = fs::temp_directory_path() / "dpsg_headless.dds";
+  {
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    const auto header = dds_header(bc_format::bc1, w, h, 1);
+    file.write(reinterpret_cast<const char*>(header.data()),  // NOLINT
+               static_cast<std::streamsize>(header.size()));
+    file.write(reinterpret_cast<const char*>(blocks.data()),  // NOLINT
+               static_cast<std::streamsize>(blocks.size()));
+  }
+
+  auto texture = load_compressed(texture_filename{path.string()});
+  if (!texture.has_value()) {
+    std::cerr << texture.error().what() << std::endl;
+    return false;
+  }
+  texture.value().bind();
+  gl::int_t format{0};
+  glGetTexLevelParameteriv(
+      GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+  std::cout << "compressed texture: " << width << "x" << height << ", "
+            << blocks.size() << " bytes" << std::endl;
+  if (format != GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) {
+    std::cerr << "The DDS file wasn't uploaded as BC1" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Renders the colored triangle offscreen for a fixed number of frames and
+// reports the throughput. Runs without any display server, e.g. on llvmpipe.
+void headless_triangle(headless_window& wdw) {
+  using namespace dpsg;
+
+  auto variants =
+      shader_variants::load(vs_filename{"shaders/attributes.vs"},
+                            fs_filename{"shaders/basic.fs"},
+                            {"COLOR"})
+          .value();
+  const auto& shader = variants.get(variants.mask("COLOR")).value();
+
+  // clang-format off
+  constexpr float vertices[] = {
+      // positions        // colors
+      0.0F,  0.5F,  0.0F, 0.0F, 0.0F, 1.0F,  // top NOLINT
+      -0.5F, -0.5F, 0.0F, 0.0F, 1.0F, 0.0F,  // bottom left NOLINT
+      0.5F,  -0.5F, 0.0F, 1.0F, 0.0F, 0.0F,  // bottom right NOLINT
+  };
+  // clang-format on
+
+  using packed_layout = packed<group<3>, group<3>>;
+  fixed_size_structured_buffer b(packed_layout{}, vertices);
+  b.enable();
+
+  shader.use();
+  gl::clear_color(gl::g{0.3F}, gl::r{0.2F}, gl::b{0.3F});  // NOLINT
+
+  constexpr std::size_t frames = 1000;
+  auto start = std::chrono::steady_clock::now();
+  wdw.render_loop([&] {
+    gl::clear(gl::buffer_bit::color);
+    b.draw();
+    if (wdw.frame_count() + 1 >= frames) {
+      close(wdw);
+    }
+  });
+  glFinish();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  auto dims = wdw.framebuffer_size();
+  std::vector<gl::ubyte_t> pixels(
+      static_cast<std::size_t>(dims.width.value * dims.height.value) * 4);
+  wdw.read_pixels(pixels.data());
+  const std::size_t center =
+      (static_cast<std::size_t>(dims.height.value / 2 * dims.width.value) +
+       static_cast<std::size_t>(dims.width.value / 2)) *
+      4;
+
+  std::cout << wdw.frame_count() << " frames in " << elapsed.count()
+            << "s (" << static_cast<double>(wdw.frame_count()) / elapsed.count()
+            << " fps)\ncenter pixel: "
+            << static_cast<int>(pixels[center]) << ", "
+            << static_cast<int>(pixels[center + 1]) << ", "
+            << static_cast<int>(pixels[center + 2]) << std::endl;
+}
+
+int main() {
+  return headless([](headless_window& wdw) {
+    const bool reload_ok = check_reload_leaks();
+    const bool cache_ok = check_program_cache();
+    const bool array_ok = check_texture_array();
+    const bool compressed_ok = check_compressed_texture();
+    headless_triangle(wdw);
+    return reload_ok && cache_ok && array_ok && compressed_ok
+               ? dpsg::ExecutionStatus::Success
+               : dpsg::ExecutionStatus::Failure;
+  });
+}
@@ -2,8 +2,10 @@
 
 #include "buffers.hpp"
 #include "camera.hpp"
+#include "command_buffer.hpp"
 #include "common.hpp"
 #include "fixed_size_element_buffer.hpp"
+#include "flat_hierarchy.hpp"
 #include "glfw_controls.hpp"
 #include "glm_traits.hpp"
 #include "input_timer.hpp"
@@ -16,8 +18,13 @@
 #include "stbi_wrapper.hpp"
 #include "structured_buffers.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 using dpsg::leaf;
 struct scale : leaf {
@@ -212,77 +219,68 @@ constexpr auto print(H& model) noexcept {
   });
 }
 
-constexpr auto gl_draw =
-    [](auto& mstack, const auto& loc, const auto& elements) {
-      return [&mstack, &loc, &elements](
-                 const auto& v, auto next, glm::mat4& matrix) {
-        using value_type = std::decay_t<decltype(v)>;
+// Local transformation of the nodes of the model. draw_t is handled
+// separately, through flat_hierarchy::indices_of.
+constexpr auto local_transform = [](const auto& v, glm::mat4& matrix) {
+  using value_type = std::decay_t<decltype(v)>;
 
-        if constexpr (dpsg::is_composite_v<value_type>) {
-          mstack.push(next);
-        }
-        else if constexpr (std::is_base_of_v<rotation, value_type>) {
-          matrix = glm::rotate(matrix, v.angle.value, v.value);
-        }
-        else if constexpr (std::is_same_v<position, value_type>) {
-          matrix = glm::translate(matrix, v.value);
-        }
-        else if constexpr (std::is_same_v<scale, value_type>) {
-          matrix = glm::scale(matrix, v.value);
-        }
-        else if constexpr (std::is_same_v<draw_t, value_type>) {
-          loc.bind(matrix);
-          elements.draw();
-        }
-        else {
-          static_assert(dpsg::is_leaf_v<value_type>, "Non exhaustive");
-        }
-      };
-    };
+  if constexpr (std::is_base_of_v<rotation, value_type>) {
+    matrix = glm::rotate(matrix, v.angle.value, v.value);
+  }
+  else if constexpr (std::is_same_v<position, value_type>) {
+    matrix = glm::translate(matrix, v.value);
+  }
+  else if constexpr (std::is_same_v<scale, value_type>) {
+    matrix = glm::scale(matrix, v.value);
+  }
+  else {
+    static_assert(std::is_same_v<draw_t, value_type>, "Non exhaustive");
+  }
+};
 
 constexpr float full_circle{glm::radians(360.F)};
 constexpr float quarter_circle{glm::radians(90.F)};
 
 constexpr auto base_path = dpsg::path<>;
 template <class H>
-constexpr auto rotate_base(H& model, float angle) noexcept {
-  return ignore([&model, angle] {
-    auto& v = dpsg::extract(base_path.then<y_rotation>, model).angle.value;
+constexpr auto rotate_base(H& flat, float angle) noexcept {
+  return ignore([&flat, angle] {
+    auto& v = flat.extract(base_path.then<y_rotation>).angle.value;
     v = std::fmodf(v + glm::radians(angle), full_circle);
   });
 }
 
 constexpr auto upper_arm_path = base_path.then<struct upper_arm>;
 template <class H>
-constexpr auto rotate_upper_arm(H& model, float angle) noexcept {
-  return ignore([&model, angle] {
-    auto& v = dpsg::extract(upper_arm_path.then<x_rotation>, model).angle.value;
+constexpr auto rotate_upper_arm(H& flat, float angle) noexcept {
+  return ignore([&flat, angle] {
+    auto& v = flat.extract(upper_arm_path.then<x_rotation>).angle.value;
     v = std::clamp(v + glm::radians(angle), -quarter_circle, 0.F);
   });
 }
 
 constexpr auto lower_arm_path = upper_arm_path.then<struct lower_arm>;
 template <class H>
-constexpr auto rotate_lower_arm(H& model, float angle) noexcept {
-  return ignore([&model, angle] {
-    auto& v = dpsg::extract(lower_arm_path.then<x_rotation>, model).angle.value;
+constexpr auto rotate_lower_arm(H& flat, float angle) noexcept {
+  return ignore([&flat, angle] {
+    auto& v = flat.extract(lower_arm_path.then<x_rotation>).angle.value;
     v = std::clamp(v + glm::radians(angle), 0.F, glm::radians(lower_arm_angle));
   });
 }
 
 constexpr auto wrist_path = lower_arm_path.then<struct wrist>;
 template <class H>
-constexpr auto roll_wrist(H& model, float angle) noexcept {
-  return ignore([&model, angle] {
-    auto& v = dpsg::extract(wrist_path.then<z_rotation>, model).angle.value;
+constexpr auto roll_wrist(H& flat, float angle) noexcept {
+  return ignore([&flat, angle] {
+    auto& v = flat.extract(wrist_path.then<z_rotation>).angle.value;
     v = std::fmodf(v + glm::radians(angle), full_circle);
   });
 }
 
 template <class H>
-constexpr auto pitch_wrist(H& model, float angle) noexcept {
-  return ignore([&model, angle] {
-    auto& v = dpsg::extract(wrist_path.then<x_rotation>, model).angle.value;
+constexpr auto pitch_wrist(H& flat, float angle) noexcept {
+  return ignore([&flat, angle] {
+    auto& v = flat.extract(wrist_path.then<x_rotation>).angle.value;
     v = std::clamp(v + glm::radians(angle), 0.F, quarter_circle);
   });
 }
@@ -290,12 +288,10 @@ constexpr auto pitch_wrist(H& model, float angle) noexcept {
 constexpr auto right_finger_path = wrist_path.then<struct right_finger>;
 constexpr auto left_finger_path = wrist_path.then<struct left_finger>;
 template <class H>
-constexpr auto rotate_fingers(H& model, float angle) noexcept {
-  return ignore([&model, angle] {
-    auto& r =
-        dpsg::extract(right_finger_path.then<y_rotation>, model).angle.value;
-    auto& l =
-        dpsg::extract(left_finger_path.then<y_rotation>, model).angle.value;
+constexpr auto rotate_fingers(H& flat, float angle) noexcept {
+  return ignore([&flat, angle] {
+    auto& r = flat.extract(right_finger_path.then<y_rotation>).angle.value;
+    auto& l = flat.extract(left_finger_path.then<y_rotation>).angle.value;
     r = std::clamp(r - glm::radians(angle),
                    -quarter_circle,
                    glm::radians(-angle_upper_finger));
@@ -305,6 +301,92 @@ constexpr auto rotate_fingers(H& model, float angle) noexcept {
   });
 }
 
+// World matrices of the drawn nodes, computed by traversing the model with a
+// matrix_stack, the way it was done before flat_hierarchy.
+template <class H>
+std::vector<glm::mat4> traverse_with_matrix_stack(const H& model) {
+  std::vector<glm::mat4> result;
+  dpsg::matrix_stack<dpsg::traits::glm> stack;
+  dpsg::traverse(
+      model,
+      [&stack, &result](const auto& v, auto next, glm::mat4& matrix) {
+        using value_type = std::decay_t<decltype(v)>;
+        if constexpr (dpsg::is_composite_v<value_type>) {
+          stack.push(next);
+        }
+        else if constexpr (std::is_same_v<draw_t, value_type>) {
+          result.push_back(matrix);
+        }
+        else {
+          local_transform(v, matrix);
+        }
+      },
+      stack.top());
+  return result;
+}
+
+// Same, with a static_matrix_stack sized for the model, pushing the local
+// matrices of 'flat' (numbered in the order of the traversal) with
+// push_multiply.
+template <class F>
+std::vector<glm::mat4> traverse_with_static_matrix_stack(const F& flat) {
+  using hierarchy_type = typename F::hierarchy_type;
+  std::vector<glm::mat4> result;
+  dpsg::static_matrix_stack<dpsg::traits::glm,
+                            dpsg::composite_depth_v<hierarchy_type>>
+      stack;
+  std::size_t node = 0;
+  dpsg::traverse(
+      flat.hierarchy(),
+      [&stack, &result, &flat, &node](const auto& v, auto next) {
+        using value_type = std::decay_t<decltype(v)>;
+        if constexpr (dpsg::is_composite_v<value_type>) {
+          stack.push_multiply(flat.local(node++));
+          next();
+          stack.pop();
+        }
+        else if constexpr (std::is_same_v<draw_t, value_type>) {
+          result.push_back(stack.top());
+        }
+      });
+  return result;
+}
+
+inline bool nearly_equal(const glm::mat4& lhs, const glm::mat4& rhs) noexcept {
+  constexpr float tolerance = 1e-4F;
+  for (int c = 0; c < 4; ++c) {
+    for (int r = 0; r < 4; ++r) {
+      const float diff = std::abs(lhs[c][r] - rhs[c][r]);
+      if (diff > tolerance * std::max(1.F, std::abs(lhs[c][r]))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The three ways of computing the world matrices must agree: flat_hierarchy
+// and static_matrix_stack go through the SIMD multiply, matrix_stack through
+// glm alone.
+template <class F>
+[[nodiscard]] bool check_world_matrices(const F& flat) {
+  constexpr auto& drawn_nodes = F::template indices_of<draw_t>;
+  const auto reference = traverse_with_matrix_stack(flat.hierarchy());
+  const auto fused = traverse_with_static_matrix_stack(flat);
+  bool ok = reference.size() == drawn_nodes.size() &&
+            fused.size() == drawn_nodes.size();
+  for (std::size_t i = 0; ok && i < drawn_nodes.size(); ++i) {
+    ok = nearly_equal(reference[i], flat.world(drawn_nodes[i])) &&
+         nearly_equal(reference[i], fused[i]);
+  }
+  if (!ok) {
+    std::cerr << "World matrices differ between matrix_stack, "
+                 "static_matrix_stack and flat_hierarchy"
+              << std::endl;
+  }
+  return ok;
+}
+
 // clang-format off
 const dpsg::gl::ushort_t index_data[] = {
     0,  1,  2,  // NOLINT
@@ -419,7 +501,6 @@ void hierarchy(kmap_window& wdw) {
   gl::depth_func(gl::compare_function::lequal);
   gl::depth_range(gl::near{0}, gl::far{1});
 
-  matrix_stack<traits::glm> stack;
   camera<traits::glm> camera(SCR_WIDTH / SCR_HEIGHT);
   auto prog = load(vs_filename{"shaders/projected_with_colors.vs"},
                    fs_filename{"shaders/basic.fs"})
@@ -435,6 +516,16 @@ void hierarchy(kmap_window& wdw) {
   fixed_size_element_buffer element_buffer{index_data};
 
   auto model = crane;  // runtime copy, so we can modify it
+  auto flat = flatten<traits::glm>(model, local_transform);
+  constexpr auto& drawn_nodes = decltype(flat)::indices_of<draw_t>;
+  flat.update();
+  if (!check_world_matrices(flat)) {
+    throw std::runtime_error("flattened world matrices don't match traversal");
+  }
+
+  command_buffer queue;
+  const draw_state state{prog.id(), vertex_array.get_vertex_array().id()};
+  const index_range range = whole_range(element_buffer);
 
   // Inputs
   glfw_controls::bind_control_scheme(
@@ -442,23 +533,33 @@ void hierarchy(kmap_window& wdw) {
   wdw.on(key::enter, print(model));
   constexpr float standard_angle_increment = 6.25;
   constexpr float small_angle_increment = 3;
-  wdw.while_(key::M, rotate_base(model, +standard_angle_increment));
-  wdw.while_(key::N, rotate_base(model, -standard_angle_increment));
-  wdw.while_(key::H, rotate_upper_arm(model, +standard_angle_increment));
-  wdw.while_(key::Y, rotate_upper_arm(model, -standard_angle_increment));
-  wdw.while_(key::J, rotate_lower_arm(model, +standard_angle_increment));
-  wdw.while_(key::U, rotate_lower_arm(model, -standard_angle_increment));
-  wdw.while_(key::O, roll_wrist(model, +standard_angle_increment));
-  wdw.while_(key::P, roll_wrist(model, -standard_angle_increment));
-  wdw.while_(key::K, pitch_wrist(model, +standard_angle_increment));
-  wdw.while_(key::I, pitch_wrist(model, -standard_angle_increment));
-  wdw.while_(key::L, rotate_fingers(model, +small_angle_increment));
-  wdw.while_(key::semicolon, rotate_fingers(model, -small_angle_increment));
+  wdw.while_(key::M, rotate_base(flat, +standard_angle_increment));
+  wdw.while_(key::N, rotate_base(flat, -standard_angle_increment));
+  wdw.while_(key::H, rotate_upper_arm(flat, +standard_angle_increment));
+  wdw.while_(key::Y, rotate_upper_arm(flat, -standard_angle_increment));
+  wdw.while_(key::J, rotate_lower_arm(flat, +standard_angle_increment));
+  wdw.while_(key::U, rotate_lower_arm(flat, -standard_angle_increment));
+  wdw.while_(key::O, roll_wrist(flat, +standard_angle_increment));
+  wdw.while_(key::P, roll_wrist(flat, -standard_angle_increment));
+  wdw.while_(key::K, pitch_wrist(flat, +standard_angle_increment));
+  wdw.while_(key::I, pitch_wrist(flat, -standard_angle_increment));
+  wdw.while_(key::L, rotate_fingers(flat, +small_angle_increment));
+  wdw.while_(key::semicolon, rotate_fingers(flat, -small_angle_increment));
 
   wdw.render_loop([&] {
     gl::clear(gl::buffer_bit::color | gl::buffer_bit::depth);
     projection_u.bind(camera.projected_view());
-    traverse(model, gl_draw(stack, model_u, element_buffer), stack.top());
+    flat.update();
+    for (std::size_t node : drawn_nodes) {
+      queue.record(state,
+                   range,
+                   uniform_value{model_u.id(),
+                                 uniform_value::kind::mat4,
+                                 glm::value_ptr(flat.world(node))});
+    }
+    queue.sort();
+    queue.submit();
+    queue.clear();
   });
 }
 
@@ -0,0 +1,187 @@
+#define GLM_FORCE_SILENT_WARNINGS
+
+#include "camera.hpp"
+#include "common.hpp"
+#include "fixed_size_element_buffer.hpp"
+#include "glfw_controls.hpp"
+#include "glm_traits.hpp"
+#include "layout.hpp"
+#include "load_shaders.hpp"
+#include "make_window.hpp"
+#include "opengl.hpp"
+#include "opengl/glm.hpp"
+#include "structured_buffers.hpp"
+
+#include <chrono>
+#include <cstring>
+
+// clang-format off
+const dpsg::gl::ushort_t index_data[] = {
+    0,  1,  2,  // NOLINT
+    2,  3,  0,  // NOLINT
+
+    4,  5,  6,  // NOLINT
+    6,  7,  4,  // NOLINT
+
+    8,  9,  10,  // NOLINT
+    10, 11, 8,   // NOLINT
+
+    12, 13, 14,  // NOLINT
+    14, 15, 12,  // NOLINT
+
+    16, 17, 18,  // NOLINT
+    18, 19, 16,  // NOLINT
+
+    20, 21, 22,  // NOLINT
+    22, 23, 20,  // NOLINT
+};
+
+
+#define RED_COLOR 1.0F, 0.0F, 0.0F, 1.0F
+#define GREEN_COLOR 0.0F, 1.0F, 0.0F, 1.0F
+#define BLUE_COLOR 	0.0F, 0.0F, 1.0F, 1.0F
+
+#define YELLOW_COLOR 1.0F, 1.0F, 0.0F, 1.0F
+#define CYAN_COLOR 0.0F, 1.0F, 1.0F, 1.0F
+#define MAGENTA_COLOR 	1.0F, 0.0F, 1.0F, 1.0F
+
+const dpsg::gl::float_t vertex_data[] =
+{
+	//Front
+	+1.0F, +1.0F, +1.0F, // NOLINT
+	+1.0F, -1.0F, +1.0F, // NOLINT
+	-1.0F, -1.0F, +1.0F, // NOLINT
+	-1.0F, +1.0F, +1.0F, // NOLINT
+
+	//Top
+	+1.0F, +1.0F, +1.0F, // NOLINT
+	-1.0F, +1.0F, +1.0F, // NOLINT
+	-1.0F, +1.0F, -1.0F, // NOLINT
+	+1.0F, +1.0F, -1.0F, // NOLINT
+
+	//LeFt
+	+1.0F, +1.0F, +1.0F, // NOLINT
+	+1.0F, +1.0F, -1.0F, // NOLINT
+	+1.0F, -1.0F, -1.0F, // NOLINT
+	+1.0F, -1.0F, +1.0F, // NOLINT
+
+	//Back
+	+1.0F, +1.0F, -1.0F, // NOLINT
+	-1.0F, +1.0F, -1.0F, // NOLINT
+	-1.0F, -1.0F, -1.0F, // NOLINT
+	+1.0F, -1.0F, -1.0F, // NOLINT
+
+	//Bottom
+	+1.0F, -1.0F, +1.0F, // NOLINT
+	+1.0F, -1.0F, -1.0F, // NOLINT
+	-1.0F, -1.0F, -1.0F, // NOLINT
+	-1.0F, -1.0F, +1.0F, // NOLINT
+
+	//Right
+	-1.0F, +1.0F, +1.0F, // NOLINT
+	-1.0F, -1.0F, +1.0F, // NOLINT
+	-1.0F, -1.0F, -1.0F, // NOLINT
+	-1.0F, +1.0F, -1.0F, // NOLINT
+
+
+	GREEN_COLOR,
+	GREEN_COLOR,
+	GREEN_COLOR,
+	GREEN_COLOR,
+
+	BLUE_COLOR,
+	BLUE_COLOR,
+	BLUE_COLOR,
+	BLUE_COLOR,
+
+	RED_COLOR,
+	RED_COLOR,
+	RED_COLOR,
+	RED_COLOR,
+
+	YELLOW_COLOR,
+	YELLOW_COLOR,
+	YELLOW_COLOR,
+	YELLOW_COLOR,
+
+	CYAN_COLOR,
+	CYAN_COLOR,
+	CYAN_COLOR,
+	CYAN_COLOR,
+
+	MAGENTA_COLOR,
+	MAGENTA_COLOR,
+	MAGENTA_COLOR,
+	MAGENTA_COLOR,
+};
+// clang-format on
+
+constexpr std::size_t grid_side = 32;
+constexpr std::size_t cube_count = grid_side * grid_side;
+constexpr float grid_spacing = 3;
+
+// A grid of spinning cubes, each with its own model matrix, sent as a single
+// instanced draw instead of one draw and one uniform upload per cube.
+void instancing(kmap_window& wdw) {
+  using namespace dpsg;
+
+  gl::enable(gl::capability::cull_face);
+  gl::cull_face(gl::cull_mode::back);
+  gl::front_face(gl::face_mode::clockwise);
+
+  gl::enable(gl::capability::depth_test);
+  gl::depth_mask(true);
+  gl::depth_func(gl::compare_function::lequal);
+  gl::depth_range(gl::near{0}, gl::far{1});
+
+  camera<traits::glm> camera(SCR_WIDTH / SCR_HEIGHT);
+  auto prog = load(vs_filename{"shaders/instanced_with_colors.vs"},
+                   fs_filename{"shaders/basic.fs"})
+                  .value();
+  prog.use();
+  auto projection_u =
+      prog.uniform_location<glm::mat4>("projected_view").value();
+
+  using vertex_layout = sequenced<group<3>, group<4>>;
+  fixed_size_structured_buffer vertex_array{vertex_layout{}, vertex_data};
+  vertex_array.enable();
+  fixed_size_element_buffer element_buffer{index_data};
+
+  // A mat4 attribute takes 4 consecutive locations, one per column.
+  using model_layout =
+      instanced<packed<group<4>, group<4>, group<4>, group<4>>>;
+  fixed_size_instance_buffer<layout<float, model_layout>, cube_count> models;
+  models.attach(vertex_array);
+
+  glfw_controls::bind_control_scheme(
+      glfw_controls::standard_controls, camera, wdw);
+
+  static float model_data[cube_count * 16];  // NOLINT
+  const auto start = std::chrono::steady_clock::now();
+  wdw.render_loop([&] {
+    const std::chrono::duration<float> elapsed =
+        std::chrono::steady_clock::now() - start;
+    for (std::size_t i = 0; i < cube_count; ++i) {
+      const float x = static_cast<float>(i % grid_side) * grid_spacing;
+      const float z = static_cast<float>(i / grid_side) * grid_spacing;
+      glm::mat4 model = glm::translate(glm::mat4{1.F}, glm::vec3{x, -5, -z});
+      model = glm::rotate(model,
+                          elapsed.count() + static_cast<float>(i),
+                          glm::vec3{0, 1, 0});
+      std::memcpy(&model_data[i * 16],  // NOLINT
+                  glm::value_ptr(model),
+                  sizeof(float) * 16);  // NOLINT
+    }
+    models.update(static_cast<const float*>(model_data),
+                  gl::instance_count{cube_count});
+
+    gl::clear(gl::buffer_bit::color | gl::buffer_bit::depth);
+    projection_u.bind(camera.projected_view());
+    vertex_array.bind();
+    element_buffer.draw_instanced(gl::instance_count{cube_count});
+  });
+}
+
+int main() {
+  return windowed(instancing);
+}
\ No newline at end of file
@@ -21,6 +21,7 @@
 #include "opengl.hpp"
 #include "opengl/glm.hpp"
 #include "program.hpp"
+#include "uniform_block.hpp"
 #include "utility.hpp"
 #include "window.hpp"
 #include "window/hints.hpp"
@@ -78,6 +79,25 @@ constexpr float vertices[] = {
 // clang-format on
 
 using dpsg::is_template_instance_v;
+using namespace dpsg::literals;
+
+// Per-frame values shared by every program, matching the "frame" uniform
+// block declared in the shaders.
+struct frame_data {
+  glm::mat4 projected_view;
+  glm::vec3 camera_position;
+  glm::vec3 light_position;
+  glm::vec3 light_color;
+};
+
+template <>
+struct dpsg::block_members<frame_data>
+    : dpsg::members<&frame_data::projected_view,
+                    &frame_data::camera_position,
+                    &frame_data::light_position,
+                    &frame_data::light_color> {};
+
+constexpr dpsg::gl::buffer_binding frame_binding{0};
 
 struct projection_program {
   template <class U,
@@ -86,33 +106,42 @@ struct projection_program {
                                  is_template_instance_v<U, dpsg::vs_filename>,
                              int> = 0>
   explicit projection_program(U&& vertex_shader, T&& fragment_shader)
-      : _program{load(std::forward<U>(vertex_shader),
-                      std::forward<T>(fragment_shader))
-                     .value()},
-        _projected_view{uniform_location<glm::mat4>("projected_view")},
-        _model{uniform_location<glm::mat4>("model")} {}
-
-  void project(const glm::mat4& projected_view) const noexcept {
-    _projected_view.bind(projected_view);
+      : _program{load_shadowed(std::forward<U>(vertex_shader),
+                               std::forward<T>(fragment_shader))},
+        _model{uniform_location<glm::mat4>("model"_u)} {
+    _program.uniform_block_binding("frame"_u, frame_binding);
   }
 
   void set_model(const glm::mat4& model) const noexcept { _model.bind(model); }
 
+  [[nodiscard]] const dpsg::uniform_upload_stats& uniform_stats()
+      const noexcept {
+    return _program.uniform_stats();
+  }
+
   template <class T>
-  auto uniform_location(const char* name) const {
+  auto uniform_location(dpsg::uniform_name name) const {
     return _program.uniform_location<T>(name).value();
   }
 
-  template <class T>
-  void use(const dpsg::camera<T>& cam, const glm::mat4& model) const noexcept {
+  void use(const glm::mat4& model) const noexcept {
     _program.use();
-    project(cam.projected_view());
     set_model(model);
   }
 
  private:
+  // Shadowing is enabled before any uniform is looked up, so that every
+  // handle is affected. Most of the uniforms only change when a slider moves.
+  template <class U, class T>
+  static dpsg::program load_shadowed(U&& vertex_shader, T&& fragment_shader) {
+    auto p = load(std::forward<U>(vertex_shader),
+                  std::forward<T>(fragment_shader))
+                 .value();
+    p.shadow_uniforms();
+    return p;
+  }
+
   dpsg::program _program;
-  dpsg::program::uniform<glm::mat4> _projected_view;
   dpsg::program::uniform<glm::mat4> _model;
 };
 
@@ -123,40 +152,26 @@ struct object_program : projection_program {
             dpsg::vs_filename{"shaders/projection_with_normal.vs"},
             dpsg::fs_filename{"shaders/basic_lighting.fs"}} {}
 
-  template <class T>
-  void use(const dpsg::camera<T>& cam,
-           const glm::vec3& object_color,
-           const glm::vec3& light_color,
+  void use(const glm::vec3& object_color,
            float ambient,
-           const glm::vec3& light_position,
-           const glm::vec3& camera_position,
            float specular,
            uint8_t shininess) const noexcept {
-    projection_program::use(cam, glm::mat4{1.0});
+    projection_program::use(glm::mat4{1.0});
     _object_color_uniform.bind(object_color);
-    _light_color_uniform.bind(light_color);
     _ambient_uniform.bind(ambient);
-    _light_position_uniform.bind(light_position);
-    _camera_position_uniform.bind(camera_position);
     _specular_uniform.bind(specular);
     _shininess_uniform.bind(1 << shininess);
   }
 
  private:
   dpsg::program::uniform<glm::vec3> _object_color_uniform{
-      uniform_location<glm::vec3>("object_color")};
-  dpsg::program::uniform<glm::vec3> _light_color_uniform{
-      uniform_location<glm::vec3>("light_color")};
+      uniform_location<glm::vec3>("object_color"_u)};
   dpsg::program::uniform<float> _ambient_uniform{
-      uniform_location<float>("ambient")};
-  dpsg::program::uniform<glm::vec3> _light_position_uniform{
-      uniform_location<glm::vec3>("light_position")};
-  dpsg::program::uniform<glm::vec3> _camera_position_uniform{
-      uniform_location<glm::vec3>("camera_position")};
+      uniform_location<float>("ambient"_u)};
   dpsg::program::uniform<float> _specular_uniform{
-      uniform_location<float>("specular")};
+      uniform_location<float>("specular"_u)};
   dpsg::program::uniform<int> _shininess_uniform{
-      uniform_location<int>("shininess")};
+      uniform_location<int>("shininess"_u)};
 };
 
 struct light_program : projection_program {
@@ -165,12 +180,9 @@ struct light_program : projection_program {
       : projection_program{dpsg::vs_filename{"shaders/basic_projection.vs"},
                            dpsg::fs_filename{"shaders/uniform.fs"}} {}
 
-  template <class T>
-  void use(const dpsg::camera<T>& cam,
-           const glm::vec3& light_position,
+  void use(const glm::vec3& light_position,
            const glm::vec3& light_color) const noexcept {
     projection_program::use(
-        cam,
         glm::scale(glm::translate(glm::mat4{1.0}, light_position),
                    glm::vec3{0.2}));
     _light_color_uniform.bind(glm::vec4{light_color, 1.0});
@@ -178,7 +190,7 @@ struct light_program : projection_program {
 
  private:
   dpsg::program::uniform<glm::vec4> _light_color_uniform{
-      uniform_location<glm::vec4>("ourColor")};
+      uniform_location<glm::vec4>("ourColor"_u)};
 };
 
 int main() {
@@ -211,6 +223,8 @@ int main() {
 
             light_program light_program;
 
+            uniform_block<frame_data> frame_block{frame_binding};
+
             vertex_buffer cube;
             cube.bind();
             cube.set_data(vertices);
@@ -247,6 +261,16 @@ int main() {
                                << "color: " << light_color.r << " "
                                << light_color.g << " " << light_color.b
                                << "\nambient: " << ambient << std::endl;
+                     if constexpr (gl::state_cache::enabled) {
+                       const auto stats = gl::state_cache::stats();
+                       std::cout << "state changes: " << stats.issued
+                                 << " issued, " << stats.elided << " elided"
+                                 << std::endl;
+                     }
+                     const auto& uploads = object_program.uniform_stats();
+                     std::cout << "uniform uploads: " << uploads.issued
+                               << " issued, " << uploads.skipped << " skipped"
+                               << std::endl;
                    }));
 
             // Camera
@@ -291,20 +315,18 @@ int main() {
                     nkw::slider(w, 1, shininess, 8, 1);
                   });
 
-              object_program.use(cam,
-                                 object_color,
-                                 light_color,
-                                 ambient,
-                                 light_position,
-                                 cam.position(),
-                                 specular,
-                                 shininess);
+              frame_block.update(frame_data{cam.projected_view(),
+                                            cam.position(),
+                                            light_position,
+                                            light_color});
+
+              object_program.use(object_color, ambient, specular, shininess);
               object_vao.bind();
               gl::draw_arrays(gl::drawing_mode::triangles,
                               gl::index{0},
                               gl::element_count{36});
 
-              light_program.use(cam, light_position, light_color);
+              light_program.use(light_position, light_color);
 
               object_vao.bind();
               gl::draw_arrays(gl::drawing_mode::triangles,
@@ -0,0 +1,65 @@
+#ifndef GUARD_MAKE_HEADLESS_WINDOW_HEADER
+#define GUARD_MAKE_HEADLESS_WINDOW_HEADER
+
+#include "glad/glad.h"
+
+#include "headless_context.hpp"
+#include "headless_window.hpp"
+#include "utility.hpp"
+#include "utils.hpp"
+
+#include <iostream>
+#include <type_traits>
+
+// settings
+constexpr static inline dpsg::width HEADLESS_WIDTH{800};
+constexpr static inline dpsg::height HEADLESS_HEIGHT{600};
+
+using headless_window =
+    dpsg::headless_window<dpsg::offscreen_framebuffer, glad_loader>;
+
+template <class F>
+dpsg::ExecutionStatus make_headless_window(F&& f) {
+  using namespace dpsg;
+  return within_headless_context([&f]() -> ExecutionStatus {
+    return with_headless_window<::headless_window>(
+        HEADLESS_WIDTH,
+        HEADLESS_HEIGHT,
+        [&f](::headless_window& wdw) -> ExecutionStatus {
+          if (!wdw.framebuffer_complete()) {
+            std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+            return ExecutionStatus::Failure;
+          }
+          if constexpr (std::is_same_v<
+                            std::invoke_result_t<F&&, ::headless_window&>,
+                            ExecutionStatus>) {
+            return std::forward<F>(f)(wdw);
+          }
+          else {
+            std::forward<F>(f)(wdw);
+            return ExecutionStatus::Success;
+          }
+        });
+  });
+}
+
+template <class F>
+int headless(F&& func) noexcept {
+  using namespace dpsg;
+
+  ExecutionStatus r = ExecutionStatus::Failure;
+
+  try {
+    r = make_headless_window(std::forward<F>(func));
+  }
+  catch (std::exception& e) {
+    std::cerr << "Exception in main: " << e.what() << std::endl;
+  }
+  catch (...) {
+    std::cerr << "Unhandled error occured" << std::endl;
+  }
+
+  return static_cast<int>(r);
+}
+
+#endif  // GUARD_MAKE_HEADLESS_WINDOW_HEADER
@@ -360,7 +360,7 @@ void matrices(dpsg::window& window) {
       ignore([&perspective, &perspective_u](width w, height h) {
         perspective[{0, 0}] = frustum_scale / (w / h).value;
         perspective_u.bind(perspective);
-        glViewport(0, 0, w.value, h.value);
+        set_viewport(w, h);
       });
   window.set_framebuffer_size_callback(reshape);
 
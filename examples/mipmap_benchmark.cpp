@@ -0,0 +1,134 @@
+#include "mipmap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+// A flat image must stay flat down the chain, whatever the filter, and the
+// round trip through linear space must give back the same codes.
+bool check_flat(dpsg::mip_options options, unsigned int channels) {
+  constexpr unsigned int size = 37;  // NOLINT
+  constexpr unsigned char value = 77;  // NOLINT
+  const std::vector<unsigned char> image(size * size * channels, value);
+  const auto chain =
+      dpsg::build_mip_chain(image.data(), size, size, channels, options);
+  if (chain.levels.size() != 6) {  // NOLINT
+    std::cerr << "Expected 6 levels, got " << chain.levels.size() << std::endl;
+    return false;
+  }
+  for (std::size_t level = 0; level < chain.levels.size(); ++level) {
+    const auto& l = chain.levels[level];
+    const auto row = dpsg::mip_chain::row_size(l.width.value, channels);
+    for (unsigned int y = 0; y < l.height.value; ++y) {
+      for (unsigned int i = 0; i < l.width.value * channels; ++i) {
+        const auto v = chain.pixels[l.offset + y * row + i];
+        if (v != value) {
+          std::cerr << "Level " << level << " changed a flat image: "
+                    << static_cast<int>(v) << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// A one pixel black and white checkerboard averages to half the light in
+// every pixel of the second level. Filtering in linear space encodes that
+// as about 188, filtering the sRGB codes as is would give 128.
+bool check_checkerboard(dpsg::mip_options options, unsigned int channels) {
+  constexpr unsigned int size = 32;  // NOLINT
+  std::vector<unsigned char> image(size * size * channels);
+  for (unsigned int y = 0; y < size; ++y) {
+    for (unsigned int x = 0; x < size; ++x) {
+      for (unsigned int c = 0; c < channels; ++c) {
+        // Alpha stays opaque, only the color alternates.
+        const bool alpha = channels == 4 && c == 3;
+        image[(y * size + x) * channels + c] =
+            alpha || (x + y) % 2 == 0 ? 255 : 0;  // NOLINT
+      }
+    }
+  }
+  const auto chain =
+      dpsg::build_mip_chain(image.data(), size, size, channels, options);
+  const int expected = options.srgb ? 188 : 128;  // NOLINT
+  // Kaiser filtering rings a little where the edges are clamped.
+  constexpr int tolerance = 4;
+  const auto& l = chain.levels[1];
+  const auto row = dpsg::mip_chain::row_size(l.width.value, channels);
+  for (unsigned int y = 0; y < l.height.value; ++y) {
+    for (unsigned int x = 0; x < l.width.value; ++x) {
+      for (unsigned int c = 0; c < std::min(channels, 3U); ++c) {
+        const int v = chain.pixels[l.offset + y * row + x * channels + c];
+        if (std::abs(v - expected) > tolerance) {
+          std::cerr << (options.srgb ? "sRGB" : "Linear")
+                    << " checkerboard gave " << v << " instead of "
+                    << expected << " at " << x << ", " << y << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+}  // namespace
+
+// Measures the CPU mipmap generation on its own, without a GL context, in
+// millions of source pixels per second, for each filter and pixel layout.
+int main() {
+  using namespace dpsg;
+  using clock = std::chrono::steady_clock;
+
+  constexpr unsigned int size = 2048;
+  constexpr std::size_t iterations = 5;
+
+  const mip_options all_options[] = {{mip_filter::box, false},
+                                     {mip_filter::box, true},
+                                     {mip_filter::kaiser, false},
+                                     {mip_filter::kaiser, true}};
+  const unsigned int all_channels[] = {1, 3, 4};
+
+  for (const auto& options : all_options) {
+    for (const auto channels : all_channels) {
+      if (!check_flat(options, channels) ||
+          !check_checkerboard(options, channels)) {
+        return 1;
+      }
+    }
+  }
+
+  std::uint32_t state = 42;  // NOLINT
+  std::vector<unsigned char> image(std::size_t{size} * size * 4);
+  for (auto& v : image) {
+    // xorshift, so that the content doesn't compress into a few cache lines.
+    state ^= state << 13U;  // NOLINT
+    state ^= state >> 17U;  // NOLINT
+    state ^= state << 5U;   // NOLINT
+    v = static_cast<unsigned char>(state);
+  }
+
+  for (const auto& options : all_options) {
+    for (const auto channels : all_channels) {
+      clock::duration total{0};
+      std::size_t levels = 0;
+      for (std::size_t i = 0; i < iterations; ++i) {
+        const auto start = clock::now();
+        const auto chain =
+            build_mip_chain(image.data(), size, size, channels, options);
+        total += clock::now() - start;
+        levels = chain.levels.size();
+      }
+      const auto us =
+          std::chrono::duration_cast<std::chrono::microseconds>(total).count();
+      const double pixels = static_cast<double>(size) * size * iterations;
+      std::cout << (options.filter == mip_filter::box ? "box   " : "kaiser")
+                << (options.srgb ? " srgb   " : " linear ") << channels
+                << " channel(s): " << levels << " levels, "
+                << pixels / static_cast<double>(us) << " MPix/s" << std::endl;
+    }
+  }
+}
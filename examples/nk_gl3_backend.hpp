@@ -9,6 +9,11 @@
 #include "program.hpp"
 #include "structured_buffers.hpp"
 
+#include <cassert>
+
+constexpr static dpsg::gl::byte_size MAX_VERTEX_MEMORY{512 * 1024};
+constexpr static dpsg::gl::byte_size MAX_ELEMENT_MEMORY{128 * 1024};
+
 namespace dpsg {
 class nk_gl3_backend {
  public:
@@ -103,17 +108,12 @@ class nk_gl3_backend {
     gl::uniform(_projection_unif, ortho);
 
     _vao.bind();
-    _vbo.bind();
-    _ebo.bind();
-    gl::buffer_data(
-        gl::buffer_type::array, max_vertex_buffer, gl::data_hint::stream_draw);
-    gl::buffer_data(gl::buffer_type::element_array,
-                    max_element_buffer,
-                    gl::data_hint::stream_draw);
-    void* vertices =
-        gl::map_buffer(gl::buffer_type::array, gl::access::write_only);
-    void* elements =
-        gl::map_buffer(gl::buffer_type::element_array, gl::access::write_only);
+    _vbo.begin_frame();
+    _ebo.begin_frame();
+    auto vertices = _vbo.allocate(max_vertex_buffer, sizeof(vertex));
+    auto elements = _ebo.allocate(max_element_buffer, sizeof(gl::ushort_t));
+    assert(vertices && elements &&
+           "nk_gl3_backend: requested buffer sizes exceed the stream regions");
     nk_convert_config config{};
     config.vertex_layout =
         static_cast<const nk_draw_vertex_layout_element*>(vertex_layout);
@@ -127,15 +127,18 @@ class nk_gl3_backend {
     config.shape_AA = anti_aliasing;
     config.line_AA = anti_aliasing;
 
-    nk::buffer vbuf(vertices, max_vertex_buffer.value);
-    nk::buffer ebuf(elements, max_vertex_buffer.value);
+    nk::buffer vbuf(vertices->data, vertices->size.value);
+    nk::buffer ebuf(elements->data, elements->size.value);
     ctx.convert(_cmds, vbuf, ebuf, &config);
 
-    gl::unmap_buffer(gl::buffer_type::array);
-    gl::unmap_buffer(gl::buffer_type::element_array);
+    _vbo.commit();
+    _ebo.commit();
 
     const nk_draw_command* cmd{nullptr};
-    gl::offset offset{0};
+    const gl::index base_vertex{
+        static_cast<gl::uint_t>(vertices->offset.value / sizeof(vertex))};
+    gl::offset offset{static_cast<unsigned int>(elements->offset.value /
+                                                sizeof(gl::ushort_t))};
     nk_draw_foreach(cmd, &ctx.ctx(), &_cmds.buf()) {
       if (cmd->elem_count == 0) {
         continue;
@@ -153,9 +156,12 @@ class nk_gl3_backend {
       gl::draw_elements<gl::ushort_t>(
           gl::drawing_mode::triangles,
           gl::element_count{static_cast<gl::int_t>(cmd->elem_count)},
-          offset);
+          offset,
+          base_vertex);
       offset.value += cmd->elem_count;
     }
+    _vbo.end_frame();
+    _ebo.end_frame();
     ctx.clear();
     _cmds.clear();
   }
@@ -192,8 +198,14 @@ class nk_gl3_backend {
   nk_draw_null_texture _null{};
   nk::font_atlas _atlas;
   vertex_array _vao;
-  element_buffer _ebo;
-  vertex_buffer _vbo;
+  // Regions are rounded up to a whole number of vertices so that every region
+  // starts on a vertex boundary and can be addressed with a base vertex.
+  streaming_buffer<> _ebo{gl::buffer_type::element_array, MAX_ELEMENT_MEMORY};
+  streaming_buffer<> _vbo{
+      gl::buffer_type::array,
+      gl::byte_size{static_cast<gl::size_t>(
+          (MAX_VERTEX_MEMORY.value + sizeof(vertex) - 1) / sizeof(vertex) *
+          sizeof(vertex))}};
   gl::texture_id _texture{0};
   gl::uniform_location _texture_unif{-1};
   gl::uniform_location _projection_unif{-1};
@@ -260,7 +272,4 @@ class nk_gl3_backend {
 
 }  // namespace dpsg
 
-constexpr static dpsg::gl::byte_size MAX_VERTEX_MEMORY{512 * 1024};
-constexpr static dpsg::gl::byte_size MAX_ELEMENT_MEMORY{128 * 1024};
-
 #endif  // GUARD_DPSG_NK_GL3_BACKEND_HEADER
\ No newline at end of file
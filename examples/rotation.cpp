@@ -10,6 +10,7 @@
 #include "stbi_wrapper.hpp"
 #include "structured_buffers.hpp"
 #include "texture.hpp"
+#include "texture_units.hpp"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -93,8 +94,9 @@ void rotation(dpsg::window& window) {
   auto view_u = prog.uniform_location<glm::mat4>("view").value();
   auto model_u = prog.uniform_location<glm::mat4>("model").value();
 
-  texture1_u.bind(tex1, gl::texture_name::_0);
-  texture2_u.bind(tex2, gl::texture_name::_1);
+  texture_units units;
+  texture1_u.bind(tex1, units);
+  texture2_u.bind(tex2, units);
 
   gl::clear_color({0.2, 0.3, 0.3});
 
@@ -111,7 +113,7 @@ void rotation(dpsg::window& window) {
     projection_u.bind(projection);
   };
   const auto reshape = ignore([&aspect_ratio, &project](width w, height h) {
-    glViewport(0, 0, w.value, h.value);
+    set_viewport(w, h);
     aspect_ratio = w / h;
     project();
   });
@@ -3,22 +3,113 @@
 
 #include "fixed_size_element_buffer.hpp"
 #include "load_shaders.hpp"
+#include "sampler.hpp"
+#include "shader_variants.hpp"
 #include "shaders.hpp"
 #include "stbi_wrapper.hpp"
 #include "structured_buffers.hpp"
+#include "texture_atlas.hpp"
+#include "texture_units.hpp"
 #include "window.hpp"
 
+#if defined(DPSG_EMBED_RESOURCES)
+#include "embedded/resources.hpp"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+// Whether the regions of an atlas, padding included, stay inside it and
+// apart from each other.
+[[nodiscard]] bool check_atlas(const dpsg::texture_atlas& atlas,
+                               unsigned int padding) {
+  struct rect {
+    long x0, y0, x1, y1;  // NOLINT
+  };
+  const auto pad = static_cast<long>(padding);
+  const auto width = static_cast<float>(atlas.width.value);
+  const auto height = static_cast<float>(atlas.height.value);
+  std::vector<rect> rects;
+  for (const auto& r : atlas.regions) {
+    const long x = std::lround(r.u0 * width) - pad;
+    const long y = std::lround(r.v0 * height) - pad;
+    rects.push_back(rect{x,
+                         y,
+                         x + static_cast<long>(r.width.value) + 2 * pad,
+                         y + static_cast<long>(r.height.value) + 2 * pad});
+  }
+  for (std::size_t i = 0; i < rects.size(); ++i) {
+    const auto& a = rects[i];
+    if (a.x0 < 0 || a.y0 < 0 || a.x1 > static_cast<long>(atlas.width.value) ||
+        a.y1 > static_cast<long>(atlas.height.value)) {
+      std::cerr << "Atlas region " << i << " is out of bounds" << std::endl;
+      return false;
+    }
+    for (std::size_t j = i + 1; j < rects.size(); ++j) {
+      const auto& b = rects[j];
+      if (a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1) {
+        std::cerr << "Atlas regions " << i << " and " << j << " overlap"
+                  << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 void texture_example(dpsg::window& wdw) {
   using namespace dpsg;
   using namespace dpsg::input;
 
-  auto prog = load(vs_filename{"shaders/textured.vs"},
-                   fs_filename{"shaders/two_textures_mixed.fs"})
-                  .value();
+  constexpr unsigned int atlas_padding = 2;
+  texture_atlas_builder<texture_rgba> builder{atlas_padding};
+  const auto add_to_atlas = [&builder](const auto& image) {
+    auto added = builder.add(image);
+    if (!added.has_value()) {
+      throw std::runtime_error(added.error().what());
+    }
+  };
+
+#if defined(DPSG_EMBED_RESOURCES)
+  // Nothing is read from the disk.
+  namespace res = embedded::resources;
+  shader_variants variants{
+      load(vs_embedded{res::shaders_attributes_vs}).value(),
+      load(fs_embedded{res::shaders_two_textures_mixed_fs}).value(),
+      {"COLOR", "TEXCOORD"}};
+  auto wallText =
+      load<texture_rgb>(texture_embedded{res::assets_container_jpg}).value();
+  auto smiling_face =
+      load<texture_rgba>(texture_embedded{res::assets_awesomeface_png})
+          .value();
+  add_to_atlas(texture_embedded{res::assets_container_jpg});
+  add_to_atlas(texture_embedded{res::assets_awesomeface_png});
+#else
+  auto variants =
+      shader_variants::load(vs_filename{"shaders/attributes.vs"},
+                            fs_filename{"shaders/two_textures_mixed.fs"},
+                            {"COLOR", "TEXCOORD"})
+          .value();
   auto wallText =
       load<texture_rgb>(texture_filename{"assets/container.jpg"}).value();
   auto smiling_face =
       load<texture_rgba>(texture_filename{"assets/awesomeface.png"}).value();
+  add_to_atlas(texture_filename{"assets/container.jpg"});
+  add_to_atlas(texture_filename{"assets/wall.jpg"});
+  add_to_atlas(texture_filename{"assets/awesomeface.png"});
+#endif
+  const auto atlas = builder.build(texture_options::repeat_linear);
+  if (!atlas || !check_atlas(*atlas, atlas_padding)) {
+    throw std::runtime_error("couldn't pack the example images in an atlas");
+  }
+  std::cout << atlas->regions.size() << " images packed in a "
+            << atlas->width.value << "x" << atlas->height.value << " atlas"
+            << std::endl;
+
+  const auto& prog = variants.get(variants.mask("COLOR", "TEXCOORD")).value();
 
   constexpr float vertices[] = {
       // positions        // colors         // texture coords
@@ -47,8 +138,13 @@ void texture_example(dpsg::window& wdw) {
   auto texture1 = prog.uniform_location<sampler2D>("texture1").value();
   auto texture2 = prog.uniform_location<sampler2D>("texture2").value();
 
-  texture1.bind(wallText, gl::texture_name::_0);
-  texture2.bind(smiling_face, gl::texture_name::_1);
+  texture_units units;
+  sampler_cache samplers;
+  sampler_state filtering = sampler_states::repeat_trilinear;
+  filtering.max_anisotropy = samplers.quality().max_anisotropy;
+  const auto& sampler = samplers.get(filtering);
+  texture1.bind(wallText, sampler, units);
+  texture2.bind(smiling_face, sampler, units);
 
   wdw.render_loop([&] {
     gl::clear(gl::buffer_bit::color);
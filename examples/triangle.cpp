@@ -2,14 +2,18 @@
 #include "load_shaders.hpp"
 #include "make_window.hpp"
 #include "opengl.hpp"
+#include "shader_variants.hpp"
 #include "structured_buffers.hpp"
 
 void triangle(dpsg::window& wdw) {
   using namespace dpsg;
 
-  auto shader = load(vs_filename{"shaders/basic_with_color.vs"},
-                     fs_filename{"shaders/basic.fs"})
-                    .value();
+  auto variants =
+      shader_variants::load(vs_filename{"shaders/attributes.vs"},
+                            fs_filename{"shaders/basic.fs"},
+                            {"COLOR"})
+          .value();
+  const auto& shader = variants.get(variants.mask("COLOR")).value();
 
   // NOLINTNEXTLINE
   constexpr float vertices[] = {
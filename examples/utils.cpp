@@ -1,13 +1,19 @@
 #include "glad/glad.h"
 
 #include "common.hpp"
+#include "opengl.hpp"
 #include "utils.hpp"
 #include "with_window.hpp"
 
 #include <stdexcept>
 
+void set_viewport(dpsg::width w, dpsg::height h) {
+  dpsg::gl::viewport(dpsg::gl::width{static_cast<dpsg::gl::uint_t>(w.value)},
+                     dpsg::gl::height{static_cast<dpsg::gl::uint_t>(h.value)});
+}
+
 void resize_t::resize_impl(dpsg::width w, dpsg::height h) {
-  glViewport(0, 0, w.value, h.value);
+  set_viewport(w, h);
 }
 
 void error_check(std::string pos) {
@@ -19,10 +25,9 @@ void error_check(std::string pos) {
 
 bool glad_loader::already_initialized = false;
 
-void glad_loader::initialize_glad() noexcept(false) {
+void glad_loader::initialize_glad(GLADloadproc loader) noexcept(false) {
   if (!already_initialized) {
-    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(  // NOLINT
-            glfwGetProcAddress))) {
+    if (!gladLoadGLLoader(loader)) {
       throw std::runtime_error("Failed to initialize GLAD");
     }
     already_initialized = true;
@@ -16,6 +16,10 @@ auto ignore(F&& f) {
   };
 }
 
+// Sets the viewport through the gl:: state cache, so that it stays in sync
+// with the framebuffer size.
+void set_viewport(dpsg::width w, dpsg::height h);
+
 struct resize_t {
   template <class W>
   void operator()([[maybe_unused]] W&& unused,
@@ -33,7 +37,7 @@ void error_check(std::string pos);
 struct glad_loader {
  private:
   static bool already_initialized;
-  static void initialize_glad() noexcept(false);
+  static void initialize_glad(GLADloadproc loader) noexcept(false);
 
  public:
   template <class B>
@@ -41,7 +45,7 @@ struct glad_loader {
     template <class... Args>
     explicit type(Args&&... args) : B(std::forward<Args>(args)...) {
       this->make_context_current();
-      initialize_glad();
+      initialize_glad(B::proc_address_loader());
     }
   };
 };
@@ -71,7 +75,7 @@ struct camera_tracks_cursor {
 constexpr static inline auto camera_resize = [](auto& cam) {
   return ignore([&cam](dpsg::width w, dpsg::height h) {
     cam.aspect_ratio(w, h);
-    glViewport(0, 0, w.value, h.value);
+    set_viewport(w, h);
   });
 };
 
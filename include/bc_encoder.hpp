@@ -0,0 +1,399 @@
+#ifndef GUARD_DPSG_BC_ENCODER_HEADER
+#define GUARD_DPSG_BC_ENCODER_HEADER
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace dpsg {
+
+// Block compressed formats produced by encode_bc(). Every format stores 4x4
+// pixel blocks:
+// - bc1: RGB, 8 bytes per block (DXT1).
+// - bc3: RGBA, 16 bytes per block, BC1 colors and a BC4 alpha (DXT5).
+// - bc4: single channel (the red one), 8 bytes per block (RGTC1).
+// - bc5: two channels (red and green), 16 bytes per block (RGTC2), meant for
+//   normal maps.
+enum class bc_format { bc1, bc3, bc4, bc5 };
+
+constexpr inline std::size_t block_size(bc_format format) noexcept {
+  return format == bc_format::bc1 || format == bc_format::bc4 ? 8 : 16;
+}
+
+namespace detail {
+constexpr inline std::uint16_t pack_565(float r, float g, float b) noexcept {
+  const auto q = [](float v, float max) {
+    const float scaled = v * max / 255.F + .5F;  // NOLINT
+    return static_cast<unsigned int>(
+        scaled < 0.F ? 0.F : (scaled > max ? max : scaled));
+  };
+  return static_cast<std::uint16_t>(q(r, 31.F) << 11U | q(g, 63.F) << 5U |
+                                    q(b, 31.F));
+}
+
+// Color as the decoder sees it: bits replicated to fill 8 bits.
+inline void unpack_565(std::uint16_t c, float (&out)[3]) noexcept {  // NOLINT
+  const unsigned int r = (c >> 11U) & 31U;  // NOLINT
+  const unsigned int g = (c >> 5U) & 63U;   // NOLINT
+  const unsigned int b = c & 31U;           // NOLINT
+  out[0] = static_cast<float>(r << 3U | r >> 2U);
+  out[1] = static_cast<float>(g << 2U | g >> 4U);
+  out[2] = static_cast<float>(b << 3U | b >> 2U);
+}
+
+// Index of the nearest of the 4 palette colors for each of the 16 pixels,
+// given as planes of red, green and blue values.
+inline void nearest_colors(const float* r,
+                           const float* g,
+                           const float* b,
+                           const float (&palette)[4][3],  // NOLINT
+                           unsigned int* indices) noexcept {
+#if defined(DPSG_SIMD_SSE) || defined(__AVX__)
+  for (std::size_t i = 0; i < 16; i += 4) {  // NOLINT
+    const __m128 pr = _mm_loadu_ps(r + i);     // NOLINT
+    const __m128 pg = _mm_loadu_ps(g + i);     // NOLINT
+    const __m128 pb = _mm_loadu_ps(b + i);     // NOLINT
+    __m128 best = _mm_set1_ps(3.4e38F);        // NOLINT
+    __m128 best_index = _mm_setzero_ps();
+    for (std::size_t c = 0; c < 4; ++c) {
+      const __m128 dr = _mm_sub_ps(pr, _mm_set1_ps(palette[c][0]));
+      const __m128 dg = _mm_sub_ps(pg, _mm_set1_ps(palette[c][1]));
+      const __m128 db = _mm_sub_ps(pb, _mm_set1_ps(palette[c][2]));
+      const __m128 d = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)),
+          _mm_mul_ps(db, db));
+      const __m128 closer = _mm_cmplt_ps(d, best);
+      best = _mm_min_ps(d, best);
+      best_index =
+          _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(static_cast<float>(c))),
+                    _mm_andnot_ps(closer, best_index));
+    }
+    float out[4];  // NOLINT
+    _mm_storeu_ps(out, best_index);
+    for (std::size_t j = 0; j < 4; ++j) {
+      indices[i + j] = static_cast<unsigned int>(out[j]);  // NOLINT
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (std::size_t i = 0; i < 16; i += 4) {  // NOLINT
+    const float32x4_t pr = vld1q_f32(r + i);   // NOLINT
+    const float32x4_t pg = vld1q_f32(g + i);   // NOLINT
+    const float32x4_t pb = vld1q_f32(b + i);   // NOLINT
+    float32x4_t best = vdupq_n_f32(3.4e38F);   // NOLINT
+    uint32x4_t best_index = vdupq_n_u32(0);
+    for (std::size_t c = 0; c < 4; ++c) {
+      const float32x4_t dr = vsubq_f32(pr, vdupq_n_f32(palette[c][0]));
+      const float32x4_t dg = vsubq_f32(pg, vdupq_n_f32(palette[c][1]));
+      const float32x4_t db = vsubq_f32(pb, vdupq_n_f32(palette[c][2]));
+      float32x4_t d = vmulq_f32(dr, dr);
+      d = vmlaq_f32(d, dg, dg);
+      d = vmlaq_f32(d, db, db);
+      const uint32x4_t closer = vcltq_f32(d, best);
+      best = vminq_f32(d, best);
+      best_index = vbslq_u32(
+          closer, vdupq_n_u32(static_cast<std::uint32_t>(c)), best_index);
+    }
+    std::uint32_t out[4];  // NOLINT
+    vst1q_u32(out, best_index);
+    for (std::size_t j = 0; j < 4; ++j) {
+      indices[i + j] = out[j];  // NOLINT
+    }
+  }
+#else
+  for (std::size_t i = 0; i < 16; ++i) {  // NOLINT
+    float best = 3.4e38F;                 // NOLINT
+    for (unsigned int c = 0; c < 4; ++c) {
+      const float dr = r[i] - palette[c][0];  // NOLINT
+      const float dg = g[i] - palette[c][1];  // NOLINT
+      const float db = b[i] - palette[c][2];  // NOLINT
+      const float d = dr * dr + dg * dg + db * db;
+      if (d < best) {
+        best = d;
+        indices[i] = c;  // NOLINT
+      }
+    }
+  }
+#endif
+}
+
+// BC1 color block, always in 4 color mode. The endpoints are the extremes of
+// the pixels along their principal axis, found by power iteration on the
+// covariance matrix.
+inline void encode_bc1_block(const unsigned char* rgba,
+                             unsigned char* out) noexcept {
+  alignas(simd::alignment) float r[16];  // NOLINT
+  alignas(simd::alignment) float g[16];  // NOLINT
+  alignas(simd::alignment) float b[16];  // NOLINT
+  float mean[3] = {0, 0, 0};              // NOLINT
+  float lo[3] = {255, 255, 255};          // NOLINT
+  float hi[3] = {0, 0, 0};                // NOLINT
+  for (std::size_t i = 0; i < 16; ++i) {  // NOLINT
+    r[i] = rgba[i * 4];                   // NOLINT
+    g[i] = rgba[i * 4 + 1];               // NOLINT
+    b[i] = rgba[i * 4 + 2];               // NOLINT
+    const float p[3] = {r[i], g[i], b[i]};  // NOLINT
+    for (std::size_t c = 0; c < 3; ++c) {
+      mean[c] += p[c];                // NOLINT
+      lo[c] = std::min(lo[c], p[c]);  // NOLINT
+      hi[c] = std::max(hi[c], p[c]);  // NOLINT
+    }
+  }
+  for (auto& m : mean) {
+    m /= 16.F;  // NOLINT
+  }
+
+  float cov[6] = {0, 0, 0, 0, 0, 0};      // NOLINT
+  for (std::size_t i = 0; i < 16; ++i) {  // NOLINT
+    const float dr = r[i] - mean[0];      // NOLINT
+    const float dg = g[i] - mean[1];      // NOLINT
+    const float db = b[i] - mean[2];      // NOLINT
+    cov[0] += dr * dr;
+    cov[1] += dr * dg;
+    cov[2] += dr * db;
+    cov[3] += dg * dg;
+    cov[4] += dg * db;
+    cov[5] += db * db;  // NOLINT
+  }
+  float axis[3] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};  // NOLINT
+  for (int iteration = 0; iteration < 4; ++iteration) {
+    const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+    const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+    const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+    const float norm = std::max({std::abs(x), std::abs(y), std::abs(z)});
+    if (norm <= 0.F) {
+      break;
+    }
+    axis[0] = x / norm;
+    axis[1] = y / norm;
+    axis[2] = z / norm;
+  }
+
+  float t_min = 3.4e38F;   // NOLINT
+  float t_max = -3.4e38F;  // NOLINT
+  for (std::size_t i = 0; i < 16; ++i) {  // NOLINT
+    const float t = (r[i] - mean[0]) * axis[0] + (g[i] - mean[1]) * axis[1] +
+                    (b[i] - mean[2]) * axis[2];  // NOLINT
+    t_min = std::min(t_min, t);
+    t_max = std::max(t_max, t);
+  }
+  const float len = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+  const float scale = len > 0.F ? 1.F / len : 0.F;
+  auto c0 = pack_565(mean[0] + axis[0] * t_max * scale,
+                     mean[1] + axis[1] * t_max * scale,
+                     mean[2] + axis[2] * t_max * scale);
+  auto c1 = pack_565(mean[0] + axis[0] * t_min * scale,
+                     mean[1] + axis[1] * t_min * scale,
+                     mean[2] + axis[2] * t_min * scale);
+  // 4 color mode requires c0 > c1. Equal endpoints leave every index at 0,
+  // which decodes the same in both modes.
+  if (c0 < c1) {
+    std::swap(c0, c1);
+  }
+
+  float palette[4][3];  // NOLINT
+  unpack_565(c0, palette[0]);
+  unpack_565(c1, palette[1]);
+  for (std::size_t c = 0; c < 3; ++c) {
+    palette[2][c] = (2.F * palette[0][c] + palette[1][c]) / 3.F;  // NOLINT
+    palette[3][c] = (palette[0][c] + 2.F * palette[1][c]) / 3.F;  // NOLINT
+  }
+  unsigned int indices[16] = {};  // NOLINT
+  if (c0 != c1) {
+    nearest_colors(r, g, b, palette, indices);
+  }
+
+  std::uint32_t bits = 0;
+  for (unsigned int i = 0; i < 16; ++i) {  // NOLINT
+    bits |= indices[i] << (2U * i);        // NOLINT
+  }
+  std::memcpy(out, &c0, 2);
+  std::memcpy(out + 2, &c1, 2);    // NOLINT
+  std::memcpy(out + 4, &bits, 4);  // NOLINT
+}
+
+// BC4 block of the 16 bytes found every 'stride' bytes from 'values', in 8
+// value mode between the minimum and the maximum.
+inline void encode_bc4_block(const unsigned char* values,
+                             std::size_t stride,
+                             unsigned char* out) noexcept {
+  unsigned int lo = 255;  // NOLINT
+  unsigned int hi = 0;
+  for (std::size_t i = 0; i < 16; ++i) {  // NOLINT
+    lo = std::min<unsigned int>(lo, values[i * stride]);  // NOLINT
+    hi = std::max<unsigned int>(hi, values[i * stride]);  // NOLINT
+  }
+  out[0] = static_cast<unsigned char>(hi);
+  out[1] = static_cast<unsigned char>(lo);
+  std::uint64_t bits = 0;
+  if (hi != lo) {
+    const float step = 7.F / static_cast<float>(hi - lo);  // NOLINT
+    for (unsigned int i = 0; i < 16; ++i) {                // NOLINT
+      // Position between the minimum (0) and the maximum (7), converted to
+      // the code of the value: 0 and 1 are the endpoints, 2 to 7 go from the
+      // maximum to the minimum.
+      const auto p = static_cast<unsigned int>(
+          static_cast<float>(values[i * stride] - lo) * step + .5F);  // NOLINT
+      const unsigned int code = p == 7 ? 0 : (p == 0 ? 1 : 8 - p);  // NOLINT
+      bits |= static_cast<std::uint64_t>(code) << (3U * i);        // NOLINT
+    }
+  }
+  for (std::size_t i = 0; i < 6; ++i) {  // NOLINT
+    out[2 + i] = static_cast<unsigned char>(bits >> (8U * i));  // NOLINT
+  }
+}
+
+inline void encode_block(const unsigned char* rgba,
+                         bc_format format,
+                         unsigned char* out) noexcept {
+  switch (format) {
+    case bc_format::bc1:
+      encode_bc1_block(rgba, out);
+      break;
+    case bc_format::bc3:
+      encode_bc4_block(rgba + 3, 4, out);
+      encode_bc1_block(rgba, out + 8);  // NOLINT
+      break;
+    case bc_format::bc4:
+      encode_bc4_block(rgba, 4, out);
+      break;
+    case bc_format::bc5:
+      encode_bc4_block(rgba, 4, out);
+      encode_bc4_block(rgba + 1, 4, out + 8);  // NOLINT
+      break;
+  }
+}
+
+// Encodes the block rows in [first, last).
+inline void encode_block_rows(const unsigned char* rgba,
+                              unsigned int width,
+                              unsigned int height,
+                              bc_format format,
+                              unsigned int first,
+                              unsigned int last,
+                              unsigned char* out) noexcept {
+  const unsigned int blocks_x = (width + 3) / 4;
+  const std::size_t size = block_size(format);
+  unsigned char block[64];  // NOLINT
+  for (unsigned int by = first; by < last; ++by) {
+    for (unsigned int bx = 0; bx < blocks_x; ++bx) {
+      // Pixels past the edge repeat the last row or column.
+      for (unsigned int y = 0; y < 4; ++y) {
+        const unsigned int sy = std::min(by * 4 + y, height - 1);
+        for (unsigned int x = 0; x < 4; ++x) {
+          const unsigned int sx = std::min(bx * 4 + x, width - 1);
+          std::memcpy(block + (y * 4 + x) * 4,  // NOLINT
+                      rgba + (static_cast<std::size_t>(sy) * width + sx) * 4,
+                      4);
+        }
+      }
+      const std::size_t index = static_cast<std::size_t>(by) * blocks_x + bx;
+      encode_block(block, format, out + index * size);  // NOLINT
+    }
+  }
+}
+}  // namespace detail
+
+// Compresses an image of 4 bytes per pixel, rows first, to 'format'. Block
+// rows are shared between 'threads' threads. Returns the blocks in the order
+// expected by glCompressedTexImage2D.
+inline std::vector<unsigned char> encode_bc(
+    const unsigned char* rgba,
+    unsigned int width,
+    unsigned int height,
+    bc_format format,
+    unsigned int threads = std::thread::hardware_concurrency()) {
+  const unsigned int blocks_x = (width + 3) / 4;
+  const unsigned int blocks_y = (height + 3) / 4;
+  std::vector<unsigned char> out(static_cast<std::size_t>(blocks_x) *
+                                 blocks_y * block_size(format));
+  if (width == 0 || height == 0) {
+    return out;
+  }
+  threads = std::clamp(threads, 1U, blocks_y);
+  const unsigned int rows_per_thread = (blocks_y + threads - 1) / threads;
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned int t = 1; t < threads; ++t) {
+    const unsigned int first = std::min(t * rows_per_thread, blocks_y);
+    const unsigned int last = std::min(first + rows_per_thread, blocks_y);
+    workers.emplace_back([=, &out] {
+      detail::encode_block_rows(
+          rgba, width, height, format, first, last, out.data());
+    });
+  }
+  detail::encode_block_rows(rgba,
+                            width,
+                            height,
+                            format,
+                            0,
+                            std::min(rows_per_thread, blocks_y),
+                            out.data());
+  for (auto& w : workers) {
+    w.join();
+  }
+  return out;
+}
+
+// Header of a DDS file holding 'levels' mipmap levels of a 2D texture in
+// 'format', using the legacy FourCC codes understood by every reader. The
+// levels follow, largest first, each one as returned by encode_bc().
+inline std::vector<unsigned char> dds_header(bc_format format,
+                                             unsigned int width,
+                                             unsigned int height,
+                                             unsigned int levels) {
+  constexpr std::size_t header_size = 128;
+  std::vector<unsigned char> header(header_size, 0);
+  const auto put = [&header](std::size_t offset, std::uint32_t value) {
+    std::memcpy(header.data() + offset, &value, sizeof(value));  // NOLINT
+  };
+  const auto code = [](const char(&c)[5]) {  // NOLINT
+    std::uint32_t value{};
+    std::memcpy(&value, c, 4);
+    return value;
+  };
+  constexpr std::uint32_t caps = 0x1, height_flag = 0x2, width_flag = 0x4,
+                          pixel_format = 0x1000, mipmap_count = 0x20000,
+                          linear_size = 0x80000;
+  constexpr std::uint32_t complex = 0x8, texture = 0x1000, mipmap = 0x400000;
+  constexpr std::uint32_t four_cc_flag = 0x4;
+
+  put(0, code("DDS "));
+  put(4, 124);  // NOLINT
+  put(8,
+      caps | height_flag | width_flag | pixel_format | mipmap_count |
+          linear_size);
+  put(12, height);  // NOLINT
+  put(16, width);   // NOLINT
+  put(20,           // NOLINT
+      static_cast<std::uint32_t>(((width + 3) / 4) * ((height + 3) / 4) *
+                                 block_size(format)));
+  put(28, levels);        // NOLINT
+  put(76, 32);            // NOLINT
+  put(80, four_cc_flag);  // NOLINT
+  switch (format) {
+    case bc_format::bc1:
+      put(84, code("DXT1"));  // NOLINT
+      break;
+    case bc_format::bc3:
+      put(84, code("DXT5"));  // NOLINT
+      break;
+    case bc_format::bc4:
+      put(84, code("ATI1"));  // NOLINT
+      break;
+    case bc_format::bc5:
+      put(84, code("ATI2"));  // NOLINT
+      break;
+  }
+  put(108, texture | (levels > 1 ? complex | mipmap : 0));  // NOLINT
+  return header;
+}
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_BC_ENCODER_HEADER
\ No newline at end of file
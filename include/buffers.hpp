@@ -5,6 +5,10 @@
 
 #include "opengl.hpp"
 
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <optional>
 #include <utility>
 
 namespace dpsg {
@@ -86,6 +90,165 @@ public:
   using buffer::operator unsigned int;
 };
 
+namespace detail {
+inline bool has_buffer_storage() noexcept {
+#if defined(GL_VERSION_4_4)
+  if (GLAD_GL_VERSION_4_4) {
+    return true;
+  }
+#endif
+#if defined(GL_ARB_buffer_storage)
+  if (GLAD_GL_ARB_buffer_storage) {
+    return true;
+  }
+#endif
+  return false;
+}
+} // namespace detail
+
+// Ring of Regions equally sized regions of a single buffer object, meant for
+// geometry regenerated every frame. Each frame writes into its own region,
+// which is fenced at end_frame() and only reused once the GPU is done reading
+// it, so the driver never has to orphan or synchronize the storage.
+// The buffer is persistently mapped when buffer storage is available,
+// otherwise the current region is mapped unsynchronized between begin_frame()
+// and commit().
+template <std::size_t Regions = 3> class streaming_buffer : buffer {
+  static_assert(Regions > 0, "A streaming buffer needs at least one region");
+
+public:
+  struct allocation {
+    void *data;
+    gl::byte_offset offset; // from the start of the buffer object
+    gl::byte_size size;
+  };
+
+  streaming_buffer(gl::buffer_type type, gl::byte_size region_size) noexcept
+      : _type{type}, _region_size{region_size},
+        _persistent{detail::has_buffer_storage()} {
+    const gl::byte_size total{
+        static_cast<gl::size_t>(region_size.value * Regions)};
+    bind();
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+    if (_persistent) {
+      gl::buffer_storage(_type, total,
+                         gl::storage_flag::map_write |
+                             gl::storage_flag::map_persistent |
+                             gl::storage_flag::map_coherent);
+      _mapping = static_cast<std::byte *>(gl::map_buffer_range(
+          _type, gl::byte_offset{0}, total,
+          gl::map_access::write | gl::map_access::persistent |
+              gl::map_access::coherent));
+      return;
+    }
+#endif
+    gl::buffer_data(_type, total, gl::data_hint::stream_draw);
+  }
+
+  streaming_buffer(const streaming_buffer &) = delete;
+  streaming_buffer(streaming_buffer &&b) noexcept
+      : buffer(std::move(b)), _type{b._type}, _region_size{b._region_size},
+        _persistent{b._persistent},
+        _mapping{std::exchange(b._mapping, nullptr)},
+        _current{std::exchange(b._current, nullptr)}, _region{b._region},
+        _head{b._head} {
+    for (std::size_t i = 0; i < Regions; ++i) {
+      _fences[i] = std::exchange(b._fences[i], gl::sync_id{nullptr});
+    }
+  }
+  streaming_buffer &operator=(const streaming_buffer &) = delete;
+  streaming_buffer &operator=(streaming_buffer &&) = delete;
+  ~streaming_buffer() noexcept {
+    for (auto &fence : _fences) {
+      if (fence.value != nullptr) {
+        gl::delete_sync(fence);
+      }
+    }
+  }
+
+  void bind() const { buffer::bind(_type); }
+  using buffer::id;
+
+  // Waits for the GPU to release the current region and makes it writable.
+  void begin_frame() noexcept {
+    if (auto &fence = _fences[_region]; fence.value != nullptr) {
+      constexpr auto timeout = std::chrono::milliseconds{1};
+      while (gl::client_wait_sync(fence, timeout) ==
+             gl::wait_result::timeout_expired) {
+      }
+      gl::delete_sync(std::exchange(fence, gl::sync_id{nullptr}));
+    }
+    _head = 0;
+
+    if (_persistent) {
+      _current = _mapping + region_offset().value;
+    }
+    else {
+      bind();
+      _current = static_cast<std::byte *>(gl::map_buffer_range(
+          _type, region_offset(), _region_size,
+          gl::map_access::write | gl::map_access::unsynchronized |
+              gl::map_access::invalidate_range));
+    }
+  }
+
+  // Hands out 'size' bytes of the current region, or nothing if the region
+  // is exhausted. Only valid between begin_frame() and commit().
+  [[nodiscard]] std::optional<allocation>
+  allocate(gl::byte_size size,
+           std::size_t alignment = alignof(std::max_align_t)) noexcept {
+    assert(_current != nullptr);
+    const std::size_t start = (_head + alignment - 1) / alignment * alignment;
+    const auto size_v = static_cast<std::size_t>(size.value);
+    if (_current == nullptr ||
+        start + size_v > static_cast<std::size_t>(_region_size.value)) {
+      return {};
+    }
+    _head = start + size_v;
+    return allocation{
+        _current + start,
+        gl::byte_offset{
+            static_cast<unsigned int>(region_offset().value + start)},
+        size};
+  }
+
+  // Makes the data written so far visible to the GL. Must be called before
+  // issuing draw calls sourcing from the buffer.
+  void commit() noexcept {
+    if (!_persistent && _current != nullptr) {
+      bind();
+      gl::unmap_buffer(_type);
+    }
+    _current = nullptr;
+  }
+
+  // Fences the current region and moves on to the next one.
+  void end_frame() noexcept {
+    commit();
+    _fences[_region] = gl::fence_sync();
+    _region = (_region + 1) % Regions;
+  }
+
+  [[nodiscard]] gl::byte_offset region_offset() const noexcept {
+    return gl::byte_offset{
+        static_cast<unsigned int>(_region * _region_size.value)};
+  }
+  [[nodiscard]] gl::byte_size region_size() const noexcept {
+    return _region_size;
+  }
+  [[nodiscard]] bool persistent() const noexcept { return _persistent; }
+
+private:
+  gl::buffer_type _type;
+  gl::byte_size _region_size;
+  bool _persistent;
+  std::byte *_mapping{nullptr};
+  std::byte *_current{nullptr};
+  std::size_t _region{0};
+  std::size_t _head{0};
+  gl::sync_id _fences[Regions]{}; // NOLINT
+};
+
 template <std::size_t N> class vertex_array_impl {
 public:
   vertex_array_impl() noexcept { gl::gen_vertex_arrays(values); }
@@ -99,7 +262,7 @@ public:
   vertex_array_impl &operator=(vertex_array_impl &&a) noexcept {
 
     for (std::size_t i = 0; i < N; ++i) {
-      values[i] = std::exchange(a.values[i], gL::vertex_array_id{0});
+      values[i] = std::exchange(a.values[i], gl::vertex_array_id{0});
     }
 
     return *this;
@@ -0,0 +1,304 @@
+#ifndef GUARD_DPSG_COMMAND_BUFFER_HEADER
+#define GUARD_DPSG_COMMAND_BUFFER_HEADER
+
+#include "fixed_size_element_buffer.hpp"
+#include "opengl.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+// GL objects a draw depends on. They're what the sort key is made of, and
+// what the replay compares against the previous packet to skip binds.
+struct draw_state {
+  gl::program_id program{0};
+  gl::vertex_array_id vertex_array{0};
+  gl::texture_id texture{0};
+  // Free low bits of the key, e.g. quantized depth or a layer index. Packets
+  // sharing the same GL state are ordered by this value.
+  std::uint16_t order{0};
+};
+
+struct index_range {
+  gl::drawing_mode mode{gl::drawing_mode::triangles};
+  gl::index_type type{gl::index_type::unsigned_short};
+  gl::element_count count{0};
+  gl::offset offset{0};  // in indices
+  gl::index base_vertex{0};
+};
+
+template <class T, std::size_t N>
+constexpr index_range whole_range(
+    [[maybe_unused]] const fixed_size_element_buffer<T, N>& elements,
+    gl::drawing_mode mode = gl::drawing_mode::triangles) noexcept {
+  return index_range{mode,
+                     gl::index_type_of<T>,
+                     fixed_size_element_buffer<T, N>::element_count,
+                     gl::offset{0},
+                     gl::index{0}};
+}
+
+// A uniform upload recorded alongside a draw.
+class uniform_value {
+ public:
+  enum class kind : std::uint8_t { float1, float2, float3, float4, int1, mat4 };
+
+  uniform_value(gl::uniform_location loc, gl::float_t f) noexcept
+      : _location{loc}, _kind{kind::float1} {
+    _floats[0] = f;
+  }
+
+  uniform_value(gl::uniform_location loc, gl::int_t i) noexcept
+      : _location{loc}, _kind{kind::int1}, _int{i} {}
+
+  template <class M>
+  uniform_value(gl::uniform_location loc,
+                const gl::mat_t<4, 4, M>& matrix) noexcept
+      : uniform_value{
+            loc, kind::mat4, static_cast<const float*>(matrix.value)} {
+    static_assert(std::is_same_v<M, gl::column_major>,
+                  "Recorded matrices must be column major");
+  }
+
+  // Builds a value from raw floats, e.g. glm::value_ptr(matrix). The number
+  // of floats read depends on 'k'.
+  uniform_value(gl::uniform_location loc, kind k, const float* data) noexcept
+      : _location{loc}, _kind{k} {
+    std::memcpy(static_cast<float*>(_floats), data, size(k) * sizeof(float));
+  }
+
+  void upload() const noexcept {
+    const float* f = static_cast<const float*>(_floats);
+    switch (_kind) {
+      case kind::float1:
+        glUniform1fv(_location.value, 1, f);
+        break;
+      case kind::float2:
+        glUniform2fv(_location.value, 1, f);
+        break;
+      case kind::float3:
+        glUniform3fv(_location.value, 1, f);
+        break;
+      case kind::float4:
+        glUniform4fv(_location.value, 1, f);
+        break;
+      case kind::int1:
+        glUniform1i(_location.value, _int);
+        break;
+      case kind::mat4:
+        glUniformMatrix4fv(_location.value, 1, GL_FALSE, f);
+        break;
+    }
+  }
+
+  [[nodiscard]] gl::uniform_location location() const noexcept {
+    return _location;
+  }
+
+ private:
+  constexpr static std::size_t size(kind k) noexcept {
+    switch (k) {
+      case kind::float2:
+        return 2;
+      case kind::float3:
+        return 3;
+      case kind::float4:
+        return 4;
+      case kind::mat4:
+        return 16;  // NOLINT
+      case kind::float1:
+      case kind::int1:
+      default:
+        return 1;
+    }
+  }
+
+  gl::uniform_location _location;
+  kind _kind;
+  gl::int_t _int{0};
+  float _floats[16]{};  // NOLINT
+};
+
+struct draw_packet {
+  draw_state state;
+  index_range range;
+  std::uint32_t first_uniform;
+  std::uint32_t uniform_count;
+};
+
+struct sort_entry {
+  std::uint64_t key;
+  std::uint32_t index;
+};
+
+// Program bits go highest since a program switch is the most expensive,
+// followed by the vertex array and the texture. Ids are truncated to 16 bits,
+// which only affects the quality of the grouping, never correctness.
+[[nodiscard]] constexpr std::uint64_t make_sort_key(
+    const draw_state& state) noexcept {
+  constexpr std::uint64_t mask = 0xFFFF;
+  return ((state.program.value & mask) << 48U) |
+         ((state.vertex_array.value & mask) << 32U) |
+         ((state.texture.value & mask) << 16U) | state.order;
+}
+
+// Stable LSD radix sort on the 64 bit keys, one byte per pass. Passes in which
+// every key has the same byte are skipped, so in practice only the bytes
+// holding actual ids cost anything. Doesn't touch the GL, so it can be
+// benchmarked on its own.
+inline void radix_sort(std::vector<sort_entry>& entries,
+                       std::vector<sort_entry>& scratch) {
+  constexpr std::size_t radix = 256;
+  constexpr std::size_t passes = sizeof(std::uint64_t);
+  scratch.resize(entries.size());
+
+  std::size_t histograms[passes][radix]{};  // NOLINT
+  for (const auto& e : entries) {
+    for (std::size_t p = 0; p < passes; ++p) {
+      ++histograms[p][(e.key >> (p * 8U)) & 0xFFU];  // NOLINT
+    }
+  }
+
+  for (std::size_t p = 0; p < passes; ++p) {
+    auto& histogram = histograms[p];  // NOLINT
+    const bool trivial = std::any_of(
+        std::begin(histogram), std::end(histogram), [&entries](std::size_t c) {
+          return c == entries.size();
+        });
+    if (trivial) {
+      continue;
+    }
+
+    std::size_t sum = 0;
+    for (auto& count : histogram) {
+      sum += std::exchange(count, sum);
+    }
+    for (const auto& e : entries) {
+      scratch[histogram[(e.key >> (p * 8U)) & 0xFFU]++] = e;  // NOLINT
+    }
+    entries.swap(scratch);
+  }
+}
+
+struct command_stats {
+  std::size_t draws{0};
+  std::size_t program_binds{0};
+  std::size_t vertex_array_binds{0};
+  std::size_t texture_binds{0};
+  std::size_t uniform_uploads{0};
+};
+
+// Records draw packets instead of issuing them right away, then replays them
+// sorted by state with redundant binds removed.
+//
+//    queue.record(state, whole_range(elements), uniform_value{...});
+//    ...
+//    queue.sort();
+//    queue.submit();
+//    queue.clear();
+class command_buffer {
+ public:
+  template <class... Uniforms>
+  void record(const draw_state& state,
+              const index_range& range,
+              Uniforms&&... uniforms) {
+    static_assert(
+        std::conjunction_v<
+            std::is_convertible<std::decay_t<Uniforms>, uniform_value>...>,
+        "record expects uniform_values after the index range");
+    const auto first = static_cast<std::uint32_t>(_uniforms.size());
+    (_uniforms.emplace_back(std::forward<Uniforms>(uniforms)), ...);
+    _entries.push_back(sort_entry{make_sort_key(state),
+                                  static_cast<std::uint32_t>(_packets.size())});
+    _packets.push_back(draw_packet{
+        state, range, first, static_cast<std::uint32_t>(sizeof...(Uniforms))});
+  }
+
+  void sort() { radix_sort(_entries, _scratch); }
+
+  // Issues every recorded packet in the current order. The bindings left by a
+  // previous submit are not trusted, since client code may have changed them
+  // in the meantime.
+  command_stats submit() const noexcept {
+    command_stats stats;
+    const draw_packet* previous = nullptr;
+    for (const auto& entry : _entries) {
+      const draw_packet& packet = _packets[entry.index];
+      const draw_state& state = packet.state;
+      if (previous == nullptr ||
+          previous->state.program.value != state.program.value) {
+        gl::use_program(state.program);
+        ++stats.program_binds;
+      }
+      if (previous == nullptr ||
+          previous->state.vertex_array.value != state.vertex_array.value) {
+        gl::bind_vertex_array(state.vertex_array);
+        ++stats.vertex_array_binds;
+      }
+      if (previous == nullptr ||
+          previous->state.texture.value != state.texture.value) {
+        gl::bind_texture(gl::texture_target::_2d, state.texture);
+        ++stats.texture_binds;
+      }
+
+      for (std::uint32_t u = 0; u < packet.uniform_count; ++u) {
+        _uniforms[packet.first_uniform + u].upload();
+      }
+      stats.uniform_uploads += packet.uniform_count;
+
+      const index_range& r = packet.range;
+      gl::draw_elements_base_vertex(
+          r.mode,
+          r.count,
+          r.type,
+          gl::byte_offset{r.offset.value * index_size(r.type)},
+          r.base_vertex);
+      ++stats.draws;
+      previous = &packet;
+    }
+    return stats;
+  }
+
+  void clear() noexcept {
+    _packets.clear();
+    _entries.clear();
+    _uniforms.clear();
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return _packets.size(); }
+  [[nodiscard]] bool empty() const noexcept { return _packets.empty(); }
+
+  void reserve(std::size_t packets, std::size_t uniforms) {
+    _packets.reserve(packets);
+    _entries.reserve(packets);
+    _scratch.reserve(packets);
+    _uniforms.reserve(uniforms);
+  }
+
+ private:
+  constexpr static unsigned int index_size(gl::index_type type) noexcept {
+    switch (type) {
+      case gl::index_type::unsigned_byte:
+        return 1;
+      case gl::index_type::unsigned_short:
+        return 2;
+      case gl::index_type::unsigned_int:
+      default:
+        return 4;
+    }
+  }
+
+  std::vector<draw_packet> _packets;
+  std::vector<sort_entry> _entries;
+  std::vector<sort_entry> _scratch;
+  std::vector<uniform_value> _uniforms;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_COMMAND_BUFFER_HEADER
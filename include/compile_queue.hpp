@@ -0,0 +1,159 @@
+#ifndef GUARD_DPSG_COMPILE_QUEUE_HEADER
+#define GUARD_DPSG_COMPILE_QUEUE_HEADER
+
+#include "opengl.hpp"
+#include "program.hpp"
+#include "result.hpp"
+#include "shaders.hpp"
+
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+namespace detail {
+inline bool has_parallel_shader_compile() noexcept {
+#if defined(GL_KHR_parallel_shader_compile)
+  return GLAD_GL_KHR_parallel_shader_compile != 0;
+#else
+  return false;
+#endif
+}
+
+// GL objects of a program under construction. Whatever hasn't been handed
+// over to a shader or program wrapper is deleted with the job.
+struct compile_job {
+  gl::shader_id<gl::shader_type::vertex> vertex{{0}};
+  gl::shader_id<gl::shader_type::fragment> fragment{{0}};
+  gl::program_id program{0};
+  bool linked{false};
+  bool parallel{false};
+
+  compile_job() noexcept = default;
+  compile_job(const compile_job&) = delete;
+  compile_job(compile_job&&) = delete;
+  compile_job& operator=(const compile_job&) = delete;
+  compile_job& operator=(compile_job&&) = delete;
+  ~compile_job() noexcept {
+    gl::delete_shader(vertex);
+    gl::delete_shader(fragment);
+    gl::delete_program(program);
+  }
+
+  void link() noexcept {
+    if (linked) {
+      return;
+    }
+    linked = true;
+    program = gl::create_program();
+    gl::attach_shader(program, vertex, fragment);
+    gl::link_program(program);
+  }
+};
+}  // namespace detail
+
+// Program whose compilation and linking may still be running in the driver.
+// Nothing is queried from GL until ready() or get() is called.
+class pending_program {
+ public:
+  // Whether get() would return without waiting. Always true when the driver
+  // doesn't support KHR_parallel_shader_compile, in which case get() may
+  // still block while the driver compiles on the calling thread. False once
+  // get() has been called.
+  [[nodiscard]] bool ready() const noexcept {
+    if (!_job) {
+      return false;
+    }
+    _job->link();
+#if defined(GL_KHR_parallel_shader_compile)
+    if (_job->parallel) {
+      return gl::completion_status(_job->program);
+    }
+#endif
+    return true;
+  }
+
+  // Checks the compilation of each shader, then the link. Consumes the
+  // pending program, which is no longer valid() afterwards.
+  [[nodiscard]] result<program, gl_error> get() && noexcept {
+    assert(_job != nullptr && "pending_program::get() called twice");
+    auto job = std::exchange(_job, nullptr);
+    job->link();
+    return vertex_shader::from_compiled(std::exchange(job->vertex, {{0}}))
+        .then([&job]([[maybe_unused]] auto&& vshader) {
+          return fragment_shader::from_compiled(
+                     std::exchange(job->fragment, {{0}}))
+              .then([&job]([[maybe_unused]] auto&& fshader) {
+                return result<program, gl_error>(program::from_linked(
+                    std::exchange(job->program, gl::program_id{0})));
+              });
+        });
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return _job != nullptr; }
+
+ private:
+  friend class compile_queue;
+  explicit pending_program(std::shared_ptr<detail::compile_job> job) noexcept
+      : _job{std::move(job)} {}
+
+  std::shared_ptr<detail::compile_job> _job;
+};
+
+// Batches program creation so that the driver can work on every shader at
+// once: all the shaders are submitted for compilation first, then all the
+// programs are linked, and statuses are only queried when the programs are
+// actually needed. Turns on KHR_parallel_shader_compile when available.
+//
+//    compile_queue queue;
+//    auto a = queue.submit(vs_source{...}, fs_source{...});
+//    auto b = queue.submit(vs_source{...}, fs_source{...});
+//    queue.link();
+//    ...
+//    if (a.ready()) {
+//      program p = std::move(a).get().value();
+//    }
+class compile_queue {
+ public:
+  compile_queue() noexcept
+      : _parallel{detail::has_parallel_shader_compile()} {
+#if defined(GL_KHR_parallel_shader_compile)
+    if (_parallel) {
+      gl::max_shader_compiler_threads(0xFFFFFFFF);  // NOLINT
+    }
+#endif
+  }
+
+  template <class T, class U>
+  [[nodiscard]] pending_program submit(const vs_source<T>& vs,
+                                       const fs_source<U>& fs) {
+    auto job = std::make_shared<detail::compile_job>();
+    job->vertex = vertex_shader::compile(vs);
+    job->fragment = fragment_shader::compile(fs);
+    job->parallel = _parallel;
+    _unlinked.push_back(job);
+    return pending_program{std::move(job)};
+  }
+
+  // Starts linking every program submitted since the last call. Programs that
+  // are used before this is called are linked on first use.
+  void link() noexcept {
+    for (const auto& job : _unlinked) {
+      job->link();
+    }
+    _unlinked.clear();
+  }
+
+  // Whether the driver compiles in the background.
+  [[nodiscard]] bool parallel() const noexcept { return _parallel; }
+
+ private:
+  bool _parallel;
+  std::vector<std::shared_ptr<detail::compile_job>> _unlinked;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_COMPILE_QUEUE_HEADER
\ No newline at end of file
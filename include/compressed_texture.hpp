@@ -0,0 +1,464 @@
+#ifndef GUARD_DPSG_COMPRESSED_TEXTURE_HEADER
+#define GUARD_DPSG_COMPRESSED_TEXTURE_HEADER
+
+#include "embedded.hpp"
+#include "loading_error.hpp"
+#include "mapped_file.hpp"
+#include "opengl.hpp"
+#include "result.hpp"
+#include "stbi_wrapper.hpp"
+#include "texture.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+// Image stored in a GPU compressed format, as found in a DDS or KTX2 file.
+// The levels point into the memory of the file.
+struct compressed_image {
+  gl::compressed_internal_format format;
+  std::vector<compressed_level> levels;
+};
+
+namespace detail {
+// Both containers are little endian, as are all the platforms we target.
+template <class T>
+T read_le(const unsigned char* data) noexcept {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+constexpr inline std::uint32_t four_cc(const char (&code)[5]) noexcept {
+  return static_cast<std::uint32_t>(static_cast<unsigned char>(code[0])) |
+         static_cast<std::uint32_t>(static_cast<unsigned char>(code[1]))
+             << 8U |
+         static_cast<std::uint32_t>(static_cast<unsigned char>(code[2]))
+             << 16U |
+         static_cast<std::uint32_t>(static_cast<unsigned char>(code[3]))
+             << 24U;
+}
+
+// Compressed format and size of a 4x4 block, or a null block size if the
+// format isn't supported by this build.
+struct block_format {
+  gl::compressed_internal_format format;
+  std::size_t block_size;
+};
+
+constexpr inline block_format no_block_format{
+    gl::compressed_internal_format::rgba, 0};
+
+constexpr inline block_format dds_four_cc_format(std::uint32_t code) noexcept {
+  using f = gl::compressed_internal_format;
+#ifdef GL_EXT_texture_compression_s3tc
+  if (code == four_cc("DXT1")) {
+    return {f::rgba_s3tc_dxt1, 8};
+  }
+  if (code == four_cc("DXT3")) {
+    return {f::rgba_s3tc_dxt3, 16};  // NOLINT
+  }
+  if (code == four_cc("DXT5")) {
+    return {f::rgba_s3tc_dxt5, 16};  // NOLINT
+  }
+#endif
+  if (code == four_cc("ATI1") || code == four_cc("BC4U")) {
+    return {f::red_rgtc1, 8};
+  }
+  if (code == four_cc("BC4S")) {
+    return {f::signed_red_rgtc1, 8};
+  }
+  if (code == four_cc("ATI2") || code == four_cc("BC5U")) {
+    return {f::rg_rgtc2, 16};  // NOLINT
+  }
+  if (code == four_cc("BC5S")) {
+    return {f::signed_rg_rgtc2, 16};  // NOLINT
+  }
+  return no_block_format;
+}
+
+constexpr inline block_format dxgi_format(std::uint32_t format) noexcept {
+  using f = gl::compressed_internal_format;
+  switch (format) {
+#ifdef GL_EXT_texture_compression_s3tc
+    case 71:  // BC1_UNORM
+      return {f::rgba_s3tc_dxt1, 8};
+    case 74:  // BC2_UNORM
+      return {f::rgba_s3tc_dxt3, 16};  // NOLINT
+    case 77:  // BC3_UNORM
+      return {f::rgba_s3tc_dxt5, 16};  // NOLINT
+#endif
+#ifdef GL_EXT_texture_sRGB
+    case 72:  // BC1_UNORM_SRGB
+      return {f::srgb_alpha_s3tc_dxt1, 8};
+    case 75:  // BC2_UNORM_SRGB
+      return {f::srgb_alpha_s3tc_dxt3, 16};  // NOLINT
+    case 78:  // BC3_UNORM_SRGB
+      return {f::srgb_alpha_s3tc_dxt5, 16};  // NOLINT
+#endif
+    case 80:  // BC4_UNORM
+      return {f::red_rgtc1, 8};
+    case 81:  // BC4_SNORM
+      return {f::signed_red_rgtc1, 8};
+    case 83:  // BC5_UNORM
+      return {f::rg_rgtc2, 16};  // NOLINT
+    case 84:  // BC5_SNORM
+      return {f::signed_rg_rgtc2, 16};  // NOLINT
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_compression_bptc)
+    case 95:  // BC6H_UF16
+      return {f::rgb_bptc_unsigned_float, 16};  // NOLINT
+    case 96:  // BC6H_SF16
+      return {f::rgb_bptc_signed_float, 16};  // NOLINT
+    case 98:  // BC7_UNORM
+      return {f::rgba_bptc_unorm, 16};  // NOLINT
+    case 99:  // BC7_UNORM_SRGB
+      return {f::srgb_alpha_bptc_unorm, 16};  // NOLINT
+#endif
+    default:
+      return no_block_format;
+  }
+}
+
+constexpr inline block_format vk_format(std::uint32_t format) noexcept {
+  using f = gl::compressed_internal_format;
+  switch (format) {
+#ifdef GL_EXT_texture_compression_s3tc
+    case 131:  // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+      return {f::rgb_s3tc_dxt1, 8};
+    case 133:  // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+      return {f::rgba_s3tc_dxt1, 8};
+    case 135:  // VK_FORMAT_BC2_UNORM_BLOCK
+      return {f::rgba_s3tc_dxt3, 16};  // NOLINT
+    case 137:  // VK_FORMAT_BC3_UNORM_BLOCK
+      return {f::rgba_s3tc_dxt5, 16};  // NOLINT
+#endif
+#ifdef GL_EXT_texture_sRGB
+    case 132:  // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+      return {f::srgb_s3tc_dxt1, 8};
+    case 134:  // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+      return {f::srgb_alpha_s3tc_dxt1, 8};
+    case 136:  // VK_FORMAT_BC2_SRGB_BLOCK
+      return {f::srgb_alpha_s3tc_dxt3, 16};  // NOLINT
+    case 138:  // VK_FORMAT_BC3_SRGB_BLOCK
+      return {f::srgb_alpha_s3tc_dxt5, 16};  // NOLINT
+#endif
+    case 139:  // VK_FORMAT_BC4_UNORM_BLOCK
+      return {f::red_rgtc1, 8};
+    case 140:  // VK_FORMAT_BC4_SNORM_BLOCK
+      return {f::signed_red_rgtc1, 8};
+    case 141:  // VK_FORMAT_BC5_UNORM_BLOCK
+      return {f::rg_rgtc2, 16};  // NOLINT
+    case 142:  // VK_FORMAT_BC5_SNORM_BLOCK
+      return {f::signed_rg_rgtc2, 16};  // NOLINT
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_compression_bptc)
+    case 143:  // VK_FORMAT_BC6H_UFLOAT_BLOCK
+      return {f::rgb_bptc_unsigned_float, 16};  // NOLINT
+    case 144:  // VK_FORMAT_BC6H_SFLOAT_BLOCK
+      return {f::rgb_bptc_signed_float, 16};  // NOLINT
+    case 145:  // VK_FORMAT_BC7_UNORM_BLOCK
+      return {f::rgba_bptc_unorm, 16};  // NOLINT
+    case 146:  // VK_FORMAT_BC7_SRGB_BLOCK
+      return {f::srgb_alpha_bptc_unorm, 16};  // NOLINT
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_ES3_compatibility)
+    case 147:  // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+      return {f::rgb8_etc2, 8};
+    case 148:  // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+      return {f::srgb8_etc2, 8};
+    case 149:  // VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK
+      return {f::rgb8_punchthrough_alpha1_etc2, 8};
+    case 150:  // VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK
+      return {f::srgb8_punchthrough_alpha1_etc2, 8};
+    case 151:  // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+      return {f::rgba8_etc2_eac, 16};  // NOLINT
+    case 152:  // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+      return {f::srgb8_alpha8_etc2_eac, 16};  // NOLINT
+#endif
+    default:
+      return no_block_format;
+  }
+}
+
+// Size of a level made of 4x4 blocks. Partial blocks are stored whole.
+constexpr inline std::size_t compressed_size(unsigned int width,
+                                             unsigned int height,
+                                             std::size_t block_size) noexcept {
+  return std::max((width + 3U) / 4U, 1U) * std::max((height + 3U) / 4U, 1U) *
+         block_size;
+}
+
+constexpr inline unsigned int level_extent(unsigned int base,
+                                           unsigned int level) noexcept {
+  return std::max(base >> level, 1U);
+}
+
+inline bool has_bptc() noexcept {
+#if defined(GL_VERSION_4_2)
+  if (GLAD_GL_VERSION_4_2) {
+    return true;
+  }
+#endif
+#if defined(GL_ARB_texture_compression_bptc)
+  if (GLAD_GL_ARB_texture_compression_bptc) {
+    return true;
+  }
+#endif
+  return false;
+}
+
+inline bool has_etc2() noexcept {
+#if defined(GL_VERSION_4_3)
+  if (GLAD_GL_VERSION_4_3) {
+    return true;
+  }
+#endif
+#if defined(GL_ARB_ES3_compatibility)
+  if (GLAD_GL_ARB_ES3_compatibility) {
+    return true;
+  }
+#endif
+  return false;
+}
+
+// Whether the context can sample the format. Formats outside of the core
+// profile depend on extensions.
+inline bool supports(gl::compressed_internal_format format) noexcept {
+  switch (format) {
+#ifdef GL_EXT_texture_compression_s3tc
+    case gl::compressed_internal_format::rgb_s3tc_dxt1:
+    case gl::compressed_internal_format::rgba_s3tc_dxt1:
+    case gl::compressed_internal_format::rgba_s3tc_dxt3:
+    case gl::compressed_internal_format::rgba_s3tc_dxt5:
+      return GLAD_GL_EXT_texture_compression_s3tc != 0;
+#endif
+#ifdef GL_EXT_texture_sRGB
+    case gl::compressed_internal_format::srgb_s3tc_dxt1:
+    case gl::compressed_internal_format::srgb_alpha_s3tc_dxt1:
+    case gl::compressed_internal_format::srgb_alpha_s3tc_dxt3:
+    case gl::compressed_internal_format::srgb_alpha_s3tc_dxt5:
+      return GLAD_GL_EXT_texture_sRGB != 0;
+#endif
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_compression_bptc)
+    case gl::compressed_internal_format::rgba_bptc_unorm:
+    case gl::compressed_internal_format::srgb_alpha_bptc_unorm:
+    case gl::compressed_internal_format::rgb_bptc_signed_float:
+    case gl::compressed_internal_format::rgb_bptc_unsigned_float:
+      return has_bptc();
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_ES3_compatibility)
+    case gl::compressed_internal_format::rgb8_etc2:
+    case gl::compressed_internal_format::srgb8_etc2:
+    case gl::compressed_internal_format::rgb8_punchthrough_alpha1_etc2:
+    case gl::compressed_internal_format::srgb8_punchthrough_alpha1_etc2:
+    case gl::compressed_internal_format::rgba8_etc2_eac:
+    case gl::compressed_internal_format::srgb8_alpha8_etc2_eac:
+      return has_etc2();
+#endif
+    default:
+      return true;
+  }
+}
+
+inline result<compressed_image, const char*> parse_dds(
+    const unsigned char* data,
+    std::size_t size) {
+  constexpr std::size_t header_size = 128;
+  constexpr std::size_t dx10_header_size = 20;
+  constexpr std::uint32_t fourcc_flag = 0x4;
+  constexpr std::uint32_t cube_map_flag = 0x200;
+  constexpr std::uint32_t volume_flag = 0x200000;
+  if (size < header_size || read_le<std::uint32_t>(data) != four_cc("DDS ")) {
+    return failure{"not a DDS file"};
+  }
+  const auto height = read_le<std::uint32_t>(data + 12);      // NOLINT
+  const auto width = read_le<std::uint32_t>(data + 16);       // NOLINT
+  const auto mip_count = read_le<std::uint32_t>(data + 28);   // NOLINT
+  const auto pf_flags = read_le<std::uint32_t>(data + 80);    // NOLINT
+  const auto pf_four_cc = read_le<std::uint32_t>(data + 84);  // NOLINT
+  const auto caps2 = read_le<std::uint32_t>(data + 112);      // NOLINT
+  if ((caps2 & (cube_map_flag | volume_flag)) != 0) {
+    return failure{"cube maps and volume textures are not supported"};
+  }
+  if ((pf_flags & fourcc_flag) == 0) {
+    return failure{"uncompressed DDS files are not supported"};
+  }
+
+  std::size_t offset = header_size;
+  block_format format = no_block_format;
+  if (pf_four_cc == four_cc("DX10")) {
+    if (size < header_size + dx10_header_size) {
+      return failure{"truncated DX10 header"};
+    }
+    constexpr std::uint32_t texture_2d_dimension = 3;
+    const auto dxgi = read_le<std::uint32_t>(data + 128);        // NOLINT
+    const auto dimension = read_le<std::uint32_t>(data + 132);   // NOLINT
+    const auto misc = read_le<std::uint32_t>(data + 136);        // NOLINT
+    const auto array_size = read_le<std::uint32_t>(data + 140);  // NOLINT
+    if (dimension != texture_2d_dimension || (misc & 0x4U) != 0 ||
+        array_size > 1) {
+      return failure{"only single 2D textures are supported"};
+    }
+    format = dxgi_format(dxgi);
+    offset += dx10_header_size;
+  }
+  else {
+    format = dds_four_cc_format(pf_four_cc);
+  }
+  if (format.block_size == 0) {
+    return failure{"unsupported compressed format"};
+  }
+
+  compressed_image image{format.format, {}};
+  const unsigned int levels = std::max(mip_count, 1U);
+  for (unsigned int level = 0; level < levels; ++level) {
+    const auto w = level_extent(width, level);
+    const auto h = level_extent(height, level);
+    const auto level_size = compressed_size(w, h, format.block_size);
+    if (offset + level_size > size) {
+      return failure{"truncated mipmap level"};
+    }
+    image.levels.push_back(compressed_level{
+        gl::width{w},
+        gl::height{h},
+        data + offset,  // NOLINT
+        gl::byte_size{static_cast<gl::size_t>(level_size)}});
+    offset += level_size;
+  }
+  return success{std::move(image)};
+}
+
+inline result<compressed_image, const char*> parse_ktx2(
+    const unsigned char* data,
+    std::size_t size) {
+  constexpr unsigned char identifier[12] = {  // NOLINT
+      0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  constexpr std::size_t level_index_offset = 80;
+  constexpr std::size_t level_entry_size = 24;
+  if (size < level_index_offset ||
+      std::memcmp(data, identifier, sizeof(identifier)) != 0) {
+    return failure{"not a KTX2 file"};
+  }
+  const auto format = vk_format(read_le<std::uint32_t>(data + 12));  // NOLINT
+  const auto width = read_le<std::uint32_t>(data + 20);              // NOLINT
+  const auto height = read_le<std::uint32_t>(data + 24);             // NOLINT
+  const auto depth = read_le<std::uint32_t>(data + 28);              // NOLINT
+  const auto layers = read_le<std::uint32_t>(data + 32);             // NOLINT
+  const auto faces = read_le<std::uint32_t>(data + 36);              // NOLINT
+  const auto levels = std::max(read_le<std::uint32_t>(data + 40), 1U);
+  const auto supercompression = read_le<std::uint32_t>(data + 44);  // NOLINT
+  if (depth > 1 || layers > 1 || faces != 1) {
+    return failure{"only single 2D textures are supported"};
+  }
+  if (supercompression != 0) {
+    return failure{"supercompressed KTX2 files are not supported"};
+  }
+  if (format.block_size == 0) {
+    return failure{"unsupported compressed format"};
+  }
+  if (level_index_offset + levels * level_entry_size > size) {
+    return failure{"truncated level index"};
+  }
+
+  compressed_image image{format.format, {}};
+  for (unsigned int level = 0; level < levels; ++level) {
+    const auto* entry = data + level_index_offset +  // NOLINT
+                        level * level_entry_size;
+    const auto offset = read_le<std::uint64_t>(entry);
+    const auto length = read_le<std::uint64_t>(entry + 8);  // NOLINT
+    const auto w = level_extent(width, level);
+    const auto h = level_extent(height, level);
+    if (offset > size || length > size - offset ||
+        length < compressed_size(w, h, format.block_size)) {
+      return failure{"truncated mipmap level"};
+    }
+    image.levels.push_back(compressed_level{
+        gl::width{w},
+        gl::height{h},
+        data + offset,  // NOLINT
+        gl::byte_size{static_cast<gl::size_t>(length)}});
+  }
+  return success{std::move(image)};
+}
+
+// Picks the parser from the first bytes of the file.
+inline result<compressed_image, const char*> parse_compressed(
+    const unsigned char* data,
+    std::size_t size) {
+  if (size >= 4 && read_le<std::uint32_t>(data) == four_cc("DDS ")) {
+    return parse_dds(data, size);
+  }
+  return parse_ktx2(data, size);
+}
+
+template <class TextureOptions>
+result<texture_2d, loading_error> make_compressed_texture(
+    const unsigned char* data,
+    std::size_t size,
+    const char* name,
+    TextureOptions&& options) {
+  auto parsed = parse_compressed(data, size);
+  if (!parsed.has_value()) {
+    return failure{name, parsed.error()};
+  }
+  const auto& image = parsed.value();
+  if (!supports(image.format)) {
+    return failure{name, "compressed format not supported by the context"};
+  }
+  return success{texture_2d{
+      image.format, image.levels, std::forward<TextureOptions>(options)}};
+}
+}  // namespace detail
+
+// Loads a DDS or KTX2 file holding a single 2D texture in a block compressed
+// format (BC1 to BC7, or ETC2 when the context supports them). Every mipmap
+// level in the file is uploaded as is with glCompressedTexImage2D: nothing is
+// decoded on the CPU, and the texture takes a quarter to an eighth of the
+// memory of the same image decoded by stb.
+//
+// Unlike load(), images aren't flipped: the tool writing the file must store
+// rows bottom first, as examples/compress_textures does.
+template <class TextureOptions, class T>
+result<texture_2d, loading_error> load_compressed(
+    const texture_filename<T>& filename,
+    TextureOptions&& options) {
+  auto file = mapped_file::open(filename.c_str());
+  if (!file.has_value()) {
+    return failure{std::move(file).error()};
+  }
+  return detail::make_compressed_texture(file.value().data(),
+                                         file.value().size(),
+                                         filename.c_str(),
+                                         std::forward<TextureOptions>(options));
+}
+
+template <class TextureOptions>
+result<texture_2d, loading_error> load_compressed(
+    const texture_embedded& texture,
+    TextureOptions&& options) {
+  const auto& file = texture.file();
+  return detail::make_compressed_texture(file.data,
+                                         file.size,
+                                         std::string{file.name}.c_str(),
+                                         std::forward<TextureOptions>(options));
+}
+
+template <class T>
+result<texture_2d, loading_error> load_compressed(
+    const texture_filename<T>& filename) {
+  return load_compressed(filename, texture_options::no_options);
+}
+
+inline result<texture_2d, loading_error> load_compressed(
+    const texture_embedded& texture) {
+  return load_compressed(texture, texture_options::no_options);
+}
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_COMPRESSED_TEXTURE_HEADER
\ No newline at end of file
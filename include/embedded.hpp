@@ -0,0 +1,53 @@
+#ifndef GUARD_DPSG_EMBEDDED_HEADER
+#define GUARD_DPSG_EMBEDDED_HEADER
+
+#include <cstddef>
+#include <string_view>
+
+namespace dpsg {
+
+// File compiled into the executable by the dpsg_embed_resources() CMake
+// function (see cmake/embed_resources.cmake). The data is followed by a null
+// byte that isn't counted in 'size', so text files can be used as C strings.
+struct embedded_file {
+  // Path relative to the base directory given to dpsg_embed_resources(),
+  // with '/' as separator.
+  std::string_view name;
+  const unsigned char* data;
+  std::size_t size;
+
+  [[nodiscard]] const char* c_str() const noexcept {
+    return reinterpret_cast<const char*>(data);  // NOLINT
+  }
+
+  [[nodiscard]] std::string_view view() const noexcept {
+    return std::string_view{c_str(), size};
+  }
+};
+
+// Every file embedded by one call to dpsg_embed_resources().
+struct embedded_directory {
+  const embedded_file* files;
+  std::size_t count;
+
+  [[nodiscard]] constexpr const embedded_file* find(
+      std::string_view name) const noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+      if (files[i].name == name) {  // NOLINT
+        return files + i;           // NOLINT
+      }
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] constexpr const embedded_file* begin() const noexcept {
+    return files;
+  }
+  [[nodiscard]] constexpr const embedded_file* end() const noexcept {
+    return files + count;  // NOLINT
+  }
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_EMBEDDED_HEADER
\ No newline at end of file
@@ -26,21 +26,44 @@ struct fixed_size_element_buffer {
 
   template <class... Args>
   inline void draw(Args&&... args) const noexcept {
-    const gl::offset o = gl::detail::get<gl::offset>(args..., gl::offset{0});
+    const gl::offset o{gl::detail::get<gl::offset>(args..., gl::offset{0})};
     const gl::drawing_mode mode =
         gl::detail::get<gl::drawing_mode>(args..., gl::drawing_mode::triangles);
-    const gl::element_count count = gl::detail::get<gl::element_count>(
-        args..., gl::element_count{element_count});
+    const gl::element_count count{gl::detail::get<gl::element_count>(
+        args..., gl::element_count{element_count})};
 
-    if constexpr (gl::detail::contains<gl::index>(args...)) {
+    if constexpr (gl::detail::contains_v<gl::index, std::decay_t<Args>...>) {
       gl::draw_elements<value_type>(
-          mode, count, o, gl::detail::get<gl::index>(args...));
+          mode, count, o, gl::index{gl::detail::get<gl::index>(args...)});
     }
     else {
       gl::draw_elements<value_type>(mode, count, o);
     }
   }
 
+  // Same optional arguments as draw().
+  template <class... Args>
+  inline void draw_instanced(gl::instance_count instances,
+                             Args&&... args) const noexcept {
+    const gl::offset o{gl::detail::get<gl::offset>(args..., gl::offset{0})};
+    const gl::drawing_mode mode =
+        gl::detail::get<gl::drawing_mode>(args..., gl::drawing_mode::triangles);
+    const gl::element_count count{gl::detail::get<gl::element_count>(
+        args..., gl::element_count{element_count})};
+
+    if constexpr (gl::detail::contains_v<gl::index, std::decay_t<Args>...>) {
+      gl::draw_elements_instanced<value_type>(
+          mode,
+          count,
+          instances,
+          o,
+          gl::index{gl::detail::get<gl::index>(args...)});
+    }
+    else {
+      gl::draw_elements_instanced<value_type>(mode, count, instances, o);
+    }
+  }
+
  private:
   element_buffer _ebo;
 };
@@ -0,0 +1,407 @@
+#ifndef GUARD_DPSG_FLAT_HIERARCHY_HEADER
+#define GUARD_DPSG_FLAT_HIERARCHY_HEADER
+
+#include "meta/composite.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dpsg {
+
+namespace detail {
+
+template <class H>
+struct node_count : std::integral_constant<std::size_t, 0> {};
+
+template <class T, class... Cs>
+struct node_count<tagged_composite<T, Cs...>>
+    : std::integral_constant<std::size_t,
+                             (1 + ... + node_count<Cs>::value)> {};
+
+template <class H>
+constexpr static inline std::size_t node_count_v = node_count<H>::value;
+
+// Pre-order index of the node designated by the path P..., relative to the
+// node of type H located at index I. Path elements that aren't the tag of a
+// child composite (i.e. leaves) designate the node that contains them.
+template <class H, std::size_t I, class... P>
+struct node_index : std::integral_constant<std::size_t, I> {};
+
+template <std::size_t I, class R, class... Cs>
+struct child_index;
+
+template <std::size_t I, class R>
+struct child_index<I, R> {
+  constexpr static inline bool found = false;
+  constexpr static inline std::size_t value = I;
+  using type = void;
+};
+
+template <std::size_t I, class R, class C, class... Cs>
+struct child_index<I, R, C, Cs...>
+    : child_index<I + node_count_v<C>, R, Cs...> {};
+
+template <std::size_t I, class R, class... Ts, class... Cs>
+struct child_index<I, R, tagged_composite<R, Ts...>, Cs...> {
+  constexpr static inline bool found = true;
+  constexpr static inline std::size_t value = I;
+  using type = tagged_composite<R, Ts...>;
+};
+
+template <class T, class... Cs, std::size_t I, class P, class... Ps>
+struct node_index<tagged_composite<T, Cs...>, I, P, Ps...> {
+ private:
+  using child = child_index<I + 1, P, Cs...>;
+
+ public:
+  constexpr static inline std::size_t value = [] {
+    if constexpr (child::found) {
+      return node_index<typename child::type, child::value, Ps...>::value;
+    }
+    else {
+      return I;
+    }
+  }();
+};
+
+template <class H, class... P>
+constexpr static inline std::size_t node_index_v =
+    node_index<H, 0, P...>::value;
+
+template <class H, class L>
+struct has_leaf : std::false_type {};
+
+template <class T, class... Cs, class L>
+struct has_leaf<tagged_composite<T, Cs...>, L>
+    : std::disjunction<std::is_same<Cs, L>...> {};
+
+template <class Traits, class = void>
+struct has_multiply : std::false_type {};
+
+template <class Traits>
+struct has_multiply<
+    Traits,
+    std::void_t<decltype(Traits::multiply(
+        std::declval<const typename Traits::mat_type&>(),
+        std::declval<const typename Traits::mat_type&>()))>>
+    : std::true_type {};
+
+template <class H>
+struct flatten;
+
+template <class T, class... Cs>
+struct flatten<tagged_composite<T, Cs...>> {
+  template <class N>
+  constexpr static void parents(N* out, std::size_t self, N parent) noexcept {
+    out[self] = parent;  // NOLINT
+    std::size_t next = self + 1;
+    (
+        [&] {
+          if constexpr (is_composite_v<Cs>) {
+            flatten<Cs>::parents(out, next, static_cast<N>(self));
+            next += node_count_v<Cs>;
+          }
+        }(),
+        ...);
+  }
+
+  template <class L>
+  constexpr static void leaves(bool* out, std::size_t self) noexcept {
+    out[self] = has_leaf<tagged_composite<T, Cs...>, L>::value;  // NOLINT
+    std::size_t next = self + 1;
+    (
+        [&] {
+          if constexpr (is_composite_v<Cs>) {
+            flatten<Cs>::template leaves<L>(out, next);
+            next += node_count_v<Cs>;
+          }
+        }(),
+        ...);
+  }
+
+  // One past the position of the last leaf among the components.
+  constexpr static inline std::size_t leaf_end = [] {
+    std::size_t end = 0;
+    std::size_t position = 0;
+    ((++position, end = is_composite_v<Cs> ? end : position), ...);
+    return end;
+  }();
+
+  template <class V>
+  static void nodes(const tagged_composite<T, Cs...>& node,
+                    std::size_t self,
+                    V* out) noexcept {
+    out[self] = V::template make<tagged_composite<T, Cs...>>(node);  // NOLINT
+    std::size_t next = self + 1;
+    std::size_t position = 0;
+    std::apply(
+        [&](const auto&... cs) {
+          (
+              [&](const auto& c) {
+                using child = std::decay_t<decltype(c)>;
+                if constexpr (is_composite_v<child>) {
+                  flatten<child>::nodes(c, next, out);
+                  out[next].attach(node, position, position >= leaf_end);
+                  next += node_count_v<child>;
+                }
+                ++position;
+              }(cs),
+              ...);
+        },
+        node.components);
+  }
+};
+
+}  // namespace detail
+
+// Flattened view of a tagged_composite hierarchy.
+//
+// Nodes are numbered in pre-order, so every parent comes before its children
+// and the world matrices can be computed in a single linear pass over
+// contiguous arrays (parents, local and world matrices, dirty flags) instead
+// of a recursive traversal with a matrix stack.
+//
+// The local matrix of a node is the product, in declaration order, of the
+// transformations described by its leaves. 'Transform' is called on every
+// leaf of a node as transform(leaf, matrix), and must ignore the leaves that
+// aren't transformations. As with a traversal, a child only sees the
+// transformations declared before it in its parent. world() is the matrix
+// after all of the transformations of the node, which is what its other
+// leaves see when they are declared last.
+//
+// Local matrices are only recomputed for nodes that were modified through
+// extract() or invalidate(), and world matrices only for their subtrees.
+template <class Traits, class H, class Transform>
+class flat_hierarchy {
+ public:
+  using mat_type = typename Traits::mat_type;
+  using hierarchy_type = H;
+  constexpr static inline std::size_t size = detail::node_count_v<H>;
+  static_assert(is_composite_v<H>, "flat_hierarchy requires a composite");
+
+  using index_type =
+      std::conditional_t<(size < 0x7FFF), std::int16_t, std::int32_t>;
+  constexpr static inline index_type no_parent = -1;
+
+  // Index of the parent of each node, no_parent for the root.
+  constexpr static inline std::array<index_type, size> parents = [] {
+    std::array<index_type, size> result{};
+    detail::flatten<H>::parents(result.data(), 0, no_parent);
+    return result;
+  }();
+
+  // Indices of the nodes that directly hold a leaf of type L, e.g. the nodes
+  // that must be drawn.
+  template <class L>
+  constexpr static inline auto indices_of = [] {
+    constexpr std::array<bool, size> flags = [] {
+      std::array<bool, size> result{};
+      detail::flatten<H>::template leaves<L>(result.data(), 0);
+      return result;
+    }();
+    constexpr std::size_t count = [&flags] {
+      std::size_t c = 0;
+      for (bool f : flags) {
+        c += f ? 1 : 0;
+      }
+      return c;
+    }();
+
+    std::array<std::size_t, count> result{};
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      if (flags[i]) {  // NOLINT
+        result[j++] = i;  // NOLINT
+      }
+    }
+    return result;
+  }();
+
+  explicit flat_hierarchy(H& hierarchy,
+                          Transform transform,
+                          const mat_type& root = Traits::identity_matrix)
+      : _hierarchy{hierarchy}, _transform{std::move(transform)}, _root{root} {
+    detail::flatten<H>::nodes(_hierarchy, 0, _nodes.data());
+    _local_dirty.fill(true);
+    _dirty = true;
+  }
+
+  // Same as dpsg::extract, but marks the node designated by the path as
+  // modified.
+  template <class... P>
+  decltype(auto) extract(path_t<P...> p) noexcept {
+    invalidate(p);
+    return dpsg::extract(p, _hierarchy);
+  }
+
+  template <class... P>
+  void invalidate([[maybe_unused]] path_t<P...> p) noexcept {
+    invalidate(detail::node_index_v<H, P...>);
+  }
+
+  void invalidate(std::size_t node) noexcept {
+    _local_dirty[node] = true;
+    _dirty = true;
+  }
+
+  void root(const mat_type& m) noexcept {
+    _root = m;
+    invalidate(0);
+  }
+
+  [[nodiscard]] const mat_type& root() const noexcept { return _root; }
+
+  // Recomputes the world matrices of the modified subtrees.
+  void update() {
+    if (!_dirty) {
+      _world_dirty.fill(false);
+      return;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+      const index_type p = parents[i];  // NOLINT
+      const node_ref& n = _nodes[i];    // NOLINT
+      const bool parent_dirty = p != no_parent && _world_dirty[p];
+      if (_local_dirty[i]) {
+        _local[i] = n.local(n.node, _transform);
+      }
+      if (!n.full_prefix && _local_dirty[p]) {
+        _prefix[i] = n.prefix(n.parent, _transform, n.position);
+      }
+      _world_dirty[i] = _local_dirty[i] || parent_dirty;
+      if (_world_dirty[i]) {
+        // Matrix of the parent at the point where the node is declared.
+        if (p == no_parent) {
+          _entry[i] = _root;
+        }
+        else if (n.full_prefix) {
+          _entry[i] = _world[p];
+        }
+        else {
+          _entry[i] = multiply(_entry[p], _prefix[i]);
+        }
+        _world[i] = multiply(_entry[i], _local[i]);
+      }
+    }
+    _local_dirty.fill(false);
+    _dirty = false;
+  }
+
+  [[nodiscard]] const mat_type& world(std::size_t node) const noexcept {
+    return _world[node];
+  }
+
+  [[nodiscard]] const mat_type& local(std::size_t node) const noexcept {
+    return _local[node];
+  }
+
+  // Whether the world matrix of 'node' changed during the last update.
+  [[nodiscard]] bool updated(std::size_t node) const noexcept {
+    return _world_dirty[node];
+  }
+
+  [[nodiscard]] const std::array<mat_type, size>& world_matrices()
+      const noexcept {
+    return _world;
+  }
+
+  [[nodiscard]] H& hierarchy() noexcept { return _hierarchy; }
+  [[nodiscard]] const H& hierarchy() const noexcept { return _hierarchy; }
+
+ private:
+  // Type-erased access to a node of the hierarchy, and to the
+  // transformations its parent declares before it.
+  struct node_ref {
+    const void* node;
+    mat_type (*local)(const void*, const Transform&);
+    const void* parent{nullptr};
+    mat_type (*prefix)(const void*, const Transform&, std::size_t){nullptr};
+    std::size_t position{0};
+    // Whether every leaf of the parent is declared before the node, in which
+    // case the node starts from the world matrix of the parent.
+    bool full_prefix{true};
+
+    template <class N>
+    static node_ref make(const N& n) noexcept {
+      return node_ref{&n, &compute_local<N>};
+    }
+
+    template <class P>
+    void attach(const P& p, std::size_t pos, bool full) noexcept {
+      parent = &p;
+      prefix = &compute_prefix<P>;
+      position = pos;
+      full_prefix = full;
+    }
+  };
+
+  template <class N>
+  static mat_type compute_local(const void* n, const Transform& transform) {
+    return compute_prefix<N>(
+        n,
+        transform,
+        std::tuple_size_v<decltype(static_cast<const N*>(n)->components)>);
+  }
+
+  // Product of the transformations among the first 'count' components of n.
+  template <class N>
+  static mat_type compute_prefix(const void* n,
+                                 const Transform& transform,
+                                 std::size_t count) {
+    mat_type result = Traits::identity_matrix;
+    std::size_t position = 0;
+    std::apply(
+        [&](const auto&... cs) {
+          (
+              [&](const auto& c) {
+                if constexpr (!is_composite_v<std::decay_t<decltype(c)>>) {
+                  if (position < count) {
+                    transform(c, result);
+                  }
+                }
+                ++position;
+              }(cs),
+              ...);
+        },
+        static_cast<const N*>(n)->components);
+    return result;
+  }
+
+  static mat_type multiply(const mat_type& lhs, const mat_type& rhs) {
+    if constexpr (detail::has_multiply<Traits>::value) {
+      return Traits::multiply(lhs, rhs);
+    }
+    else {
+      return lhs * rhs;
+    }
+  }
+
+  H& _hierarchy;
+  Transform _transform;
+  mat_type _root;
+  std::array<node_ref, size> _nodes{};
+  std::array<mat_type, size> _local{};
+  std::array<mat_type, size> _world{};
+  // Only used for the nodes that don't have a full prefix.
+  std::array<mat_type, size> _prefix{};
+  std::array<mat_type, size> _entry{};
+  std::array<bool, size> _local_dirty{};
+  std::array<bool, size> _world_dirty{};
+  bool _dirty{false};
+};
+
+template <class Traits, class H, class Transform>
+flat_hierarchy<Traits, H, std::decay_t<Transform>> flatten(
+    H& hierarchy,
+    Transform&& transform,
+    const typename Traits::mat_type& root = Traits::identity_matrix) {
+  return flat_hierarchy<Traits, H, std::decay_t<Transform>>{
+      hierarchy, std::forward<Transform>(transform), root};
+}
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_FLAT_HIERARCHY_HEADER
\ No newline at end of file
@@ -2,9 +2,11 @@
 #define GUARD_DPSG_GLM_TRAITS_HEADER
 
 #include "common.hpp"
+#include "simd.hpp"
 
 #include "glm/geometric.hpp"
 #include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/type_ptr.hpp"
 #include "glm/mat4x4.hpp"
 #include "glm/vec3.hpp"
 
@@ -42,6 +44,17 @@ struct glm {
     return ::glm::translate(mat, vec);
   }
 
+  inline static mat_type scale(const mat_type &mat, const vec_type &vec) {
+    return ::glm::scale(mat, vec);
+  }
+
+  inline static mat_type multiply(const mat_type &lhs, const mat_type &rhs) {
+    mat_type result;
+    simd::mat4_multiply(::glm::value_ptr(lhs), ::glm::value_ptr(rhs),
+                        ::glm::value_ptr(result));
+    return result;
+  }
+
   constexpr static inline mat_type identity_matrix{1.0};
 };
 } // namespace dpsg::traits
@@ -0,0 +1,39 @@
+#ifndef GUARD_DPSG_GLSL_TYPE_HEADER
+#define GUARD_DPSG_GLSL_TYPE_HEADER
+
+#include "opengl.hpp"
+
+#include <cstddef>
+
+namespace dpsg {
+
+// GLSL type matching a C++ type: a scalar, vector (columns == 1) or column
+// major matrix. The C++ type must be tightly packed. Specializations for glm
+// are provided by opengl/glm.hpp.
+template <class T, class = void>
+struct glsl_type;
+
+template <class T>
+struct glsl_scalar_type {
+  using scalar_type = T;
+  constexpr static inline std::size_t rows = 1;
+  constexpr static inline std::size_t columns = 1;
+};
+
+template <>
+struct glsl_type<gl::float_t> : glsl_scalar_type<gl::float_t> {};
+template <>
+struct glsl_type<gl::int_t> : glsl_scalar_type<gl::int_t> {};
+template <>
+struct glsl_type<gl::uint_t> : glsl_scalar_type<gl::uint_t> {};
+
+template <std::size_t N>
+struct glsl_type<gl::mat_t<N, N, gl::column_major>> {
+  using scalar_type = gl::float_t;
+  constexpr static inline std::size_t rows = N;
+  constexpr static inline std::size_t columns = N;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_GLSL_TYPE_HEADER
\ No newline at end of file
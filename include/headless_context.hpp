@@ -0,0 +1,99 @@
+#ifndef GUARD_DPSG_HEADLESS_CONTEXT_HEADER
+#define GUARD_DPSG_HEADLESS_CONTEXT_HEADER
+
+#include "utility.hpp"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+#include <type_traits>
+
+namespace dpsg {
+
+// EGL counterpart of within_glfw_context. The display is initialized once for
+// the duration of the call and shared by every headless window created inside
+// of it. When the Mesa surfaceless platform is available it is preferred, so
+// that no X11/Wayland server is needed (llvmpipe on CI machines, render
+// farms...). Otherwise the default display is used.
+namespace detail {
+inline EGLDisplay& headless_display() noexcept {
+  static EGLDisplay display = EGL_NO_DISPLAY;
+  return display;
+}
+
+inline bool has_egl_extension(const char* extensions,
+                              const char* name) noexcept {
+  if (extensions == nullptr) {
+    return false;
+  }
+  const std::size_t len = std::strlen(name);
+  for (const char* it = std::strstr(extensions, name); it != nullptr;
+       it = std::strstr(it + len, name)) {
+    const bool starts = it == extensions || *(it - 1) == ' ';
+    const bool ends = it[len] == ' ' || it[len] == '\0';
+    if (starts && ends) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline EGLDisplay open_headless_display() noexcept {
+#if defined(EGL_EXT_platform_base) && defined(EGL_MESA_platform_surfaceless)
+  const char* client_extensions =
+      eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (has_egl_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+    auto get_platform_display =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(  // NOLINT
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (get_platform_display != nullptr) {
+      EGLDisplay d = get_platform_display(
+          EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      if (d != EGL_NO_DISPLAY) {
+        return d;
+      }
+    }
+  }
+#endif
+  return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+template <class F>
+ExecutionStatus within_headless_context_impl(F&& f) {
+  EGLDisplay display = open_headless_display();
+  if (display == EGL_NO_DISPLAY ||
+      eglInitialize(display, nullptr, nullptr) == EGL_FALSE) {
+    return ExecutionStatus::Failure;
+  }
+
+  auto on_exit = on_scope_exit_t{[display] {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglTerminate(display);
+    headless_display() = EGL_NO_DISPLAY;
+  }};
+
+  if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+    return ExecutionStatus::Failure;
+  }
+  headless_display() = display;
+
+  if constexpr (std::is_same_v<std::invoke_result_t<F>, ExecutionStatus>) {
+    return std::forward<F>(f)();
+  }
+  else {
+    std::forward<F>(f)();
+    return ExecutionStatus::Success;
+  }
+}
+}  // namespace detail
+
+template <class F>
+ExecutionStatus within_headless_context(F&& f) noexcept(
+    noexcept(std::forward<F>(f)())) {
+  return detail::within_headless_context_impl(std::forward<F>(f));
+}
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_HEADLESS_CONTEXT_HEADER
@@ -0,0 +1,331 @@
+#ifndef GUARD_DPSG_HEADLESS_WINDOW_HEADER
+#define GUARD_DPSG_HEADLESS_WINDOW_HEADER
+
+#include "glad/glad.h"
+
+#include "common.hpp"
+#include "headless_context.hpp"
+#include "meta/mixin.hpp"
+#include "opengl.hpp"
+#include "utility.hpp"
+#include "window.hpp"
+
+#include <EGL/egl.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace dpsg {
+
+// Everything needed to create a headless_impl. Produced by
+// make_headless_surface and owned by the window afterwards.
+struct headless_surface {
+  EGLDisplay display{EGL_NO_DISPLAY};
+  EGLContext context{EGL_NO_CONTEXT};
+  EGLSurface surface{EGL_NO_SURFACE};
+  width width{0};
+  height height{0};
+};
+
+namespace detail {
+// Creates a 3.3 core context on the display opened by within_headless_context.
+// A pbuffer is used as the default framebuffer when the driver supports it,
+// otherwise the context is made surfaceless and rendering must go through an
+// offscreen_framebuffer.
+inline headless_surface make_headless_surface(width w, height h) noexcept {
+  headless_surface result{headless_display()};
+  result.width = w;
+  result.height = h;
+  if (result.display == EGL_NO_DISPLAY) {
+    return result;
+  }
+
+  // clang-format off
+  const EGLint pbuffer_config_attribs[] = {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE, 8,
+      EGL_GREEN_SIZE, 8,
+      EGL_BLUE_SIZE, 8,
+      EGL_ALPHA_SIZE, 8,
+      EGL_DEPTH_SIZE, 24,
+      EGL_STENCIL_SIZE, 8,
+      EGL_NONE,
+  };
+  const EGLint surfaceless_config_attribs[] = {
+      EGL_SURFACE_TYPE, 0,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_NONE,
+  };
+  const EGLint context_attribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE,
+  };
+  // clang-format on
+
+  EGLConfig config{};
+  EGLint config_count{};
+  bool pbuffer = eglChooseConfig(result.display,
+                                 static_cast<const EGLint*>(
+                                     pbuffer_config_attribs),
+                                 &config,
+                                 1,
+                                 &config_count) == EGL_TRUE &&
+                 config_count > 0;
+  if (!pbuffer &&
+      (eglChooseConfig(result.display,
+                       static_cast<const EGLint*>(surfaceless_config_attribs),
+                       &config,
+                       1,
+                       &config_count) == EGL_FALSE ||
+       config_count == 0)) {
+    return result;
+  }
+
+  result.context =
+      eglCreateContext(result.display,
+                       config,
+                       EGL_NO_CONTEXT,
+                       static_cast<const EGLint*>(context_attribs));
+  if (result.context == EGL_NO_CONTEXT) {
+    return result;
+  }
+
+  if (pbuffer) {
+    const EGLint pbuffer_attribs[] = {
+        EGL_WIDTH, w.value, EGL_HEIGHT, h.value, EGL_NONE};
+    result.surface = eglCreatePbufferSurface(
+        result.display, config, static_cast<const EGLint*>(pbuffer_attribs));
+  }
+  return result;
+}
+}  // namespace detail
+
+// Drop-in replacement for window_impl at the bottom of a mixin stack. It
+// exposes the subset of the window interface that makes sense without a
+// display: context management, framebuffer dimensions and render_loop. The
+// loop runs unthrottled until should_close(true) is called, which is what
+// unattended benchmarks want.
+struct headless_impl {
+  template <class T>
+  class type : public T {
+   public:
+    explicit type(headless_surface s) noexcept : _surface(s) {}
+
+    type(type&& w) noexcept
+        : _surface(std::exchange(w._surface, headless_surface{})),
+          _should_close(w._should_close),
+          _frame_count(w._frame_count) {}
+    type(const type&) = delete;
+    type& operator=(type&& w) noexcept {
+      if (this != &w) {
+        _clean();
+        _surface = std::exchange(w._surface, headless_surface{});
+        _should_close = w._should_close;
+        _frame_count = w._frame_count;
+      }
+      return *this;
+    }
+
+    type& operator=(const type&) = delete;
+    ~type() { _clean(); }
+
+    [[nodiscard]] constexpr const headless_surface& data() const noexcept {
+      return _surface;
+    }
+
+    [[nodiscard]] static GLADloadproc proc_address_loader() noexcept {
+      return reinterpret_cast<GLADloadproc>(eglGetProcAddress);  // NOLINT
+    }
+
+    void make_context_current() const noexcept {
+      eglMakeCurrent(
+          _surface.display, _surface.surface, _surface.surface, _surface.context);
+    }
+
+    [[nodiscard]] bool should_close() const noexcept { return _should_close; }
+
+    void should_close(bool b) noexcept { _should_close = b; }
+
+    void swap_buffers() const noexcept {
+      if (_surface.surface != EGL_NO_SURFACE) {
+        eglSwapBuffers(_surface.display, _surface.surface);
+      }
+      else {
+        glFlush();
+      }
+    }
+
+    template <class F>
+    void render_loop(F f) noexcept(noexcept(f())) {
+      while (!should_close()) {
+        f();
+        swap_buffers();
+        ++_frame_count;
+      }
+    }
+
+    [[nodiscard]] std::size_t frame_count() const noexcept {
+      return _frame_count;
+    }
+
+    inline void framebuffer_size(width& w, height& h) const noexcept {
+      w = _surface.width;
+      h = _surface.height;
+    }
+
+    [[nodiscard]] framebuffer_dimension framebuffer_size() const noexcept {
+      framebuffer_dimension fd;
+      framebuffer_size(fd.width, fd.height);
+      return fd;
+    }
+
+    inline void window_size(width& w, height& h) const noexcept {
+      framebuffer_size(w, h);
+    }
+
+    [[nodiscard]] window_dimension window_size() const noexcept {
+      window_dimension wd;
+      window_size(wd.width, wd.height);
+      return wd;
+    }
+
+   private:
+    void _clean() noexcept {
+      if (_surface.display == EGL_NO_DISPLAY) {
+        return;
+      }
+      if (_surface.surface != EGL_NO_SURFACE) {
+        eglDestroySurface(_surface.display, _surface.surface);
+      }
+      if (_surface.context != EGL_NO_CONTEXT) {
+        eglDestroyContext(_surface.display, _surface.context);
+      }
+    }
+
+   protected:
+    headless_surface _surface;
+    bool _should_close{false};
+    std::size_t _frame_count{0};
+  };
+};
+
+// Renders into a color + depth/stencil renderbuffer pair instead of the
+// default framebuffer. Must come before the GL loader in the mixin list, since
+// the framebuffer can only be created once the function pointers are loaded.
+struct offscreen_framebuffer {
+  template <class B>
+  class type : public B {
+   public:
+    template <class... Args>
+    explicit type(Args&&... args) : B(std::forward<Args>(args)...) {
+      auto dims = this->framebuffer_size();
+      const gl::width w{static_cast<gl::uint_t>(dims.width.value)};
+      const gl::height h{static_cast<gl::uint_t>(dims.height.value)};
+
+      _fbo = gl::gen_framebuffer();
+      gl::bind_framebuffer(gl::framebuffer_target::framebuffer, _fbo);
+
+      _color = gl::gen_renderbuffer();
+      gl::bind_renderbuffer(_color);
+      gl::renderbuffer_storage(gl::sized_internal_format::rgba8, w, h);
+      gl::framebuffer_renderbuffer(gl::framebuffer_target::framebuffer,
+                                   gl::framebuffer_attachment::color_0,
+                                   _color);
+
+      _depth_stencil = gl::gen_renderbuffer();
+      gl::bind_renderbuffer(_depth_stencil);
+      gl::renderbuffer_storage(
+          gl::sized_internal_format::depth24_stencil8, w, h);
+      gl::framebuffer_renderbuffer(gl::framebuffer_target::framebuffer,
+                                   gl::framebuffer_attachment::depth_stencil,
+                                   _depth_stencil);
+
+      gl::viewport(w, h);
+    }
+
+    type(const type&) = delete;
+    type(type&&) = delete;
+    type& operator=(const type&) = delete;
+    type& operator=(type&&) = delete;
+
+    ~type() noexcept {
+      gl::delete_renderbuffer(_depth_stencil);
+      gl::delete_renderbuffer(_color);
+      gl::delete_framebuffer(_fbo);
+    }
+
+    [[nodiscard]] bool framebuffer_complete() const noexcept {
+      return gl::check_framebuffer_status(
+                 gl::framebuffer_target::framebuffer) ==
+             gl::framebuffer_status::complete;
+    }
+
+    [[nodiscard]] gl::framebuffer_id framebuffer() const noexcept {
+      return _fbo;
+    }
+
+    // Copies the RGBA8 content of the color attachment into 'out', which must
+    // hold at least width * height * 4 bytes.
+    void read_pixels(gl::ubyte_t* out) const noexcept {
+      auto dims = this->framebuffer_size();
+      gl::bind_framebuffer(gl::framebuffer_target::read, _fbo);
+      gl::read_pixels(gl::x{0},
+                      gl::y{0},
+                      gl::width{static_cast<gl::uint_t>(dims.width.value)},
+                      gl::height{static_cast<gl::uint_t>(dims.height.value)},
+                      gl::image_format::rgba,
+                      out);
+    }
+
+   private:
+    gl::framebuffer_id _fbo{0};
+    gl::renderbuffer_id _color{0};
+    gl::renderbuffer_id _depth_stencil{0};
+  };
+};
+
+template <class... Mixins>
+class headless_window
+    : public mixin<headless_window<Mixins...>, Mixins..., headless_impl> {
+  using base = mixin<headless_window, Mixins..., headless_impl>;
+
+ public:
+  explicit headless_window(headless_surface s) : base(s) {}
+};
+
+template <class W,
+          class F,
+          std::enable_if_t<
+              !std::is_same_v<std::invoke_result_t<F&&, W&>, ExecutionStatus>,
+              int> = 0>
+ExecutionStatus with_headless_window(width w, height h, F&& f) {
+  headless_surface s = detail::make_headless_surface(w, h);
+  if (s.context == EGL_NO_CONTEXT) {
+    return ExecutionStatus::Failure;
+  }
+  W win(s);
+  std::forward<F>(f)(win);
+  return ExecutionStatus::Success;
+}
+
+template <class W,
+          class F,
+          std::enable_if_t<
+              std::is_same_v<std::invoke_result_t<F&&, W&>, ExecutionStatus>,
+              int> = 0>
+ExecutionStatus with_headless_window(width w, height h, F&& f) {
+  headless_surface s = detail::make_headless_surface(w, h);
+  if (s.context == EGL_NO_CONTEXT) {
+    return ExecutionStatus::Failure;
+  }
+  W win(s);
+  return std::forward<F>(f)(win);
+}
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_HEADLESS_WINDOW_HEADER
@@ -13,6 +13,16 @@ template <class... Ts>
 struct packed {};
 template <class... Ts>
 struct sequenced {};
+// Per-instance attributes: L is a packed<...> layout whose attributes advance
+// once every Divisor instances instead of once per vertex.
+template <class L, std::size_t Divisor = 1>
+struct instanced {};
+template <class L>
+struct is_instanced : std::false_type {};
+template <class L, std::size_t Divisor>
+struct is_instanced<instanced<L, Divisor>> : std::true_type {};
+template <class L>
+constexpr static inline bool is_instanced_v = is_instanced<L>::value;
 template <class T, class L>
 struct layout {};
 template <class T, std::size_t N>
@@ -52,88 +62,128 @@ constexpr static inline auto sum_to_v = sum_to<I, Ss...>::value;
 template <class T, std::size_t... Args>
 struct layout<T, packed<group<Args>...>> {
   constexpr static inline gl::element_count count{(Args + ...)};
+  constexpr static inline std::size_t attribute_count = sizeof...(Args);
   using layout_type = packed<group<Args>...>;
   using value_type = std::remove_cv_t<std::remove_reference_t<T>>;
 
-  template <std::size_t N>
+  // First is the location of the first attribute, so that several layouts
+  // can share a vertex array.
+  template <std::size_t N, std::size_t First = 0>
   static void set_attrib_pointer() {
-    set_attrib_pointer_impl<N>(std::make_index_sequence<sizeof...(Args)>{});
+    set_attrib_pointer_impl<N, First>(
+        std::make_index_sequence<sizeof...(Args)>{});
   }
 
+  template <std::size_t First = 0>
   static void enable() {
-    enable_impl(std::make_index_sequence<sizeof...(Args)>{});
+    enable_impl<First>(std::make_index_sequence<sizeof...(Args)>{});
   }
 
+  template <std::size_t First = 0>
   static void disable() {
-    disable_impl(std::make_index_sequence<sizeof...(Args)>{})
+    disable_impl<First>(std::make_index_sequence<sizeof...(Args)>{});
   }
 
  private:
-  template <std::size_t N, std::size_t... Is>
+  template <std::size_t N, std::size_t First, std::size_t... Is>
   static void set_attrib_pointer_impl([
       [maybe_unused]] std::index_sequence<Is...> indices) {
     // NOLINTNEXTLINE
     (gl::vertex_attrib_pointer<value_type>(
-         gl::attrib_location{Is},
+         gl::attrib_location{First + Is},
          gl::element_count{detail::at_v<Is, Args...>},
          gl::stride{count.value},
          gl::offset{detail::sum_to_v<Is, Args...>}),
      ...);
   }
 
-  template <std::size_t... Is>
+  template <std::size_t First, std::size_t... Is>
   static void enable_impl([[maybe_unused]] std::index_sequence<Is...> indices) {
-    (gl::enable_vertex_attrib_array(Is), ...);
+    (gl::enable_vertex_attrib_array(First + Is), ...);
   }
 
-  template <std::size_t... Is>
+  template <std::size_t First, std::size_t... Is>
   static void disable_impl([
       [maybe_unused]] std::index_sequence<Is...> indices) {
-    (gl::disable_vertex_attrib_array(Is), ...);
+    (gl::disable_vertex_attrib_array(First + Is), ...);
   }
 };
 
 template <class T, std::size_t... Args>
 struct layout<T, sequenced<group<Args>...>> {
   constexpr static inline gl::element_count count{(Args + ...)};
+  constexpr static inline std::size_t attribute_count = sizeof...(Args);
   using layout_type = sequenced<group<Args>...>;
   using value_type = std::remove_cv_t<std::remove_reference_t<T>>;
 
-  template <std::size_t N>
+  // First is the location of the first attribute, so that several layouts
+  // can share a vertex array.
+  template <std::size_t N, std::size_t First = 0>
   static void set_attrib_pointer() {
-    set_attrib_pointer_impl<N>(std::make_index_sequence<sizeof...(Args)>{});
+    set_attrib_pointer_impl<N, First>(
+        std::make_index_sequence<sizeof...(Args)>{});
   }
 
+  template <std::size_t First = 0>
   static void enable() {
-    enable_impl(std::make_index_sequence<sizeof...(Args)>{});
+    enable_impl<First>(std::make_index_sequence<sizeof...(Args)>{});
   }
 
+  template <std::size_t First = 0>
   static void disable() {
-    disable_impl(std::make_index_sequence<sizeof...(Args)>{})
+    disable_impl<First>(std::make_index_sequence<sizeof...(Args)>{});
   }
 
  private:
-  template <std::size_t N, std::size_t... Is>
+  template <std::size_t N, std::size_t First, std::size_t... Is>
   static void set_attrib_pointer_impl([
       [maybe_unused]] std::index_sequence<Is...> indices) {
     // NOLINTNEXTLINE
     (gl::vertex_attrib_pointer<value_type>(
-         gl::attrib_location{Is},
+         gl::attrib_location{First + Is},
          gl::element_count{detail::at_v<Is, Args...>},
          gl::stride{0},
          gl::offset{detail::sum_to_v<Is, Args...> * (N / count.value)}),
      ...);
   }
 
-  template <std::size_t... Is>
+  template <std::size_t First, std::size_t... Is>
   static void enable_impl([[maybe_unused]] std::index_sequence<Is...> indices) {
-    (gl::enable_vertex_attrib_array(Is), ...);
+    (gl::enable_vertex_attrib_array(First + Is), ...);
   }
 
-  template <std::size_t... Is>
+  template <std::size_t First, std::size_t... Is>
   static void disable_impl([
       [maybe_unused]] std::index_sequence<Is...> indices) {
-    (gl::disable_vertex_attrib_array(Is), ...);
+    (gl::disable_vertex_attrib_array(First + Is), ...);
+  }
+};
+
+template <class T, std::size_t... Args, std::size_t Divisor>
+struct layout<T, instanced<packed<group<Args>...>, Divisor>>
+    : layout<T, packed<group<Args>...>> {
+  static_assert(Divisor > 0, "A divisor of 0 describes per-vertex attributes");
+
+ private:
+  using base = layout<T, packed<group<Args>...>>;
+
+ public:
+  using layout_type = instanced<packed<group<Args>...>, Divisor>;
+  constexpr static inline gl::uint_t divisor = Divisor;
+
+  template <std::size_t N, std::size_t First = 0>
+  static void set_attrib_pointer() {
+    base::template set_attrib_pointer<N, First>();
+    divisor_impl<First>(std::make_index_sequence<sizeof...(Args)>{});
+  }
+
+ private:
+  template <std::size_t First, std::size_t... Is>
+  static void divisor_impl([
+      [maybe_unused]] std::index_sequence<Is...> indices) {
+    (gl::vertex_attrib_divisor(
+         gl::attrib_location{static_cast<gl::int_t>(First + Is)}, divisor),
+     ...);
   }
 };
 }  // namespace dpsg
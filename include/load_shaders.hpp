@@ -4,12 +4,15 @@
 #include "c_str.hpp"
 #include "c_str_wrapper.hpp"
 #include "common.hpp"
+#include "embedded.hpp"
+#include "loading_error.hpp"
 #include "program.hpp"
 #include "result.hpp"
+#include "shader_preprocessor.hpp"
 #include "shaders.hpp"
 
-#include <fstream>
-#include <sstream>
+#include <filesystem>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <variant>
@@ -30,56 +33,110 @@ result<program, gl_error> create_program(
 DPSG_LAZY_STR_WRAPPER_IMPL(vs_filename)  // NOLINT
 DPSG_LAZY_STR_WRAPPER_IMPL(fs_filename)  // NOLINT
 
-struct loading_error : std::exception {
-  loading_error(const char* filename, const char* error_message) noexcept
-      : loading_error(filename,
-                      std::strlen(filename),
-                      error_message,
-                      std::strlen(error_message)) {}
-
-  loading_error(const char* filename,
-                std::size_t fn_len,
-                const char* error_message,
-                std::size_t em_len) noexcept
-      : _what(reserve{fn_len + em_len + 3}) {
-    if (_what) {
-      using std::begin;
-      using std::end;
-      auto it = std::copy(filename, filename + fn_len, begin(_what));
-      *it++ = ':';
-      *it++ = '\n';
-      it = std::copy(error_message, error_message + em_len, it);
-      *it = '\0';
-    }
+// Shader compiled into the executable. Its #include directives are resolved
+// against the other files of 'includes', relative to the shader first.
+//
+//    #include "embedded/resources.hpp"
+//    namespace res = dpsg::embedded::resources;
+//    auto prog = load(vs_embedded{res::shaders_basic_projection_vs,
+//                                 res::directory},
+//                     fs_embedded{res::shaders_uniform_fs, res::directory});
+template <gl::shader_type Type>
+class embedded_shader {
+ public:
+  constexpr explicit embedded_shader(const embedded_file& file) noexcept
+      : _file{&file} {}
+  constexpr embedded_shader(const embedded_file& file,
+                            const embedded_directory& includes) noexcept
+      : _file{&file}, _includes{&includes} {}
+
+  [[nodiscard]] constexpr const embedded_file& file() const noexcept {
+    return *_file;
+  }
+  [[nodiscard]] constexpr const embedded_directory* includes() const noexcept {
+    return _includes;
   }
-
-  [[nodiscard]] const char* what() const noexcept { return _what.c_str(); }
 
  private:
-  c_str_wrapper _what;
+  const embedded_file* _file;
+  const embedded_directory* _includes{nullptr};
 };
 
-namespace detail {
-template <class... Args>
-inline result<std::string, const char*> load_from_stream(
-    std::basic_istream<Args...>& stream) {
-  std::stringstream sstream;
-  sstream << stream.rdbuf();
-
-  if (stream.bad()) {
-    return failure{std::strerror(errno)};
-  }
+using vs_embedded = embedded_shader<gl::shader_type::vertex>;
+using fs_embedded = embedded_shader<gl::shader_type::fragment>;
 
-  return success{sstream.str()};
+namespace detail {
+// Reads 'name' and expands its #include directives.
+inline result<std::string, loading_error> load_from_disk(include_graph& graph,
+                                                         const char* name) {
+  return graph.preprocess(name).map(
+      [](preprocessed_shader&& shader) { return std::move(shader.source); });
 }
 
 inline result<std::string, loading_error> load_from_disk(const char* name) {
-  std::ifstream file(name);
-  if (!file.is_open()) {
-    return failure{name, std::strerror(errno)};
+  include_graph graph;
+  return load_from_disk(graph, name);
+}
+
+template <class T, class U>
+result<program, loading_error> create_loaded_program(const vs_source<T>& vs,
+                                                     const fs_source<U>& fs,
+                                                     const char* vs_name,
+                                                     const char* fs_name) {
+  constexpr auto to_loading_error = [](const char* name) {
+    return [name](gl_error&& error) -> loading_error {
+      return loading_error(name, error.error_message().c_str());
+    };
+  };
+  return vertex_shader::create(vs)
+      .map_error(to_loading_error(vs_name))
+      .then([&](auto&& vshader) {
+        return fragment_shader::create(fs)
+            .map_error(to_loading_error(fs_name))
+            .then([&](auto&& fshader) {
+              return program::create(std::move(vshader), std::move(fshader))
+                  .map_error(to_loading_error("linking"));
+            });
+      });
+}
+
+// Expands the #include directives of an embedded file, looking up included
+// files in 'includes'.
+inline result<std::string, loading_error> load_embedded(
+    const embedded_file& file,
+    const embedded_directory* includes) {
+  const auto find = [&](const std::string& name) -> const embedded_file* {
+    if (name == file.name) {
+      return &file;
+    }
+    return includes == nullptr ? nullptr : includes->find(name);
+  };
+  const auto resolve = [&](const std::string& from, std::string_view name)
+      -> std::optional<std::string> {
+    auto candidate = (std::filesystem::path{from}.parent_path() /
+                      std::filesystem::path{name})
+                         .lexically_normal()
+                         .generic_string();
+    if (find(candidate) == nullptr) {
+      return std::nullopt;
+    }
+    return candidate;
+  };
+  const auto open =
+      [&](const std::string& name) -> result<source_text, loading_error> {
+    const auto* found = find(name);
+    if (found == nullptr) {
+      return failure{name.c_str(), "not embedded"};
+    }
+    return success{source_text{found->view(), fnv1a(found->view())}};
+  };
+
+  include_expansion state;
+  const std::string key{file.name};
+  if (auto error = expand_includes(key, state, resolve, open); error) {
+    return failure{std::move(*error)};
   }
-  return load_from_stream(file).map_error(
-      [&name](const char* err) { return loading_error(name, err); });
+  return success{std::move(state.out)};
 }
 }  // namespace detail
 
@@ -97,26 +154,66 @@ result<vs_source<std::string>, loading_error> load(
       .template cast<vs_source<std::string>>();
 }
 
+// Same as above, but files already read through 'graph' aren't read again,
+// and the files included by the shader are recorded in the graph.
+template <class T>
+result<fs_source<std::string>, loading_error> load(
+    include_graph& graph,
+    const fs_filename<T>& fname) {
+  return detail::load_from_disk(graph, c_str(fname))
+      .template cast<fs_source<std::string>>();
+}
+
+template <class T>
+result<vs_source<std::string>, loading_error> load(
+    include_graph& graph,
+    const vs_filename<T>& fname) {
+  return detail::load_from_disk(graph, c_str(fname))
+      .template cast<vs_source<std::string>>();
+}
+
+inline result<vs_source<std::string>, loading_error> load(
+    const vs_embedded& shader) {
+  return detail::load_embedded(shader.file(), shader.includes())
+      .template cast<vs_source<std::string>>();
+}
+
+inline result<fs_source<std::string>, loading_error> load(
+    const fs_embedded& shader) {
+  return detail::load_embedded(shader.file(), shader.includes())
+      .template cast<fs_source<std::string>>();
+}
+
+template <class T, class U>
+result<program, loading_error> load(include_graph& graph,
+                                    const vs_filename<T>& vs,
+                                    const fs_filename<U>& fs) {
+  return load(graph, vs).then([&](auto&& vshader_source) {
+    return load(graph, fs).then([&](auto&& fshader_source) {
+      return detail::create_loaded_program(vshader_source,
+                                           fshader_source,
+                                           c_str(vs),
+                                           c_str(fs));
+    });
+  });
+}
+
 template <class T, class U>
 result<program, loading_error> load(const vs_filename<T>& vs,
                                     const fs_filename<U>& fs) {
-  constexpr auto to_loading_error = [](auto&& filename) {
-    return [&filename](gl_error&& error) -> loading_error {
-      return loading_error(c_str(filename), error.error_message().c_str());
-    };
-  };
+  include_graph graph;
+  return load(graph, vs, fs);
+}
+
+// Doesn't touch the filesystem.
+inline result<program, loading_error> load(const vs_embedded& vs,
+                                           const fs_embedded& fs) {
   return load(vs).then([&](auto&& vshader_source) {
     return load(fs).then([&](auto&& fshader_source) {
-      return vertex_shader::create(std::move(vshader_source))
-          .map_error(to_loading_error(vs))
-          .then([&](auto&& vshader) {
-            return fragment_shader::create(std::move(fshader_source))
-                .map_error(to_loading_error(fs))
-                .then([&](auto&& fshader) {
-                  return program::create(std::move(vshader), std::move(fshader))
-                      .map_error(to_loading_error("linking"));
-                });
-          });
+      return detail::create_loaded_program(vshader_source,
+                                           fshader_source,
+                                           vs.file().name.data(),
+                                           fs.file().name.data());
     });
   });
 }
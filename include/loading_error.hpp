@@ -0,0 +1,44 @@
+#ifndef GUARD_DPSG_LOADING_ERROR_HEADER
+#define GUARD_DPSG_LOADING_ERROR_HEADER
+
+#include "c_str_wrapper.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iterator>
+
+namespace dpsg {
+
+struct loading_error : std::exception {
+  loading_error(const char* filename, const char* error_message) noexcept
+      : loading_error(filename,
+                      std::strlen(filename),
+                      error_message,
+                      std::strlen(error_message)) {}
+
+  loading_error(const char* filename,
+                std::size_t fn_len,
+                const char* error_message,
+                std::size_t em_len) noexcept
+      : _what(reserve{fn_len + em_len + 3}) {
+    if (_what) {
+      using std::begin;
+      using std::end;
+      auto it = std::copy(filename, filename + fn_len, begin(_what));
+      *it++ = ':';
+      *it++ = '\n';
+      it = std::copy(error_message, error_message + em_len, it);
+      *it = '\0';
+    }
+  }
+
+  [[nodiscard]] const char* what() const noexcept { return _what.c_str(); }
+
+ private:
+  c_str_wrapper _what;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_LOADING_ERROR_HEADER
\ No newline at end of file
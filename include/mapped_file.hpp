@@ -0,0 +1,152 @@
+#ifndef GUARD_DPSG_MAPPED_FILE_HEADER
+#define GUARD_DPSG_MAPPED_FILE_HEADER
+
+#include "loading_error.hpp"
+#include "result.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dpsg {
+
+// Read only view of a whole file, mapped in memory. Pages are loaded by the
+// system on first access, and nothing is copied until the content is
+// actually used, e.g. by a decoder reading straight from data().
+//
+// The file handle itself is closed as soon as the mapping exists.
+//
+//    auto file = mapped_file::open("assets/wall.jpg");
+//    if (file.has_value()) {
+//      decode(file.value().data(), file.value().size());
+//    }
+class mapped_file {
+ public:
+  [[nodiscard]] static result<mapped_file, loading_error> open(
+      const char* filename) noexcept {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(filename,
+                              GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE |
+                                  FILE_SHARE_DELETE,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {  // NOLINT
+      return failure{filename, "cannot open file"};
+    }
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(file, &size) == 0) {
+      CloseHandle(file);
+      return failure{filename, "cannot read file size"};
+    }
+    if (size.QuadPart == 0) {
+      CloseHandle(file);
+      return success{mapped_file{}};
+    }
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+      return failure{filename, "cannot map file"};
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+      return failure{filename, "cannot map file"};
+    }
+    return success{mapped_file{static_cast<const unsigned char*>(view),
+                               static_cast<std::size_t>(size.QuadPart)}};
+#else
+    const int fd = ::open(filename, O_RDONLY | O_CLOEXEC);  // NOLINT
+    if (fd < 0) {
+      return failure{filename, std::strerror(errno)};
+    }
+    struct stat status {};
+    if (fstat(fd, &status) != 0) {
+      const int error = errno;
+      close(fd);
+      return failure{filename, std::strerror(error)};
+    }
+    const auto size = static_cast<std::size_t>(status.st_size);
+    if (size == 0) {
+      close(fd);
+      return success{mapped_file{}};
+    }
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (view == MAP_FAILED) {  // NOLINT
+      return failure{filename, std::strerror(error)};
+    }
+    // Assets are decoded front to back.
+    madvise(view, size, MADV_SEQUENTIAL);
+    return success{
+        mapped_file{static_cast<const unsigned char*>(view), size}};
+#endif
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file(mapped_file&& f) noexcept
+      : _data{std::exchange(f._data, nullptr)},
+        _size{std::exchange(f._size, 0)} {}
+  mapped_file& operator=(const mapped_file&) = delete;
+  mapped_file& operator=(mapped_file&& f) noexcept {
+    using std::swap;
+    swap(_data, f._data);
+    swap(_size, f._size);
+    return *this;
+  }
+  ~mapped_file() noexcept {
+    if (_data == nullptr) {
+      return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(_data);
+#else
+    munmap(const_cast<unsigned char*>(_data), _size);  // NOLINT
+#endif
+  }
+
+  // Null for an empty file.
+  [[nodiscard]] const unsigned char* data() const noexcept { return _data; }
+  [[nodiscard]] std::size_t size() const noexcept { return _size; }
+  [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+
+  [[nodiscard]] std::string_view view() const noexcept {
+    if (_data == nullptr) {
+      return {};
+    }
+    return {reinterpret_cast<const char*>(_data), _size};  // NOLINT
+  }
+
+ private:
+  mapped_file() noexcept = default;
+  mapped_file(const unsigned char* data, std::size_t size) noexcept
+      : _data{data}, _size{size} {}
+
+  const unsigned char* _data{nullptr};
+  std::size_t _size{0};
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_MAPPED_FILE_HEADER
\ No newline at end of file
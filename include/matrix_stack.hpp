@@ -1,7 +1,13 @@
 #ifndef GUARD_DPSG_MATRIX_STACK
 #define GUARD_DPSG_MATRIX_STACK
 
+#include "common.hpp"
+#include "simd.hpp"
+
+#include <cassert>
+#include <cstddef>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace dpsg {
@@ -48,6 +54,87 @@ class matrix_stack {
   stack_type _stack{1, traits::identity_matrix};
 };
 
+// Fixed capacity counterpart of matrix_stack, for when the maximum depth is
+// known at compile time (see composite_depth_v). The matrices are stored
+// inline, so pushing never allocates. The fused push_* operations write the
+// transformed matrix directly into the new slot instead of copying the top
+// and transforming it in place.
+//
+//    static_matrix_stack<traits::glm, composite_depth_v<decltype(model)>> s;
+template <class Traits, std::size_t Depth>
+class static_matrix_stack {
+  using traits = Traits;
+
+ public:
+  using mat_type = typename traits::mat_type;
+  using vec_type = typename traits::vec_type;
+  using radians = basic_radians<typename traits::value_type>;
+  constexpr static inline std::size_t capacity = Depth;
+
+  static_matrix_stack() noexcept { _stack[0] = traits::identity_matrix; }
+
+  template <class M = mat_type,
+            std::enable_if_t<std::is_convertible_v<M, mat_type>, int> = 0>
+  explicit static_matrix_stack(M&& mat) noexcept {
+    _stack[0] = std::forward<M>(mat);
+  }
+
+  [[nodiscard]] const mat_type& top() const noexcept { return _stack[_size]; }
+
+  [[nodiscard]] mat_type& top() noexcept { return _stack[_size]; }
+
+  [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+  mat_type& push() noexcept {
+    assert(_size < Depth);
+    _stack[_size + 1] = _stack[_size];
+    return top_after_push();
+  }
+
+  // Pushes top() * m.
+  mat_type& push_multiply(const mat_type& m) noexcept {
+    assert(_size < Depth);
+    _stack[_size + 1] = traits::multiply(_stack[_size], m);
+    return top_after_push();
+  }
+
+  mat_type& push_translate(const vec_type& v) noexcept {
+    assert(_size < Depth);
+    _stack[_size + 1] = traits::translate(_stack[_size], v);
+    return top_after_push();
+  }
+
+  mat_type& push_rotate(radians angle, const vec_type& axis) noexcept {
+    assert(_size < Depth);
+    _stack[_size + 1] = traits::rotate(_stack[_size], angle, axis);
+    return top_after_push();
+  }
+
+  mat_type& push_scale(const vec_type& v) noexcept {
+    assert(_size < Depth);
+    _stack[_size + 1] = traits::scale(_stack[_size], v);
+    return top_after_push();
+  }
+
+  void pop() noexcept {
+    assert(_size > 0);
+    --_size;
+  }
+
+  template <class F>
+  void push(F&& f) {
+    auto& top = push();
+    std::forward<F>(f)(top);
+    pop();
+  }
+
+ private:
+  mat_type& top_after_push() noexcept { return _stack[++_size]; }
+
+  alignas(simd::alignment) mat_type _stack[Depth + 1];  // NOLINT
+  std::size_t _size{0};
+};
+
 }  // namespace dpsg
 
 #endif
\ No newline at end of file
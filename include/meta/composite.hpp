@@ -1,6 +1,8 @@
 #ifndef GUARD_DPSG_META_COMPOSITE_HEADER
 #define GUARD_DPSG_META_COMPOSITE_HEADER
 
+#include <algorithm>
+#include <cstddef>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -36,6 +38,20 @@ struct is_composite<tagged_composite<T, Cs...>> : std::true_type {};
 template <class H>
 constexpr static inline bool is_composite_v = is_composite<H>::value;
 
+// Number of nested composites on the longest path from H to a leaf, i.e. the
+// number of matrices a traversal of H pushes on a matrix stack.
+template <class H>
+struct composite_depth : std::integral_constant<std::size_t, 0> {};
+template <class T, class... Cs>
+struct composite_depth<tagged_composite<T, Cs...>>
+    : std::integral_constant<std::size_t,
+                             1 + std::max({std::size_t{0},
+                                           composite_depth<Cs>::value...})> {};
+
+template <class H>
+constexpr static inline std::size_t composite_depth_v =
+    composite_depth<H>::value;
+
 using leaf = composite<>;
 template <class L>
 constexpr static inline bool is_leaf_v = std::is_base_of_v<leaf, L>;
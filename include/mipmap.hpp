@@ -0,0 +1,627 @@
+#ifndef GUARD_DPSG_MIPMAP_HEADER
+#define GUARD_DPSG_MIPMAP_HEADER
+
+#include "embedded.hpp"
+#include "loading_error.hpp"
+#include "mapped_file.hpp"
+#include "opengl.hpp"
+#include "result.hpp"
+#include "simd.hpp"
+#include "stbi_wrapper.hpp"
+#include "texture.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+enum class mip_filter {
+  // Average of 2x2 pixels, as most drivers do.
+  box,
+  // Kaiser windowed sinc over 8x8 pixels: sharper levels, with less
+  // aliasing, for about 3 times the work.
+  kaiser,
+};
+
+struct mip_options {
+  mip_filter filter{mip_filter::kaiser};
+  // Whether color channels are sRGB encoded, as photographs and painted
+  // textures usually are. They are then filtered in linear space, so that
+  // smaller levels don't get darker. Alpha is always linear. Masks, normal
+  // maps and other data must turn this off.
+  bool srgb{true};
+};
+
+// Offset and size of a level in mip_chain::pixels.
+struct mip_level {
+  gl::width width;
+  gl::height height;
+  std::size_t offset;
+};
+
+// Mipmap chain of an image with 8 bits per component, down to 1x1, built on
+// the CPU by build_mip_chain(). Rows are padded to 4 bytes, see image_level.
+struct mip_chain {
+  unsigned int channels;
+  std::vector<mip_level> levels;
+  std::vector<unsigned char> pixels;
+
+  [[nodiscard]] std::vector<image_level> image_levels() const {
+    std::vector<image_level> images;
+    images.reserve(levels.size());
+    for (const auto& l : levels) {
+      images.push_back(
+          image_level{l.width, l.height, pixels.data() + l.offset});  // NOLINT
+    }
+    return images;
+  }
+
+  [[nodiscard]] constexpr static std::size_t row_size(
+      unsigned int width,
+      unsigned int channels) noexcept {
+    return (static_cast<std::size_t>(width) * channels + 3) / 4 * 4;
+  }
+};
+
+namespace detail {
+inline const std::array<float, 256>& srgb_to_linear_table() noexcept {
+  static const auto table = [] {
+    std::array<float, 256> t{};  // NOLINT
+    for (std::size_t i = 0; i < t.size(); ++i) {
+      const double s = static_cast<double>(i) / 255.;             // NOLINT
+      t[i] = static_cast<float>(s <= 0.04045 ? s / 12.92          // NOLINT
+                                             : std::pow((s + 0.055) / 1.055,
+                                                        2.4));  // NOLINT
+    }
+    return t;
+  }();
+  return table;
+}
+
+// Indexed by the linear value times 65535, which is fine enough to reach
+// every sRGB code, down to the darkest.
+inline const std::vector<unsigned char>& linear_to_srgb_table() {
+  static const auto table = [] {
+    std::vector<unsigned char> t(65536);  // NOLINT
+    for (std::size_t i = 0; i < t.size(); ++i) {
+      const double l = static_cast<double>(i) / 65535.;  // NOLINT
+      const double s = l <= 0.0031308                    // NOLINT
+                           ? l * 12.92                   // NOLINT
+                           : 1.055 * std::pow(l, 1 / 2.4) - 0.055;  // NOLINT
+      t[i] = static_cast<unsigned char>(s * 255. + .5);  // NOLINT
+    }
+    return t;
+  }();
+  return table;
+}
+
+constexpr inline bool is_alpha(unsigned int channel,
+                               unsigned int channels) noexcept {
+  return channels == 4 && channel == 3;
+}
+
+// Separable filter: output pixel x is the weighted sum of the 'taps' source
+// pixels starting at 2 * x + first, clamped to the edges.
+struct mip_kernel {
+  int first;
+  std::size_t taps;
+  std::array<float, 8> weights;  // NOLINT
+};
+
+inline mip_kernel make_mip_kernel(mip_filter filter) noexcept {
+  if (filter == mip_filter::box) {
+    return mip_kernel{0, 2, {.5F, .5F}};  // NOLINT
+  }
+  // Source pixel t is centered (t - 3.5) / 2 output pixels away from the
+  // output pixel, and the window covers 2 output pixels on each side.
+  const auto bessel_i0 = [](double x) {
+    double sum = 1;
+    double term = 1;
+    for (int k = 1; k < 20; ++k) {  // NOLINT
+      const double half = x / (2 * k);
+      term *= half * half;
+      sum += term;
+    }
+    return sum;
+  };
+  constexpr double pi = 3.14159265358979323846;
+  constexpr double alpha = 4;
+  constexpr double radius = 2;
+  mip_kernel kernel{-3, 8, {}};  // NOLINT
+  double weights[8];             // NOLINT
+  double total = 0;
+  for (std::size_t t = 0; t < kernel.taps; ++t) {
+    const double d = (static_cast<double>(t) - 3.5) / 2;  // NOLINT
+    const double r = d / radius;
+    weights[t] = std::sin(pi * d) / (pi * d) *  // NOLINT
+                 bessel_i0(alpha * std::sqrt(1 - r * r)) / bessel_i0(alpha);
+    total += weights[t];  // NOLINT
+  }
+  for (std::size_t t = 0; t < kernel.taps; ++t) {
+    kernel.weights[t] = static_cast<float>(weights[t] / total);  // NOLINT
+  }
+  return kernel;
+}
+
+constexpr inline std::size_t clamp_index(int index,
+                                         unsigned int size) noexcept {
+  return static_cast<std::size_t>(
+      index < 0 ? 0 : std::min(index, static_cast<int>(size) - 1));
+}
+
+// out[i] += weight * in[i], for i in [0, count).
+inline void accumulate(float* out,
+                       const float* in,
+                       float weight,
+                       std::size_t count) noexcept {
+  std::size_t i = 0;
+#if defined(__AVX__)
+  const __m256 w = _mm256_set1_ps(weight);
+  for (; i + 8 <= count; i += 8) {                // NOLINT
+    const __m256 v = _mm256_loadu_ps(in + i);     // NOLINT
+    const __m256 acc = _mm256_loadu_ps(out + i);  // NOLINT
+#if defined(__FMA__)
+    _mm256_storeu_ps(out + i, _mm256_fmadd_ps(w, v, acc));  // NOLINT
+#else
+    _mm256_storeu_ps(out + i,                                   // NOLINT
+                     _mm256_add_ps(acc, _mm256_mul_ps(w, v)));
+#endif
+  }
+#elif defined(DPSG_SIMD_SSE)
+  const __m128 w = _mm_set1_ps(weight);
+  for (; i + 4 <= count; i += 4) {             // NOLINT
+    const __m128 v = _mm_loadu_ps(in + i);     // NOLINT
+    const __m128 acc = _mm_loadu_ps(out + i);  // NOLINT
+    _mm_storeu_ps(out + i, _mm_add_ps(acc, _mm_mul_ps(w, v)));  // NOLINT
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i + 4 <= count; i += 4) {               // NOLINT
+    const float32x4_t v = vld1q_f32(in + i);     // NOLINT
+    const float32x4_t acc = vld1q_f32(out + i);  // NOLINT
+    vst1q_f32(out + i, vmlaq_n_f32(acc, v, weight));  // NOLINT
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] += weight * in[i];  // NOLINT
+  }
+}
+
+// Horizontal pass over a row already filtered vertically.
+inline void filter_row(const float* in,
+                       unsigned int in_width,
+                       float* out,
+                       unsigned int out_width,
+                       unsigned int channels,
+                       const mip_kernel& kernel) noexcept {
+  for (unsigned int x = 0; x < out_width; ++x) {
+    const int first = 2 * static_cast<int>(x) + kernel.first;
+    float* pixel = out + static_cast<std::size_t>(x) * channels;  // NOLINT
+    // With 4 channels, a pixel fills a register.
+#if defined(DPSG_SIMD_SSE) || defined(__AVX__)
+    if (channels == 4) {
+      __m128 acc = _mm_setzero_ps();
+      for (std::size_t t = 0; t < kernel.taps; ++t) {
+        const auto s = clamp_index(first + static_cast<int>(t), in_width);
+        acc = _mm_add_ps(acc,
+                         _mm_mul_ps(_mm_set1_ps(kernel.weights[t]),  // NOLINT
+                                    _mm_loadu_ps(in + s * 4)));      // NOLINT
+      }
+      _mm_storeu_ps(pixel, acc);
+      continue;
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    if (channels == 4) {
+      float32x4_t acc = vdupq_n_f32(0);
+      for (std::size_t t = 0; t < kernel.taps; ++t) {
+        const auto s = clamp_index(first + static_cast<int>(t), in_width);
+        acc = vmlaq_n_f32(
+            acc, vld1q_f32(in + s * 4), kernel.weights[t]);  // NOLINT
+      }
+      vst1q_f32(pixel, acc);
+      continue;
+    }
+#endif
+    for (unsigned int c = 0; c < channels; ++c) {
+      float acc = 0;
+      for (std::size_t t = 0; t < kernel.taps; ++t) {
+        const auto s = clamp_index(first + static_cast<int>(t), in_width);
+        acc += kernel.weights[t] * in[s * channels + c];  // NOLINT
+      }
+      pixel[c] = acc;  // NOLINT
+    }
+  }
+}
+
+// Next level of a linear image, of half the size in both directions. 'rows'
+// returns the source row at a given index.
+template <class Rows>
+void downsample(Rows&& rows,
+                unsigned int width,
+                unsigned int height,
+                unsigned int channels,
+                const mip_kernel& kernel,
+                float* out,
+                std::vector<float>& row) {
+  const unsigned int out_width = std::max(width / 2, 1U);
+  const unsigned int out_height = std::max(height / 2, 1U);
+  const std::size_t stride = static_cast<std::size_t>(width) * channels;
+  row.resize(stride);
+  for (unsigned int y = 0; y < out_height; ++y) {
+    std::fill(row.begin(), row.end(), 0.F);
+    const int first = 2 * static_cast<int>(y) + kernel.first;
+    for (std::size_t t = 0; t < kernel.taps; ++t) {
+      const auto s = clamp_index(first + static_cast<int>(t), height);
+      accumulate(row.data(), rows(s), kernel.weights[t], stride);  // NOLINT
+    }
+    const std::size_t offset =
+        static_cast<std::size_t>(y) * out_width * channels;
+    filter_row(row.data(),
+               width,
+               out + offset,  // NOLINT
+               out_width,
+               channels,
+               kernel);
+  }
+}
+
+// Rows of an 8 bit image, converted to linear space as the filter reaches
+// them. Each row is converted once: the kernel moves down by 2 rows for each
+// output row, so a ring of as many rows as it has taps is enough.
+class linear_rows {
+ public:
+  linear_rows(const unsigned char* pixels,
+              unsigned int width,
+              unsigned int channels,
+              bool srgb,
+              std::size_t slots)
+      : _pixels{pixels},
+        _stride{static_cast<std::size_t>(width) * channels},
+        _channels{channels},
+        _rows(_stride * slots),
+        _tags(slots, no_row) {
+    const auto& table = srgb_to_linear_table();
+    for (unsigned int c = 0; c < 4; ++c) {
+      for (std::size_t v = 0; v < _tables[c].size(); ++v) {
+        _tables[c][v] = srgb && !is_alpha(c, channels)  // NOLINT
+                            ? table[v]                  // NOLINT
+                            : static_cast<float>(v) / 255.F;  // NOLINT
+      }
+    }
+  }
+
+  const float* operator()(std::size_t y) noexcept {
+    const std::size_t slot = y % _tags.size();
+    float* row = _rows.data() + slot * _stride;  // NOLINT
+    if (_tags[slot] != y) {
+      const unsigned char* source = _pixels + y * _stride;  // NOLINT
+      for (std::size_t i = 0; i < _stride; i += _channels) {
+        for (unsigned int c = 0; c < _channels; ++c) {
+          row[i + c] = _tables[c][source[i + c]];  // NOLINT
+        }
+      }
+      _tags[slot] = y;
+    }
+    return row;
+  }
+
+ private:
+  constexpr static std::size_t no_row = ~std::size_t{0};
+
+  const unsigned char* _pixels;
+  std::size_t _stride;
+  unsigned int _channels;
+  std::array<std::array<float, 256>, 4> _tables{};  // NOLINT
+  std::vector<float> _rows;
+  std::vector<std::size_t> _tags;
+};
+
+// Converts a linear image back to 8 bits per component, with padded rows.
+inline void quantize(const float* in,
+                     unsigned int width,
+                     unsigned int height,
+                     unsigned int channels,
+                     bool srgb,
+                     unsigned char* out) {
+  const auto& table = linear_to_srgb_table();
+  const std::size_t stride = mip_chain::row_size(width, channels);
+  bool encode[4];  // NOLINT
+  for (unsigned int c = 0; c < 4; ++c) {
+    encode[c] = srgb && !is_alpha(c, channels);  // NOLINT
+  }
+  for (unsigned int y = 0; y < height; ++y) {
+    const float* source =
+        in + static_cast<std::size_t>(y) * width * channels;  // NOLINT
+    unsigned char* destination = out + y * stride;             // NOLINT
+    for (std::size_t i = 0; i < std::size_t{width} * channels; i += channels) {
+      for (unsigned int c = 0; c < channels; ++c) {
+        // Kaiser filtering overshoots around sharp edges.
+        const float v = std::min(std::max(source[i + c], 0.F), 1.F);  // NOLINT
+        destination[i + c] =                                           // NOLINT
+            encode[c]                                                  // NOLINT
+                ? table[static_cast<std::size_t>(v * 65535.F + .5F)]   // NOLINT
+                : static_cast<unsigned char>(v * 255.F + .5F);         // NOLINT
+      }
+    }
+  }
+}
+}  // namespace detail
+
+// Builds the mipmap chain of an image of 1 to 4 components of 8 bits, rows
+// tightly packed as stb returns them. Levels are filtered from the previous
+// one in floating point, only the result being rounded to 8 bits, so that
+// rounding errors don't add up down the chain. The base level itself is
+// converted a few rows at a time, never as a whole.
+inline mip_chain build_mip_chain(const unsigned char* pixels,
+                                 unsigned int width,
+                                 unsigned int height,
+                                 unsigned int channels,
+                                 mip_options options = {}) {
+  mip_chain chain{channels, {}, {}};
+  if (width == 0 || height == 0 || channels == 0 || channels > 4) {
+    return chain;
+  }
+  std::size_t size = 0;
+  for (unsigned int w = width, h = height;;
+       w = std::max(w / 2, 1U), h = std::max(h / 2, 1U)) {
+    chain.levels.push_back(mip_level{gl::width{w}, gl::height{h}, size});
+    size += mip_chain::row_size(w, channels) * h;
+    if (w == 1 && h == 1) {
+      break;
+    }
+  }
+  chain.pixels.resize(size);
+
+  const std::size_t packed = static_cast<std::size_t>(width) * channels;
+  const std::size_t stride = mip_chain::row_size(width, channels);
+  for (unsigned int y = 0; y < height; ++y) {
+    std::memcpy(chain.pixels.data() + y * stride,  // NOLINT
+                pixels + y * packed,               // NOLINT
+                packed);
+  }
+
+  const auto kernel = detail::make_mip_kernel(options.filter);
+  std::vector<float> current;
+  std::vector<float> next;
+  std::vector<float> row;
+  detail::linear_rows base{pixels, width, channels, options.srgb, kernel.taps};
+  for (std::size_t level = 1; level < chain.levels.size(); ++level) {
+    const auto& previous = chain.levels[level - 1];
+    const auto& l = chain.levels[level];
+    next.resize(static_cast<std::size_t>(l.width.value) * l.height.value *
+                channels);
+    const std::size_t previous_stride =
+        static_cast<std::size_t>(previous.width.value) * channels;
+    const auto rows = [&](std::size_t y) {
+      return level == 1 ? base(y)
+                        : current.data() + y * previous_stride;  // NOLINT
+    };
+    detail::downsample(rows,
+                       previous.width.value,
+                       previous.height.value,
+                       channels,
+                       kernel,
+                       next.data(),
+                       row);
+    detail::quantize(next.data(),
+                     l.width.value,
+                     l.height.value,
+                     channels,
+                     options.srgb,
+                     chain.pixels.data() + l.offset);  // NOLINT
+    std::swap(current, next);
+  }
+  return chain;
+}
+
+namespace detail {
+// Mipmap chains built by load_mipmapped() are stored next to their source,
+// with ".mips" appended, and reused as long as the source content and the
+// options stay the same.
+struct mip_cache_header {
+  char magic[8];  // NOLINT
+  std::uint64_t source_hash;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t channels;
+  std::uint32_t levels;
+  std::uint32_t filter;
+  std::uint32_t srgb;
+  std::uint32_t flip;
+  std::uint32_t reserved;
+};
+
+constexpr inline char mip_cache_magic[8] = {  // NOLINT
+    'D', 'P', 'S', 'G', 'M', 'I', 'P', '1'};
+
+inline mip_cache_header make_mip_cache_header(std::uint64_t source_hash,
+                                              unsigned int channels,
+                                              mip_options options,
+                                              bool flip) noexcept {
+  mip_cache_header header{};
+  std::memcpy(header.magic, mip_cache_magic, sizeof(header.magic));
+  header.source_hash = source_hash;
+  header.channels = channels;
+  header.filter = static_cast<std::uint32_t>(options.filter);
+  header.srgb = options.srgb ? 1 : 0;
+  header.flip = flip ? 1 : 0;
+  return header;
+}
+
+// Levels of a cache file matching 'expected', pointing into 'data', or
+// nothing if the file is stale or damaged.
+inline std::vector<image_level> read_mip_cache(
+    const unsigned char* data,
+    std::size_t size,
+    const mip_cache_header& expected) {
+  mip_cache_header header{};
+  if (size < sizeof(header)) {
+    return {};
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+      header.source_hash != expected.source_hash ||
+      header.channels != expected.channels ||
+      header.filter != expected.filter || header.srgb != expected.srgb ||
+      header.flip != expected.flip || header.levels == 0) {
+    return {};
+  }
+  std::vector<image_level> levels;
+  std::size_t offset = sizeof(header);
+  for (unsigned int level = 0; level < header.levels; ++level) {
+    const unsigned int w = std::max(header.width >> level, 1U);
+    const unsigned int h = std::max(header.height >> level, 1U);
+    const std::size_t level_size = mip_chain::row_size(w, header.channels) * h;
+    if (level_size > size - offset) {
+      return {};
+    }
+    levels.push_back(image_level{gl::width{w}, gl::height{h}, data + offset});
+    offset += level_size;
+  }
+  return levels;
+}
+
+// Failing to write the cache only costs the next run the time to rebuild
+// the chain, so errors are ignored. The file is written under another name
+// first, so that a concurrent run never reads a partial cache.
+inline void write_mip_cache(const std::string& path,
+                            mip_cache_header header,
+                            const mip_chain& chain) {
+  header.width = chain.levels.front().width.value;
+  header.height = chain.levels.front().height.value;
+  header.levels = static_cast<std::uint32_t>(chain.levels.size());
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(&header),  // NOLINT
+               sizeof(header));
+    file.write(reinterpret_cast<const char*>(chain.pixels.data()),  // NOLINT
+               static_cast<std::streamsize>(chain.pixels.size()));
+    if (!file) {
+      file.close();
+      std::remove(temporary.c_str());
+      return;
+    }
+  }
+  // rename() doesn't replace existing files on Windows.
+  std::remove(path.c_str());
+  std::rename(temporary.c_str(), path.c_str());
+}
+
+inline result<mip_chain, loading_error> decode_mip_chain(
+    const unsigned char* data,
+    std::size_t size,
+    const char* name,
+    gl::image_format format,
+    mip_options mips,
+    bool flip) {
+  const auto channels = gl::component_count(format);
+  auto image = decode_image(data, size, flip, static_cast<int>(channels));
+  if (!image.pixels) {
+    const char* reason = stbi_failure_reason();
+    return failure{name, reason != nullptr ? reason : "empty file"};
+  }
+  return success{build_mip_chain(image.pixels.get(),
+                                 static_cast<unsigned int>(image.width),
+                                 static_cast<unsigned int>(image.height),
+                                 channels,
+                                 mips)};
+}
+}  // namespace detail
+
+// Loads a texture with mipmaps filtered on the CPU (see mip_options) rather
+// than by the driver, and uploads every level explicitly.
+//
+// The chain is saved next to the file, with ".mips" appended, and loaded
+// from there as is on later runs, skipping both the decoding and the
+// filtering, until the content of the file or the options change.
+//
+//    auto wall = load_mipmapped<texture_rgb>(texture_filename{"wall.jpg"},
+//                                            texture_options::repeat_linear);
+template <class TextureTraits, class T, class TextureOptions>
+result<texture_2d, loading_error> load_mipmapped(
+    const texture_filename<T>& filename,
+    TextureOptions&& options,
+    mip_options mips = {},
+    bool flip = true) {
+  auto file = mapped_file::open(filename.c_str());
+  if (!file.has_value()) {
+    return failure{std::move(file).error()};
+  }
+  const auto format = TextureTraits::image_format();
+  const auto header = detail::make_mip_cache_header(
+      fnv1a(file.value().view()),
+      gl::component_count(format),
+      mips,
+      flip);
+  const std::string cache_path = std::string{filename.c_str()} + ".mips";
+  if (auto cache = mapped_file::open(cache_path.c_str()); cache.has_value()) {
+    const auto levels = detail::read_mip_cache(
+        cache.value().data(), cache.value().size(), header);
+    if (!levels.empty()) {
+      return success{
+          texture_2d{format, levels, std::forward<TextureOptions>(options)}};
+    }
+  }
+  auto chain = detail::decode_mip_chain(file.value().data(),
+                                        file.value().size(),
+                                        filename.c_str(),
+                                        format,
+                                        mips,
+                                        flip);
+  if (!chain.has_value()) {
+    return failure{std::move(chain).error()};
+  }
+  detail::write_mip_cache(cache_path, header, chain.value());
+  return success{texture_2d{format,
+                            chain.value().image_levels(),
+                            std::forward<TextureOptions>(options)}};
+}
+
+// Embedded textures have nowhere to keep a cache: the chain is built every
+// time. Building it at compile time instead is left to the build.
+template <class TextureTraits, class TextureOptions>
+result<texture_2d, loading_error> load_mipmapped(
+    const texture_embedded& texture,
+    TextureOptions&& options,
+    mip_options mips = {},
+    bool flip = true) {
+  const auto& file = texture.file();
+  auto chain = detail::decode_mip_chain(file.data,
+                                        file.size,
+                                        std::string{file.name}.c_str(),
+                                        TextureTraits::image_format(),
+                                        mips,
+                                        flip);
+  if (!chain.has_value()) {
+    return failure{std::move(chain).error()};
+  }
+  return success{texture_2d{TextureTraits::image_format(),
+                            chain.value().image_levels(),
+                            std::forward<TextureOptions>(options)}};
+}
+
+template <class TextureTraits, class T>
+result<texture_2d, loading_error> load_mipmapped(
+    const texture_filename<T>& filename) {
+  return load_mipmapped<TextureTraits>(filename, texture_options::no_options);
+}
+
+template <class TextureTraits>
+result<texture_2d, loading_error> load_mipmapped(
+    const texture_embedded& texture) {
+  return load_mipmapped<TextureTraits>(texture, texture_options::no_options);
+}
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_MIPMAP_HEADER
\ No newline at end of file
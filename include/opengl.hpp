@@ -5,6 +5,9 @@
 
 #include "meta/is_one_of.hpp"
 
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <type_traits>
 
 namespace dpsg::gl {
@@ -45,6 +48,173 @@ auto value(const T& t) noexcept {
 
 }  // namespace detail
 
+// Opt-in shadow copy of the context state set through the functions of this
+// header. When DPSG_GL_STATE_CACHE is defined, a call that would set a value
+// the context already holds is dropped instead of reaching the driver. The
+// cache only sees changes made through dpsg::gl: call state_cache::invalidate
+// after raw GL calls, third party renderers or a context switch.
+struct state_cache_stats {
+  std::size_t issued{0};
+  std::size_t elided{0};
+};
+
+namespace detail {
+#ifdef DPSG_GL_STATE_CACHE
+constexpr static inline bool state_cache_enabled = true;
+#else
+constexpr static inline bool state_cache_enabled = false;
+#endif
+
+template <class T>
+struct shadow_value {
+  T value{};
+  bool known{false};
+
+  // Returns whether the value changed.
+  bool set(const T& v) noexcept {
+    if (known && value == v) {
+      return false;
+    }
+    value = v;
+    known = true;
+    return true;
+  }
+};
+
+// Shadow values of an indexed piece of state (capabilities, buffer targets,
+// texture units). Keys that don't fit are never cached.
+template <class T, std::size_t N>
+struct shadow_table {
+  std::array<enum_t, N> keys{};
+  std::array<shadow_value<T>, N> values{};
+  std::size_t count{0};
+
+  bool set(enum_t key, const T& v) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+      if (keys[i] == key) {
+        return values[i].set(v);
+      }
+    }
+    if (count < N) {
+      keys[count] = key;
+      values[count].set(v);
+      ++count;
+    }
+    return true;
+  }
+
+  void forget(enum_t key) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+      if (keys[i] == key) {
+        values[i].known = false;
+      }
+    }
+  }
+
+  // Forgets the entries holding 'v', e.g. a deleted object.
+  void forget_value(const T& v) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+      if (values[i].value == v) {
+        values[i].known = false;
+      }
+    }
+  }
+};
+
+struct shadow_state {
+  constexpr static inline std::size_t max_texture_bindings = 64;
+
+  shadow_value<uint_t> program;
+  shadow_value<uint_t> vertex_array;
+  shadow_table<uint_t, 16> buffers;  // NOLINT
+  // Keyed by target | (unit << 16).
+  shadow_table<uint_t, max_texture_bindings> textures;
+  shadow_value<enum_t> active_texture;
+  // Keyed by unit.
+  shadow_table<uint_t, 32> samplers;  // NOLINT
+  shadow_table<bool, 48> capabilities;  // NOLINT
+  shadow_value<std::array<enum_t, 2>> blend_func;
+  shadow_value<enum_t> blend_equation;
+  shadow_value<enum_t> depth_func;
+  shadow_value<bool> depth_mask;
+  shadow_value<enum_t> cull_face;
+  shadow_value<enum_t> front_face;
+  shadow_value<std::array<int_t, 4>> viewport;
+  shadow_value<std::array<int_t, 4>> scissor;
+  state_cache_stats stats;
+
+  // Deleting the bound vertex array reverts to vertex array 0, whose element
+  // array binding is unknown as well.
+  void forget_vertex_array() noexcept {
+    vertex_array.known = false;
+    buffers.forget(GL_ELEMENT_ARRAY_BUFFER);
+  }
+
+  // Binding texture 0 to a unit through glBindTextures unbinds every target
+  // of the unit, not only one.
+  void unbind_texture_unit(enum_t unit) noexcept {
+    for (std::size_t i = 0; i < textures.count; ++i) {
+      if ((textures.keys[i] >> 16U) == unit) {  // NOLINT
+        textures.values[i].set(0);               // NOLINT
+      }
+    }
+  }
+};
+
+inline thread_local shadow_state shadow{};
+
+// Applies 'update' to the shadow state and returns whether the call it
+// describes must reach the driver.
+template <class F>
+inline bool state_changes([[maybe_unused]] F&& update) noexcept {
+  if constexpr (state_cache_enabled) {
+    const bool changed = update(shadow);
+    ++(changed ? shadow.stats.issued : shadow.stats.elided);
+    return changed;
+  }
+  else {
+    return true;
+  }
+}
+
+template <class F>
+inline void forget_state([[maybe_unused]] F&& update) noexcept {
+  if constexpr (state_cache_enabled) {
+    update(shadow);
+  }
+}
+}  // namespace detail
+
+// Control over the state cache of the current thread. Every function is a
+// no-op when the cache isn't compiled in.
+struct state_cache {
+  constexpr static inline bool enabled = detail::state_cache_enabled;
+
+  // Forgets everything, so that the next call of each kind reaches the
+  // driver.
+  static void invalidate() noexcept {
+    detail::forget_state([](detail::shadow_state& s) {
+      const state_cache_stats stats = s.stats;
+      s = detail::shadow_state{};
+      s.stats = stats;
+    });
+  }
+
+  [[nodiscard]] static state_cache_stats stats() noexcept {
+    if constexpr (enabled) {
+      return detail::shadow.stats;
+    }
+    else {
+      return state_cache_stats{};
+    }
+  }
+
+  static void reset_stats() noexcept {
+    detail::forget_state(
+        [](detail::shadow_state& s) { s.stats = state_cache_stats{}; });
+  }
+};
+
 enum class buffer_bit : enum_t {
   color = GL_COLOR_BUFFER_BIT,
   depth = GL_DEPTH_BUFFER_BIT,
@@ -141,7 +311,11 @@ struct index {
 };
 
 inline void enable(capability cp) noexcept {
-  glEnable(static_cast<enum_t>(cp));
+  const auto c = static_cast<enum_t>(cp);
+  if (detail::state_changes(
+          [c](auto& s) { return s.capabilities.set(c, true); })) {
+    glEnable(c);
+  }
 }
 template <class... Args>
 inline void enable(Args&&... args) noexcept {
@@ -149,15 +323,23 @@ inline void enable(Args&&... args) noexcept {
 }
 
 inline void enable(capability cp, index index) noexcept {
-  glEnablei(static_cast<enum_t>(cp), index.value);
+  const auto c = static_cast<enum_t>(cp);
+  detail::forget_state([c](auto& s) { s.capabilities.forget(c); });
+  glEnablei(c, index.value);
 }
 
 inline void disable(capability cp) noexcept {
-  glDisable(static_cast<enum_t>(cp));
+  const auto c = static_cast<enum_t>(cp);
+  if (detail::state_changes(
+          [c](auto& s) { return s.capabilities.set(c, false); })) {
+    glDisable(c);
+  }
 }
 
 inline void disable(capability cp, index i) noexcept {
-  glDisablei(static_cast<enum_t>(cp), i.value);
+  const auto c = static_cast<enum_t>(cp);
+  detail::forget_state([c](auto& s) { s.capabilities.forget(c); });
+  glDisablei(c, i.value);
 }
 
 inline bool is_enabled(capability cp) noexcept {
@@ -175,7 +357,10 @@ enum class cull_mode : enum_t {
 };
 
 inline void cull_face(cull_mode cm) noexcept {
-  glCullFace(static_cast<enum_t>(cm));
+  const auto m = static_cast<enum_t>(cm);
+  if (detail::state_changes([m](auto& s) { return s.cull_face.set(m); })) {
+    glCullFace(m);
+  }
 }
 
 enum class buffer_type : enum_t {
@@ -222,6 +407,18 @@ inline void draw_arrays(drawing_mode mode,
   glDrawArrays(static_cast<enum_t>(mode), first.value, count.value);
 }
 
+struct instance_count {
+  size_t value;
+};
+
+inline void draw_arrays_instanced(drawing_mode mode,
+                                  index first,
+                                  element_count count,
+                                  instance_count instances) noexcept {
+  glDrawArraysInstanced(
+      static_cast<enum_t>(mode), first.value, count.value, instances.value);
+}
+
 struct color {
   float_t r = 0.F;
   float_t g = 0.F;
@@ -513,6 +710,16 @@ struct byte_offset {
   unsigned int value;
 };
 
+template <class T>
+inline void buffer_sub_data(buffer_type type,
+                            byte_offset offset,
+                            byte_size size,
+                            const T* ptr) noexcept {
+  static_assert(detail::is_valid_gl_type_v<T>,
+                "Input pointer type is incompatible with the OpenGL API");
+  glBufferSubData(static_cast<enum_t>(type), offset.value, size.value, ptr);
+}
+
 template <typename T,
           class U,
           std::enable_if_t<detail::is_vec_dimension_type_v<U>, int> = 0,
@@ -564,6 +771,20 @@ enable_vertex_attrib_array(Args&&... is) noexcept -> std::void_t<decltype(
   (glEnableVertexAttribArray(detail::value(is)), ...);
 }
 
+template <class... Args>
+inline auto
+disable_vertex_attrib_array(Args&&... is) noexcept -> std::void_t<decltype(
+    std::enable_if_t<detail::acceptable_index_types<Args...>::value, int>{})> {
+  (glDisableVertexAttribArray(detail::value(is)), ...);
+}
+
+// A divisor of 0 advances the attribute per vertex, N > 0 once every N
+// instances.
+inline void vertex_attrib_divisor(attrib_location idx,
+                                  uint_t divisor) noexcept {
+  glVertexAttribDivisor(idx.value, divisor);
+}
+
 template <class T>
 inline void draw_elements(drawing_mode mode,
                           element_count count,
@@ -592,7 +813,7 @@ inline void draw_elements_base_vertex(drawing_mode mode,
   glDrawElementsBaseVertex(static_cast<int>(mode),
                            count.value,
                            gl_type,
-                           reinterpret_cast<void*>(o.value),
+                           reinterpret_cast<void*>(o.value * sizeof(T)),
                            base_vertex.value);
 }
 
@@ -603,6 +824,30 @@ inline void draw_elements_base_vertex(drawing_mode mode,
   draw_elements_base_vertex<T>(mode, count, offset{0}, base_vertex);
 }
 
+enum class index_type : enum_t {
+  unsigned_byte = GL_UNSIGNED_BYTE,
+  unsigned_short = GL_UNSIGNED_SHORT,
+  unsigned_int = GL_UNSIGNED_INT,
+};
+
+template <class T>
+constexpr static inline index_type index_type_of =
+    static_cast<index_type>(detail::deduce_gl_enum_v<T>);
+
+// Runtime-typed counterpart of draw_elements_base_vertex<T>, for callers that
+// store the index type alongside the draw (e.g. deferred command buffers).
+inline void draw_elements_base_vertex(drawing_mode mode,
+                                      element_count count,
+                                      index_type type,
+                                      byte_offset o,
+                                      index base_vertex) noexcept {
+  glDrawElementsBaseVertex(static_cast<int>(mode),
+                           count.value,
+                           static_cast<enum_t>(type),
+                           reinterpret_cast<void*>(o.value),  // NOLINT
+                           base_vertex.value);
+}
+
 template <class T>
 inline void draw_elements(drawing_mode mode,
                           element_count count,
@@ -618,6 +863,43 @@ inline void draw_elements(drawing_mode mode,
   draw_elements_base_vertex<T>(mode, count, base_vertex);
 }
 
+template <class T>
+inline void draw_elements_instanced(drawing_mode mode,
+                                    element_count count,
+                                    instance_count instances,
+                                    offset o = offset{0}) noexcept {
+  constexpr int gl_type = detail::deduce_gl_enum_v<T>;
+  static_assert(
+      gl_type == GL_UNSIGNED_BYTE || gl_type == GL_UNSIGNED_SHORT ||
+          gl_type == GL_UNSIGNED_INT,
+      "Input type to element rendering must be an unsigned integral type");
+  glDrawElementsInstanced(static_cast<int>(mode),
+                          count.value,
+                          gl_type,
+                          reinterpret_cast<void*>(o.value * sizeof(T)),
+                          instances.value);
+}
+
+template <class T>
+inline void draw_elements_instanced(drawing_mode mode,
+                                    element_count count,
+                                    instance_count instances,
+                                    offset o,
+                                    index base_vertex) noexcept {
+  constexpr int gl_type = detail::deduce_gl_enum_v<T>;
+  static_assert(
+      gl_type == GL_UNSIGNED_BYTE || gl_type == GL_UNSIGNED_SHORT ||
+          gl_type == GL_UNSIGNED_INT,
+      "Input type to element rendering must be an unsigned integral type");
+  glDrawElementsInstancedBaseVertex(
+      static_cast<int>(mode),
+      count.value,
+      gl_type,
+      reinterpret_cast<void*>(o.value * sizeof(T)),
+      instances.value,
+      base_vertex.value);
+}
+
 struct generic_buffer_id {
   unsigned int value;
 };
@@ -631,17 +913,51 @@ struct buffer_id : generic_buffer_id {
   constexpr static inline buffer_type buffer_type{Type};
 };
 
+// The element array binding is part of the vertex array state, so it is
+// forgotten whenever the bound vertex array changes.
 inline void bind_buffer(buffer_type btype, generic_buffer_id id) noexcept {
-  glBindBuffer(static_cast<int>(btype), id.value);
+  const auto t = static_cast<enum_t>(btype);
+  if (detail::state_changes(
+          [t, id](auto& s) { return s.buffers.set(t, id.value); })) {
+    glBindBuffer(t, id.value);
+  }
 }
 
 template <buffer_type Type>
 inline void bind_buffer(buffer_id<Type> id) noexcept {
-  glBindBuffer(static_cast<int>(buffer_id<Type>::buffer_type), id.value);
+  bind_buffer(buffer_id<Type>::buffer_type, id);
 }
 
 inline void unbind_buffer(buffer_type type) noexcept {
-  glBindBuffer(static_cast<int>(type), 0);
+  bind_buffer(type, generic_buffer_id{0});
+}
+
+// Index of an indexed binding point (uniform or shader storage buffers).
+struct buffer_binding {
+  uint_t value;
+};
+
+inline void bind_buffer_base(buffer_type type,
+                             buffer_binding binding,
+                             generic_buffer_id id) noexcept {
+  const auto t = static_cast<enum_t>(type);
+  // Also binds the buffer to the generic binding point of the target.
+  detail::forget_state([t, id](auto& s) { s.buffers.set(t, id.value); });
+  glBindBufferBase(t, binding.value, id.value);
+}
+
+inline void bind_buffer_range(buffer_type type,
+                              buffer_binding binding,
+                              generic_buffer_id id,
+                              byte_offset offset,
+                              byte_size size) noexcept {
+  const auto t = static_cast<enum_t>(type);
+  detail::forget_state([t, id](auto& s) { s.buffers.set(t, id.value); });
+  glBindBufferRange(t,
+                    binding.value,
+                    id.value,
+                    offset.value,
+                    size.value);
 }
 
 template <std::size_t N>
@@ -668,16 +984,28 @@ inline buffer_id<Type> gen_buffer() noexcept {
 template <std::size_t N>
 // NOLINTNEXTLINE
 inline void delete_buffers(const generic_buffer_id (&buffer)[N]) noexcept {
+  detail::forget_state([&buffer](auto& s) {
+    for (const auto& b : buffer) {
+      s.buffers.forget_value(b.value);
+    }
+  });
   glDeleteBuffers(N, reinterpret_cast<const unsigned int*>(buffer));  // NOLINT
 }
 
 inline void delete_buffers(std::size_t count,
                            const generic_buffer_id* buffers) noexcept {
+  detail::forget_state([count, buffers](auto& s) {
+    for (std::size_t i = 0; i < count; ++i) {
+      s.buffers.forget_value(buffers[i].value);  // NOLINT
+    }
+  });
   glDeleteBuffers(count,
                   reinterpret_cast<const unsigned int*>(buffers));  // NOLINT
 }
 
 inline void delete_buffer(const generic_buffer_id& buffer) noexcept {
+  detail::forget_state(
+      [&buffer](auto& s) { s.buffers.forget_value(buffer.value); });
   glDeleteBuffers(1, reinterpret_cast<const unsigned int*>(&buffer));  // NOLINT
 }
 
@@ -705,27 +1033,38 @@ inline vertex_array_id gen_vertex_array() noexcept {
 template <std::size_t N>
 // NOLINTNEXTLINE
 inline void delete_vertex_arrays(const vertex_array_id (&buffer)[N]) noexcept {
+  detail::forget_state([](auto& s) { s.forget_vertex_array(); });
   glDeleteVertexArrays(
       N, reinterpret_cast<const unsigned int*>(buffer));  // NOLINT
 }
 
 inline void delete_vertex_arrays(std::size_t count,
                                  const vertex_array_id* buffer) noexcept {
+  detail::forget_state([](auto& s) { s.forget_vertex_array(); });
   glDeleteVertexArrays(
       count, reinterpret_cast<const unsigned int*>(buffer));  // NOLINT
 }
 
 inline void delete_vertex_array(const vertex_array_id& id) noexcept {
+  detail::forget_state([](auto& s) { s.forget_vertex_array(); });
   glDeleteVertexArrays(1,
                        reinterpret_cast<const unsigned int*>(&id));  // NOLINT
 }
 
 inline void bind_vertex_array(vertex_array_id id) noexcept {
-  glBindVertexArray(id.value);
+  if (detail::state_changes([id](auto& s) {
+        const bool changed = s.vertex_array.set(id.value);
+        if (changed) {
+          s.buffers.forget(static_cast<enum_t>(buffer_type::element_array));
+        }
+        return changed;
+      })) {
+    glBindVertexArray(id.value);
+  }
 }
 
 inline void unbind_vertex_array() noexcept {
-  glBindVertexArray(0);
+  bind_vertex_array(vertex_array_id{0});
 }
 
 struct program_id {
@@ -746,6 +1085,81 @@ inline uniform_location get_uniform_location(program_id id,
   return uniform_location{glGetUniformLocation(id.value, name)};
 }
 
+struct uniform_block_index {
+  uint_t value;
+  [[nodiscard]] bool has_value() const noexcept {
+    return value != GL_INVALID_INDEX;
+  }
+};
+
+inline uniform_block_index get_uniform_block_index(program_id id,
+                                                   const char* name) noexcept {
+  return uniform_block_index{glGetUniformBlockIndex(id.value, name)};
+}
+
+inline void uniform_block_binding(program_id id,
+                                  uniform_block_index index,
+                                  buffer_binding binding) noexcept {
+  glUniformBlockBinding(id.value, index.value, binding.value);
+}
+
+enum class program_parameter : enum_t {
+  link_status = GL_LINK_STATUS,
+  info_log_length = GL_INFO_LOG_LENGTH,
+  active_uniforms = GL_ACTIVE_UNIFORMS,
+  active_uniform_max_length = GL_ACTIVE_UNIFORM_MAX_LENGTH,
+  active_attributes = GL_ACTIVE_ATTRIBUTES,
+  active_attribute_max_length = GL_ACTIVE_ATTRIBUTE_MAX_LENGTH,
+  active_uniform_blocks = GL_ACTIVE_UNIFORM_BLOCKS,
+  active_uniform_block_max_name_length =
+      GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH,
+};
+
+[[nodiscard]] inline int_t get_program(program_id id,
+                                       program_parameter param) noexcept {
+  int_t value{0};
+  glGetProgramiv(id.value, static_cast<enum_t>(param), &value);
+  return value;
+}
+
+// Description of an active uniform or attribute. 'size' is the number of
+// array elements, 1 for non arrays.
+struct active_variable {
+  int_t size;
+  enum_t type;
+  size_t name_length;
+};
+
+inline active_variable get_active_uniform(program_id id,
+                                          uint_t index,
+                                          size_t buffer_size,
+                                          char_t* name) noexcept {
+  active_variable v{0, 0, 0};
+  glGetActiveUniform(
+      id.value, index, buffer_size, &v.name_length, &v.size, &v.type, name);
+  return v;
+}
+
+inline active_variable get_active_attrib(program_id id,
+                                         uint_t index,
+                                         size_t buffer_size,
+                                         char_t* name) noexcept {
+  active_variable v{0, 0, 0};
+  glGetActiveAttrib(
+      id.value, index, buffer_size, &v.name_length, &v.size, &v.type, name);
+  return v;
+}
+
+inline size_t get_active_uniform_block_name(program_id id,
+                                            uniform_block_index index,
+                                            size_t buffer_size,
+                                            char_t* name) noexcept {
+  size_t length{0};
+  glGetActiveUniformBlockName(
+      id.value, index.value, buffer_size, &length, name);
+  return length;
+}
+
 enum class shader_type : enum_t {
   vertex = GL_VERTEX_SHADER,
   geometry = GL_GEOMETRY_SHADER,
@@ -828,13 +1242,73 @@ inline void link_program(program_id id) noexcept {
 }
 
 inline void use_program(program_id id) noexcept {
-  glUseProgram(id.value);
+  if (detail::state_changes(
+          [id](auto& s) { return s.program.set(id.value); })) {
+    glUseProgram(id.value);
+  }
 }
 
 inline void delete_program(program_id id) noexcept {
+  detail::forget_state([](auto& s) { s.program.known = false; });
   glDeleteProgram(id.value);
 }
 
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+struct binary_format {
+  enum_t value;
+};
+
+// Must be set before linking for get_program_binary to be reliable.
+inline void program_binary_retrievable_hint(program_id id) noexcept {
+  glProgramParameteri(id.value, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+[[nodiscard]] inline size_t program_binary_length(program_id id) noexcept {
+  int_t length{0};
+  glGetProgramiv(id.value, GL_PROGRAM_BINARY_LENGTH, &length);
+  return length;
+}
+
+inline size_t get_program_binary(program_id id,
+                                 size_t buffer_size,
+                                 binary_format& format,
+                                 void* binary) noexcept {
+  size_t length{0};
+  glGetProgramBinary(id.value, buffer_size, &length, &format.value, binary);
+  return length;
+}
+
+inline void program_binary(program_id id,
+                           binary_format format,
+                           const void* binary,
+                           size_t length) noexcept {
+  glProgramBinary(id.value, format.value, binary, length);
+}
+#endif
+
+#if defined(GL_KHR_parallel_shader_compile)
+// Number of threads the driver may use to compile shaders and link programs
+// in the background. 0xFFFFFFFF lets the implementation decide.
+inline void max_shader_compiler_threads(uint_t count) noexcept {
+  glMaxShaderCompilerThreadsKHR(count);
+}
+
+// Whether the compilation started by compile_shader is done, i.e. whether
+// querying its status would block.
+[[nodiscard]] inline bool completion_status(
+    const generic_shader_id& id) noexcept {
+  int_t done{GL_FALSE};
+  glGetShaderiv(id.value, GL_COMPLETION_STATUS_KHR, &done);
+  return done == GL_TRUE;
+}
+
+[[nodiscard]] inline bool completion_status(program_id id) noexcept {
+  int_t done{GL_FALSE};
+  glGetProgramiv(id.value, GL_COMPLETION_STATUS_KHR, &done);
+  return done == GL_TRUE;
+}
+#endif
+
 inline void delete_shader(const generic_shader_id& id) noexcept {
   glDeleteShader(id.value);
 }
@@ -866,16 +1340,27 @@ inline void gen_texture(texture_id& buffer) noexcept {
 template <std::size_t N>
 // NOLINTNEXTLINE
 inline void delete_textures(const texture_id (&buffer)[N]) noexcept {
+  detail::forget_state([&buffer](auto& s) {
+    for (const auto& t : buffer) {
+      s.textures.forget_value(t.value);
+    }
+  });
   glDeleteTextures(N, reinterpret_cast<const unsigned int*>(buffer));  // NOLINT
 }
 
 inline void delete_textures(std::size_t count,
                             const texture_id* buffer) noexcept {
+  detail::forget_state([count, buffer](auto& s) {
+    for (std::size_t i = 0; i < count; ++i) {
+      s.textures.forget_value(buffer[i].value);  // NOLINT
+    }
+  });
   glDeleteTextures(count,
                    reinterpret_cast<const unsigned int*>(buffer));  // NOLINT
 }
 
 inline void delete_texture(const texture_id& id) noexcept {
+  detail::forget_state([&id](auto& s) { s.textures.forget_value(id.value); });
   glDeleteTextures(1,
                    reinterpret_cast<const unsigned int*>(&id));  // NOLINT
 }
@@ -896,12 +1381,23 @@ enum class texture_target : enum_t {
 #endif
 };
 
+// Bindings are cached per texture unit, and only once the active unit is
+// known.
 inline void bind_texture(texture_target t, texture_id id) noexcept {
-  glBindTexture(static_cast<int>(t), id.value);
+  const auto target = static_cast<enum_t>(t);
+  if (detail::state_changes([target, id](auto& s) {
+        if (!s.active_texture.known) {
+          return true;
+        }
+        const enum_t unit = s.active_texture.value - GL_TEXTURE0;
+        return s.textures.set(target | (unit << 16U), id.value);
+      })) {
+    glBindTexture(target, id.value);
+  }
 }
 
 inline void unbind_texture(texture_target t) noexcept {
-  glBindTexture(static_cast<int>(t), 0);
+  bind_texture(t, texture_id{0});
 }
 
 enum class texture_parameter_name : enum_t {
@@ -991,8 +1487,8 @@ enum class mag_filter : enum_t {
 };
 
 enum class lod_parameter : enum_t {
-  min = GL_TEXTURE_MAX_LOD,
-  max = GL_TEXTURE_MIN_LOD,
+  min = GL_TEXTURE_MIN_LOD,
+  max = GL_TEXTURE_MAX_LOD,
   bias = GL_TEXTURE_LOD_BIAS,
 };
 
@@ -1132,6 +1628,11 @@ struct mipmap_level {
   unsigned int value;
 };
 
+// Number of mipmap levels of an image, including the base level.
+struct level_count {
+  unsigned int value;
+};
+
 struct width {
   unsigned int value;
 };
@@ -1140,6 +1641,24 @@ struct height {
   unsigned int value;
 };
 
+// Position of a region inside an existing image.
+struct x_offset {
+  int_t value;
+};
+
+struct y_offset {
+  int_t value;
+};
+
+// Layer of an array texture, or slice of a 3D texture.
+struct z_offset {
+  int_t value;
+};
+
+struct depth {
+  unsigned int value;
+};
+
 enum class image_format : enum_t {
   red = GL_RED,
   rg = GL_RG,
@@ -1160,6 +1679,28 @@ enum class image_format : enum_t {
 #endif
 };
 
+// Number of values per pixel in client memory for a given format.
+constexpr inline unsigned int component_count(image_format format) noexcept {
+  switch (format) {
+    case image_format::rg:
+    case image_format::rg_integer:
+    case image_format::depth_stencil:
+      return 2;
+    case image_format::rgb:
+    case image_format::bgr:
+    case image_format::rgb_integer:
+    case image_format::bgr_integer:
+      return 3;
+    case image_format::rgba:
+    case image_format::bgra:
+    case image_format::rgba_integer:
+    case image_format::bgra_integer:
+      return 4;
+    default:
+      return 1;
+  }
+}
+
 enum class base_internal_format : enum_t {
   depth_component = GL_DEPTH_COMPONENT,
   depth_stencil = GL_DEPTH_STENCIL,
@@ -1231,6 +1772,11 @@ enum class sized_internal_format : enum_t {
   rgba16ui = GL_RGBA16UI,
   rgba32i = GL_RGBA32I,
   rgba32ui = GL_RGBA32UI,
+  depth_component16 = GL_DEPTH_COMPONENT16,
+  depth_component24 = GL_DEPTH_COMPONENT24,
+  depth_component32f = GL_DEPTH_COMPONENT32F,
+  depth24_stencil8 = GL_DEPTH24_STENCIL8,
+  depth32f_stencil8 = GL_DEPTH32F_STENCIL8,
 };
 
 enum class compressed_internal_format : enum_t {
@@ -1244,11 +1790,37 @@ enum class compressed_internal_format : enum_t {
   signed_red_rgtc1 = GL_COMPRESSED_SIGNED_RED_RGTC1,
   rg_rgtc2 = GL_COMPRESSED_RG_RGTC2,
   signed_rg_rgtc2 = GL_COMPRESSED_SIGNED_RG_RGTC2,
-#ifdef GL_VERSION_4_2
+#if defined(GL_VERSION_4_2)
   rgba_bptc_unorm = GL_COMPRESSED_RGBA_BPTC_UNORM,
   srgb_alpha_bptc_unorm = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,
   rgb_bptc_signed_float = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT,
   rgb_bptc_unsigned_float = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,
+#elif defined(GL_ARB_texture_compression_bptc)
+  rgba_bptc_unorm = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB,
+  srgb_alpha_bptc_unorm = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB,
+  rgb_bptc_signed_float = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB,
+  rgb_bptc_unsigned_float = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB,
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_ES3_compatibility)
+  rgb8_etc2 = GL_COMPRESSED_RGB8_ETC2,
+  srgb8_etc2 = GL_COMPRESSED_SRGB8_ETC2,
+  rgb8_punchthrough_alpha1_etc2 = GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+  srgb8_punchthrough_alpha1_etc2 =
+      GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+  rgba8_etc2_eac = GL_COMPRESSED_RGBA8_ETC2_EAC,
+  srgb8_alpha8_etc2_eac = GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC,
+#endif
+#ifdef GL_EXT_texture_compression_s3tc
+  rgb_s3tc_dxt1 = GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+  rgba_s3tc_dxt1 = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+  rgba_s3tc_dxt3 = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
+  rgba_s3tc_dxt5 = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+#endif
+#ifdef GL_EXT_texture_sRGB
+  srgb_s3tc_dxt1 = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,
+  srgb_alpha_s3tc_dxt1 = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,
+  srgb_alpha_s3tc_dxt3 = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT,
+  srgb_alpha_s3tc_dxt5 = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
 #endif
 };
 
@@ -1314,6 +1886,23 @@ inline auto* get_data([[maybe_unused]] T unused, Args... args) noexcept {
   return get_data(args...);
 }
 
+// Like get(), but T is a one_of<...> list: returns the first argument whose
+// type is in the list, or the last argument, the default, if there is none.
+template <class T, class U>
+inline auto get_one_of(U val) noexcept {
+  return val;
+}
+
+template <class T, class U, class V, class... Args>
+inline auto get_one_of(U val, V next, Args... args) noexcept {
+  if constexpr (contains_v<T, U>) {
+    return value(val);
+  }
+  else {
+    return get_one_of<T>(next, args...);
+  }
+}
+
 using internal_format = one_of<base_internal_format,
                                compressed_internal_format,
                                sized_internal_format>;
@@ -1336,9 +1925,69 @@ inline void tex_image_2D(texture_image_target target, Args... args) noexcept {
 
   glTexImage2D(static_cast<int>(target),
                detail::get<mipmap_level>(args..., 0),
-               detail::get<detail::internal_format>(args..., img_frmt),
+               static_cast<int>(detail::get_one_of<detail::internal_format>(
+                   args..., img_frmt)),
+               detail::get<width>(args...),
+               detail::get<height>(args...),
+               0,
+               img_frmt,
+               detail::deduce_gl_enum_v<
+                   std::remove_pointer_t<std::decay_t<decltype(data)>>>,
+               data);
+}
+
+// Replaces a region of an existing image. When a buffer is bound to
+// buffer_type::pixel_unpack, the data pointer is an offset in that buffer.
+template <class... Args>
+inline void tex_sub_image_2D(texture_image_target target,
+                             Args... args) noexcept {
+  static_assert(detail::contains_v<width, Args...>,
+                "Parameter list must contain a width");
+  static_assert(detail::contains_v<height, Args...>,
+                "Parameter list must contain a height");
+  static_assert(detail::contains_v<detail::pointer_placeholder, Args...>,
+                "Parameter list must contain a data pointer");
+  static_assert(detail::contains_v<image_format, Args...>,
+                "Parameter list must contain a format description");
+
+  auto* const data = detail::get_data(args...);
+
+  glTexSubImage2D(static_cast<int>(target),
+                  detail::get<mipmap_level>(args..., 0),
+                  detail::get<x_offset>(args..., 0),
+                  detail::get<y_offset>(args..., 0),
+                  detail::get<width>(args...),
+                  detail::get<height>(args...),
+                  static_cast<int>(detail::get<image_format>(args...)),
+                  detail::deduce_gl_enum_v<
+                      std::remove_pointer_t<std::decay_t<decltype(data)>>>,
+                  data);
+}
+
+// Specifies a 3D image, or every layer of a 2D array texture at once.
+template <class... Args>
+inline void tex_image_3D(texture_target target, Args... args) noexcept {
+  static_assert(detail::contains_v<width, Args...>,
+                "Parameter list must contain a width");
+  static_assert(detail::contains_v<height, Args...>,
+                "Parameter list must contain a height");
+  static_assert(detail::contains_v<depth, Args...>,
+                "Parameter list must contain a depth");
+  static_assert(detail::contains_v<detail::pointer_placeholder, Args...>,
+                "Parameter list must contain a data pointer");
+  static_assert(detail::contains_v<image_format, Args...>,
+                "Parameter list must contain a format description");
+
+  auto* const data = detail::get_data(args...);
+  const auto img_frmt = static_cast<int>(detail::get<image_format>(args...));
+
+  glTexImage3D(static_cast<int>(target),
+               detail::get<mipmap_level>(args..., 0),
+               static_cast<int>(detail::get_one_of<detail::internal_format>(
+                   args..., img_frmt)),
                detail::get<width>(args...),
                detail::get<height>(args...),
+               detail::get<depth>(args...),
                0,
                img_frmt,
                detail::deduce_gl_enum_v<
@@ -1346,6 +1995,84 @@ inline void tex_image_2D(texture_image_target target, Args... args) noexcept {
                data);
 }
 
+template <class... Args>
+inline void tex_sub_image_3D(texture_target target, Args... args) noexcept {
+  static_assert(detail::contains_v<width, Args...>,
+                "Parameter list must contain a width");
+  static_assert(detail::contains_v<height, Args...>,
+                "Parameter list must contain a height");
+  static_assert(detail::contains_v<depth, Args...>,
+                "Parameter list must contain a depth");
+  static_assert(detail::contains_v<detail::pointer_placeholder, Args...>,
+                "Parameter list must contain a data pointer");
+  static_assert(detail::contains_v<image_format, Args...>,
+                "Parameter list must contain a format description");
+
+  auto* const data = detail::get_data(args...);
+
+  glTexSubImage3D(static_cast<int>(target),
+                  detail::get<mipmap_level>(args..., 0),
+                  detail::get<x_offset>(args..., 0),
+                  detail::get<y_offset>(args..., 0),
+                  detail::get<z_offset>(args..., 0),
+                  detail::get<width>(args...),
+                  detail::get<height>(args...),
+                  detail::get<depth>(args...),
+                  static_cast<int>(detail::get<image_format>(args...)),
+                  detail::deduce_gl_enum_v<
+                      std::remove_pointer_t<std::decay_t<decltype(data)>>>,
+                  data);
+}
+
+// Specifies an image from data already in the GPU's compressed format, as
+// stored in DDS or KTX files. 'size' is the size of this level only.
+inline void compressed_tex_image_2D(texture_image_target target,
+                                    mipmap_level level,
+                                    compressed_internal_format format,
+                                    width w,
+                                    height h,
+                                    byte_size size,
+                                    const void* data) noexcept {
+  glCompressedTexImage2D(static_cast<enum_t>(target),
+                         static_cast<int_t>(level.value),
+                         static_cast<enum_t>(format),
+                         static_cast<size_t>(w.value),
+                         static_cast<size_t>(h.value),
+                         0,
+                         size.value,
+                         data);
+}
+
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_storage)
+// Immutable storage: the size, format and number of levels can't change
+// after this call, which saves the driver from revalidating the texture.
+inline void tex_storage_2D(texture_target target,
+                           level_count levels,
+                           sized_internal_format format,
+                           width w,
+                           height h) noexcept {
+  glTexStorage2D(static_cast<enum_t>(target),
+                 static_cast<size_t>(levels.value),
+                 static_cast<enum_t>(format),
+                 static_cast<size_t>(w.value),
+                 static_cast<size_t>(h.value));
+}
+
+inline void tex_storage_3D(texture_target target,
+                           level_count levels,
+                           sized_internal_format format,
+                           width w,
+                           height h,
+                           depth d) noexcept {
+  glTexStorage3D(static_cast<enum_t>(target),
+                 static_cast<size_t>(levels.value),
+                 static_cast<enum_t>(format),
+                 static_cast<size_t>(w.value),
+                 static_cast<size_t>(h.value),
+                 static_cast<size_t>(d.value));
+}
+#endif
+
 enum class texture_name : enum_t {
   _0 = GL_TEXTURE0,
   _1 = GL_TEXTURE1,
@@ -1382,16 +2109,163 @@ enum class texture_name : enum_t {
 };
 
 inline void active_texture(texture_name name) noexcept {
-  glActiveTexture(static_cast<enum_t>(name));
+  const auto n = static_cast<enum_t>(name);
+  if (detail::state_changes([n](auto& s) { return s.active_texture.set(n); })) {
+    glActiveTexture(n);
+  }
+}
+
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_multi_bind)
+inline bool has_multi_bind() noexcept {
+#if defined(GL_VERSION_4_4)
+  if (GLAD_GL_VERSION_4_4) {
+    return true;
+  }
+#endif
+#if defined(GL_ARB_multi_bind)
+  if (GLAD_GL_ARB_multi_bind) {
+    return true;
+  }
+#endif
+  return false;
 }
 
+// Binds textures[i], of target targets[i], to unit first + i, in a single
+// call that leaves the active unit alone. A texture of 0 unbinds every target
+// of its unit. Only valid when has_multi_bind() is true.
+inline void bind_textures(texture_name first,
+                          std::size_t count,
+                          const texture_target* targets,
+                          const texture_id* textures) noexcept {
+  const auto unit = static_cast<enum_t>(first) - GL_TEXTURE0;
+  detail::forget_state([=](auto& s) {
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto u = unit + static_cast<enum_t>(i);
+      if (textures[i].value == 0) {  // NOLINT
+        s.unbind_texture_unit(u);
+      }
+      else {
+        s.textures.set(static_cast<enum_t>(targets[i]) | (u << 16U),  // NOLINT
+                       textures[i].value);                            // NOLINT
+      }
+    }
+  });
+  glBindTextures(unit,
+                 static_cast<size_t>(count),
+                 reinterpret_cast<const unsigned int*>(textures));  // NOLINT
+}
+#endif
+
+struct sampler_id {
+  unsigned int value;
+};
+
+[[nodiscard]] inline sampler_id gen_sampler() noexcept {
+  unsigned int id;  // NOLINT
+  glGenSamplers(1, &id);
+  return sampler_id{id};
+}
+
+inline void delete_sampler(const sampler_id& id) noexcept {
+  detail::forget_state([&id](auto& s) { s.samplers.forget_value(id.value); });
+  glDeleteSamplers(1, &id.value);
+}
+
+// While a sampler is bound to a unit, its parameters replace those of the
+// texture bound there.
+inline void bind_sampler(texture_name unit, sampler_id id) noexcept {
+  const auto u = static_cast<enum_t>(unit) - GL_TEXTURE0;
+  if (detail::state_changes(
+          [u, id](auto& s) { return s.samplers.set(u, id.value); })) {
+    glBindSampler(u, id.value);
+  }
+}
+
+inline void unbind_sampler(texture_name unit) noexcept {
+  bind_sampler(unit, sampler_id{0});
+}
+
+inline void sampler_parameter(sampler_id id,
+                              wrap_target wt,
+                              wrap_mode mode) noexcept {
+  glSamplerParameteri(
+      id.value, static_cast<enum_t>(wt), static_cast<int>(mode));
+}
+
+inline void sampler_parameter(sampler_id id, min_filter filter) noexcept {
+  glSamplerParameteri(
+      id.value, GL_TEXTURE_MIN_FILTER, static_cast<int>(filter));
+}
+
+inline void sampler_parameter(sampler_id id, mag_filter filter) noexcept {
+  glSamplerParameteri(
+      id.value, GL_TEXTURE_MAG_FILTER, static_cast<int>(filter));
+}
+
+inline void sampler_parameter(sampler_id id, compare_mode mode) noexcept {
+  glSamplerParameteri(
+      id.value, GL_TEXTURE_COMPARE_MODE, static_cast<int>(mode));
+}
+
+inline void sampler_parameter(sampler_id id,
+                              compare_function function) noexcept {
+  glSamplerParameteri(
+      id.value, GL_TEXTURE_COMPARE_FUNC, static_cast<int>(function));
+}
+
+inline void sampler_parameter(sampler_id id,
+                              lod_parameter param,
+                              float value) noexcept {
+  glSamplerParameterf(id.value, static_cast<enum_t>(param), value);
+}
+
+inline void sampler_parameter(sampler_id id,
+                              const float (&colors)[4]  // NOLINT
+                              ) noexcept {
+  glSamplerParameterfv(id.value,
+                       GL_TEXTURE_BORDER_COLOR,
+                       static_cast<const float*>(colors));
+}
+
+#if defined(GL_VERSION_4_6) || defined(GL_EXT_texture_filter_anisotropic)
+struct max_anisotropy {
+  float value;
+};
+
+inline bool has_anisotropic_filtering() noexcept {
+#if defined(GL_VERSION_4_6)
+  if (GLAD_GL_VERSION_4_6) {
+    return true;
+  }
+#endif
+#if defined(GL_EXT_texture_filter_anisotropic)
+  if (GLAD_GL_EXT_texture_filter_anisotropic) {
+    return true;
+  }
+#endif
+  return false;
+}
+
+// Only valid when has_anisotropic_filtering() is true.
+inline void sampler_parameter(sampler_id id, max_anisotropy a) noexcept {
+#if defined(GL_VERSION_4_6)
+  glSamplerParameterf(id.value, GL_TEXTURE_MAX_ANISOTROPY, a.value);
+#else
+  glSamplerParameterf(id.value, GL_TEXTURE_MAX_ANISOTROPY_EXT, a.value);
+#endif
+}
+#endif
+
 enum class face_mode : enum_t {
   clockwise = GL_CW,
   counter_clockwise = GL_CCW,
 };
 
 inline void front_face(face_mode mode) noexcept {
-  glFrontFace(static_cast<enum_t>(mode));
+  const auto m = static_cast<enum_t>(mode);
+  if (detail::state_changes([m](auto& s) { return s.front_face.set(m); })) {
+    glFrontFace(m);
+  }
 }
 
 inline void uniform(uniform_location loc, float_t f) noexcept {
@@ -1554,7 +2428,10 @@ inline void uniform(uniform_location loc,
 }
 
 inline void depth_func(compare_function func) noexcept {
-  glDepthFunc(static_cast<enum_t>(func));
+  const auto f = static_cast<enum_t>(func);
+  if (detail::state_changes([f](auto& s) { return s.depth_func.set(f); })) {
+    glDepthFunc(f);
+  }
 }
 
 template <class T>
@@ -1580,7 +2457,10 @@ inline void depth_range(near<T> n, far<T> f) noexcept {
 }
 
 inline void depth_mask(bool enabled) noexcept {
-  glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+  if (detail::state_changes(
+          [enabled](auto& s) { return s.depth_mask.set(enabled); })) {
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+  }
 }
 
 struct x {
@@ -1591,12 +2471,18 @@ struct y {
   int_t value;
 };
 
-inline void viewport(width w, height h) noexcept {
-  glViewport(0, 0, w.value, h.value);
+inline void viewport(x x, y y, width w, height h) noexcept {
+  const std::array<int_t, 4> v{x.value,
+                               y.value,
+                               static_cast<int_t>(w.value),
+                               static_cast<int_t>(h.value)};
+  if (detail::state_changes([&v](auto& s) { return s.viewport.set(v); })) {
+    glViewport(x.value, y.value, w.value, h.value);
+  }
 }
 
-inline void viewport(x x, y y, width w, height h) noexcept {
-  glViewport(x.value, y.value, w.value, h.value);
+inline void viewport(width w, height h) noexcept {
+  viewport(x{0}, y{0}, w, h);
 }
 
 inline attrib_location get_attrib_location(program_id id,
@@ -1613,11 +2499,16 @@ enum class blend_mode : enum_t {
 };
 
 inline void blend_equation(blend_mode eq) noexcept {
-  glBlendEquation(static_cast<enum_t>(eq));
+  const auto e = static_cast<enum_t>(eq);
+  if (detail::state_changes(
+          [e](auto& s) { return s.blend_equation.set(e); })) {
+    glBlendEquation(e);
+  }
 }
 
 #ifdef GL_VERSION_4_0
 inline void blend_equation(index buf, blend_mode eq) noexcept {
+  detail::forget_state([](auto& s) { s.blend_equation.known = false; });
   glBlendEquationi(buf.value, static_cast<enum_t>(eq));
 }
 #endif
@@ -1640,11 +2531,16 @@ enum class blend_factor : enum_t {
 };
 
 inline void blend_func(blend_factor sf, blend_factor df) noexcept {
-  glBlendFunc(static_cast<enum_t>(sf), static_cast<enum_t>(df));
+  const std::array<enum_t, 2> f{static_cast<enum_t>(sf),
+                                static_cast<enum_t>(df)};
+  if (detail::state_changes([&f](auto& s) { return s.blend_func.set(f); })) {
+    glBlendFunc(f[0], f[1]);
+  }
 }
 
 #ifdef GL_VERSION_4_0
 inline void blend_func(index idx, blend_factor sf, blend_factor df) noexcept {
+  detail::forget_state([](auto& s) { s.blend_func.known = false; });
   glBlendFunci(idx.value, static_cast<enum_t>(sf), static_cast<enum_t>(df));
 }
 #endif
@@ -1673,8 +2569,216 @@ inline void unmap_buffer(generic_buffer_id id) noexcept {
 }
 #endif
 
+enum class map_access : enum_t {
+  read = GL_MAP_READ_BIT,
+  write = GL_MAP_WRITE_BIT,
+  invalidate_range = GL_MAP_INVALIDATE_RANGE_BIT,
+  invalidate_buffer = GL_MAP_INVALIDATE_BUFFER_BIT,
+  flush_explicit = GL_MAP_FLUSH_EXPLICIT_BIT,
+  unsynchronized = GL_MAP_UNSYNCHRONIZED_BIT,
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+  persistent = GL_MAP_PERSISTENT_BIT,
+  coherent = GL_MAP_COHERENT_BIT,
+#endif
+};
+
+constexpr inline map_access operator|(map_access left,
+                                      map_access right) noexcept {
+  return static_cast<map_access>(static_cast<unsigned int>(left) |
+                                 static_cast<unsigned int>(right));
+}
+
+inline void* map_buffer_range(buffer_type type,
+                              byte_offset offset,
+                              byte_size size,
+                              map_access access) noexcept {
+  return glMapBufferRange(static_cast<enum_t>(type),
+                          offset.value,
+                          size.value,
+                          static_cast<enum_t>(access));
+}
+
+inline void flush_mapped_buffer_range(buffer_type type,
+                                      byte_offset offset,
+                                      byte_size size) noexcept {
+  glFlushMappedBufferRange(
+      static_cast<enum_t>(type), offset.value, size.value);
+}
+
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+enum class storage_flag : enum_t {
+  dynamic_storage = GL_DYNAMIC_STORAGE_BIT,
+  map_read = GL_MAP_READ_BIT,
+  map_write = GL_MAP_WRITE_BIT,
+  map_persistent = GL_MAP_PERSISTENT_BIT,
+  map_coherent = GL_MAP_COHERENT_BIT,
+  client_storage = GL_CLIENT_STORAGE_BIT,
+};
+
+constexpr inline storage_flag operator|(storage_flag left,
+                                        storage_flag right) noexcept {
+  return static_cast<storage_flag>(static_cast<unsigned int>(left) |
+                                   static_cast<unsigned int>(right));
+}
+
+inline void buffer_storage(buffer_type type,
+                           byte_size size,
+                           storage_flag flags) noexcept {
+  glBufferStorage(static_cast<enum_t>(type),
+                  size.value,
+                  nullptr,
+                  static_cast<enum_t>(flags));
+}
+#endif
+
+struct sync_id {
+  GLsync value;
+};
+
+[[nodiscard]] inline sync_id fence_sync() noexcept {
+  return sync_id{glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)};
+}
+
+inline void delete_sync(sync_id id) noexcept {
+  glDeleteSync(id.value);
+}
+
+enum class wait_result : enum_t {
+  already_signaled = GL_ALREADY_SIGNALED,
+  timeout_expired = GL_TIMEOUT_EXPIRED,
+  condition_satisfied = GL_CONDITION_SATISFIED,
+  wait_failed = GL_WAIT_FAILED,
+};
+
+inline wait_result client_wait_sync(sync_id id,
+                                    std::chrono::nanoseconds timeout,
+                                    bool flush = true) noexcept {
+  return static_cast<wait_result>(
+      glClientWaitSync(id.value,
+                       flush ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                       static_cast<uint64_t>(timeout.count())));
+}
+
 inline void scissor(x x, y y, width w, height h) noexcept {
-  glScissor(x.value, y.value, w.value, h.value);
+  const std::array<int_t, 4> v{x.value,
+                               y.value,
+                               static_cast<int_t>(w.value),
+                               static_cast<int_t>(h.value)};
+  if (detail::state_changes([&v](auto& s) { return s.scissor.set(v); })) {
+    glScissor(x.value, y.value, w.value, h.value);
+  }
+}
+
+struct framebuffer_id {
+  unsigned int value;
+};
+
+struct renderbuffer_id {
+  unsigned int value;
+};
+
+enum class framebuffer_target : enum_t {
+  framebuffer = GL_FRAMEBUFFER,
+  draw = GL_DRAW_FRAMEBUFFER,
+  read = GL_READ_FRAMEBUFFER,
+};
+
+enum class framebuffer_attachment : enum_t {
+  color_0 = GL_COLOR_ATTACHMENT0,
+  color_1 = GL_COLOR_ATTACHMENT1,
+  color_2 = GL_COLOR_ATTACHMENT2,
+  color_3 = GL_COLOR_ATTACHMENT3,
+  depth = GL_DEPTH_ATTACHMENT,
+  stencil = GL_STENCIL_ATTACHMENT,
+  depth_stencil = GL_DEPTH_STENCIL_ATTACHMENT,
+};
+
+enum class framebuffer_status : enum_t {
+  complete = GL_FRAMEBUFFER_COMPLETE,
+  undefined = GL_FRAMEBUFFER_UNDEFINED,
+  incomplete_attachment = GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT,
+  incomplete_missing_attachment =
+      GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT,
+  incomplete_draw_buffer = GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER,
+  incomplete_read_buffer = GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER,
+  unsupported = GL_FRAMEBUFFER_UNSUPPORTED,
+  incomplete_multisample = GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE,
+  incomplete_layer_targets = GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS,
+};
+
+[[nodiscard]] inline framebuffer_id gen_framebuffer() noexcept {
+  unsigned int id;  // NOLINT
+  glGenFramebuffers(1, &id);
+  return framebuffer_id{id};
+}
+
+inline void delete_framebuffer(const framebuffer_id& id) noexcept {
+  glDeleteFramebuffers(1,
+                       reinterpret_cast<const unsigned int*>(&id));  // NOLINT
+}
+
+inline void bind_framebuffer(framebuffer_target target,
+                             framebuffer_id id) noexcept {
+  glBindFramebuffer(static_cast<enum_t>(target), id.value);
+}
+
+inline void unbind_framebuffer(framebuffer_target target) noexcept {
+  glBindFramebuffer(static_cast<enum_t>(target), 0);
+}
+
+[[nodiscard]] inline framebuffer_status check_framebuffer_status(
+    framebuffer_target target) noexcept {
+  return static_cast<framebuffer_status>(
+      glCheckFramebufferStatus(static_cast<enum_t>(target)));
+}
+
+[[nodiscard]] inline renderbuffer_id gen_renderbuffer() noexcept {
+  unsigned int id;  // NOLINT
+  glGenRenderbuffers(1, &id);
+  return renderbuffer_id{id};
+}
+
+inline void delete_renderbuffer(const renderbuffer_id& id) noexcept {
+  glDeleteRenderbuffers(1,
+                        reinterpret_cast<const unsigned int*>(&id));  // NOLINT
+}
+
+inline void bind_renderbuffer(renderbuffer_id id) noexcept {
+  glBindRenderbuffer(GL_RENDERBUFFER, id.value);
+}
+
+inline void renderbuffer_storage(sized_internal_format format,
+                                 width w,
+                                 height h) noexcept {
+  glRenderbufferStorage(
+      GL_RENDERBUFFER, static_cast<enum_t>(format), w.value, h.value);
+}
+
+inline void framebuffer_renderbuffer(framebuffer_target target,
+                                     framebuffer_attachment attachment,
+                                     renderbuffer_id id) noexcept {
+  glFramebufferRenderbuffer(static_cast<enum_t>(target),
+                            static_cast<enum_t>(attachment),
+                            GL_RENDERBUFFER,
+                            id.value);
+}
+
+template <class T>
+inline void read_pixels(x x,
+                        y y,
+                        width w,
+                        height h,
+                        image_format format,
+                        T* data) noexcept {
+  static_assert(detail::is_valid_gl_type_v<T>,
+                "Output pointer type is incompatible with the OpenGL API");
+  glReadPixels(x.value,
+               y.value,
+               w.value,
+               h.value,
+               static_cast<enum_t>(format),
+               detail::deduce_gl_enum_v<T>,
+               data);
 }
 
 enum class error_code : enum_t {
@@ -1724,6 +2828,18 @@ struct error {
   error_t _error;
 };
 
+enum class string_name : enum_t {
+  vendor = GL_VENDOR,
+  renderer = GL_RENDERER,
+  version = GL_VERSION,
+  shading_language_version = GL_SHADING_LANGUAGE_VERSION,
+};
+
+inline const char* get_string(string_name name) noexcept {
+  return reinterpret_cast<const char*>(  // NOLINT
+      glGetString(static_cast<enum_t>(name)));
+}
+
 inline error get_error() noexcept {
   return error{static_cast<error_code>(glGetError())};
 }
@@ -1,4 +1,5 @@
 #include "opengl.hpp"
+#include "glsl_type.hpp"
 
 #include "glm/gtc/type_ptr.hpp"
 #include "glm/mat2x2.hpp"
@@ -65,4 +66,20 @@ inline void uniform(uniform_location loc, const glm::vec3& vec) noexcept {
 inline void uniform(uniform_location loc, const glm::vec4& vec) noexcept {
   glUniform4fv(loc.value, 1, glm::value_ptr(vec));
 }
-}  // namespace dpsg::gl
\ No newline at end of file
+}  // namespace dpsg::gl
+
+namespace dpsg {
+template <glm::length_t L, class T, glm::qualifier Q>
+struct glsl_type<glm::vec<L, T, Q>> {
+  using scalar_type = T;
+  constexpr static inline std::size_t rows = L;
+  constexpr static inline std::size_t columns = 1;
+};
+
+template <glm::length_t C, glm::length_t R, class T, glm::qualifier Q>
+struct glsl_type<glm::mat<C, R, T, Q>> {
+  using scalar_type = T;
+  constexpr static inline std::size_t rows = R;
+  constexpr static inline std::size_t columns = C;
+};
+}  // namespace dpsg
\ No newline at end of file
@@ -2,8 +2,17 @@
 #define GUARD_DPSG_PROGRAM_HEADER
 
 #include "opengl.hpp"
+#include "reflection.hpp"
 #include "shaders.hpp"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace dpsg {
 namespace detail {
 
@@ -37,6 +46,85 @@ struct make_bind_impl<B, U, gl::vec_t<N, T>> {
 
 }  // namespace detail
 
+struct uniform_upload_stats {
+  std::size_t issued{0};
+  std::size_t skipped{0};
+};
+
+namespace detail {
+// Last value uploaded through each uniform handle of a program, see
+// program::shadow_uniforms.
+class uniform_shadow {
+ public:
+  struct slot {
+    std::uint32_t offset{0};
+    std::uint32_t size{0};
+  };
+
+  // Handles of the same uniform with the same value size share their slot.
+  slot allocate(gl::uniform_location location, std::uint32_t size) {
+    for (const auto& e : _slots) {
+      if (e.location == location.value && e.assigned.size == size) {
+        return e.assigned;
+      }
+    }
+    // One leading byte tells whether the value is known.
+    const slot s{static_cast<std::uint32_t>(_values.size()), size};
+    _values.resize(_values.size() + size + 1, std::byte{0});
+    _slots.push_back(entry{location.value, s});
+    return s;
+  }
+
+  // Returns whether 'value' differs from the last value recorded in 's',
+  // and records it.
+  bool changed(slot s, const std::byte* value) noexcept {
+    if (!_enabled) {
+      return true;
+    }
+    std::byte* known = &_values[s.offset];
+    std::byte* last = known + 1;  // NOLINT
+    if (*known != std::byte{0} && std::memcmp(last, value, s.size) == 0) {
+      ++_stats.skipped;
+      return false;
+    }
+    std::memcpy(last, value, s.size);
+    *known = std::byte{1};
+    ++_stats.issued;
+    return true;
+  }
+
+  void enable(bool enabled) noexcept {
+    _enabled = enabled;
+    forget();
+  }
+
+  [[nodiscard]] bool enabled() const noexcept { return _enabled; }
+
+  void forget() noexcept {
+    for (const auto& e : _slots) {
+      _values[e.assigned.offset] = std::byte{0};
+    }
+  }
+
+  [[nodiscard]] const uniform_upload_stats& stats() const noexcept {
+    return _stats;
+  }
+
+  void reset_stats() noexcept { _stats = uniform_upload_stats{}; }
+
+ private:
+  struct entry {
+    gl::int_t location;
+    slot assigned;
+  };
+
+  std::vector<std::byte> _values;
+  std::vector<entry> _slots;
+  uniform_upload_stats _stats;
+  bool _enabled{false};
+};
+}  // namespace detail
+
 class program_error : public gl_error {
  public:
   explicit program_error(gl::program_id id) {
@@ -55,10 +143,15 @@ class program {
 
   program(const program&) = delete;
   program(program&& s) noexcept
-      : _id(std::exchange(s._id, gl::program_id{0})) {}
+      : _id(std::exchange(s._id, gl::program_id{0})),
+        _reflection(std::move(s._reflection)),
+        _shadow(std::move(s._shadow)) {}
   program& operator=(const program&) = delete;
+  // The previous program is handed over to 's', which deletes it.
   program& operator=(program&& s) noexcept {
-    _id = std::exchange(s._id, gl::program_id{0});
+    std::swap(_id, s._id);
+    std::swap(_reflection, s._reflection);
+    std::swap(_shadow, s._shadow);
     return *this;
   }
   ~program() noexcept { gl::delete_program(_id); }
@@ -66,49 +159,133 @@ class program {
   template <class... Args>
   [[nodiscard]] static result<program, program_error> create(
       Args&&... shaders) noexcept {
+    return link(gl::create_program(), std::forward<Args>(shaders)...);
+  }
+
+  // Same as create, for a program object the caller has already set up, e.g.
+  // with parameters that must be set before linking.
+  template <class... Args>
+  [[nodiscard]] static result<program, program_error> link(
+      gl::program_id id,
+      Args&&... shaders) noexcept {
     static_assert(std::conjunction_v<is_shader<std::decay_t<Args>>...>,
-                  "create expects a list of shaders");
-    auto _id = gl::create_program();
-    (gl::attach_shader(_id, std::forward<Args>(shaders).id()), ...);
-    gl::link_program(_id);
+                  "link expects a list of shaders");
+    (gl::attach_shader(id, std::forward<Args>(shaders).id()), ...);
+    gl::link_program(id);
+    return from_linked(id);
+  }
+
+  // Takes ownership of a program on which gl::link_program was called and
+  // checks the outcome, waiting for the link to complete if needed. The
+  // active uniforms, attributes and blocks of the program are enumerated
+  // once here, for the uniform_name overloads below.
+  [[nodiscard]] static result<program, program_error> from_linked(
+      gl::program_id id) noexcept {
     int success{};
-    glGetProgramiv(_id.value, GL_LINK_STATUS, &success);
+    glGetProgramiv(id.value, GL_LINK_STATUS, &success);
 
     if (success != GL_TRUE) {
-      return result<program, program_error>{in_place_error, _id};
+      result<program, program_error> error{in_place_error, id};
+      gl::delete_program(id);
+      return error;
     }
 
-    return result<program, program_error>{in_place_success, _id};
+    program p{id};
+    p._reflection = reflect(id);
+    return result<program, program_error>{in_place_success, std::move(p)};
+  }
+
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+  // Recreates a program from the output of binary(). Fails when the driver
+  // rejects the binary, which it may do after any driver or hardware change.
+  [[nodiscard]] static result<program, program_error> from_binary(
+      gl::binary_format format,
+      const void* data,
+      gl::size_t length) noexcept {
+    auto id = gl::create_program();
+    gl::program_binary(id, format, data, length);
+    return from_linked(id);
+  }
+
+  // Driver specific representation of the linked program. Empty if the
+  // driver can't provide one.
+  [[nodiscard]] std::vector<gl::ubyte_t> binary(
+      gl::binary_format& format) const {
+    std::vector<gl::ubyte_t> data(gl::program_binary_length(_id));
+    if (!data.empty()) {
+      data.resize(gl::get_program_binary(
+          _id, static_cast<gl::size_t>(data.size()), format, data.data()));
+    }
+    return data;
   }
+#endif
 
   void use() const noexcept { gl::use_program(_id); }
 
  private:
   template <class B, class... Ts>
   struct bind_impl {
+    constexpr static inline std::uint32_t value_size = (sizeof(Ts) + ...);
+
     template <
         class... Us,
         std::enable_if_t<
             std::conjunction_v<std::is_convertible<std::decay_t<Us>, Ts>...>,
             int> = 0>
     void bind(Us&&... args) const {
-      gl::uniform(static_cast<const B*>(this)->id(),
-                  static_cast<std::add_const_t<Ts>>(args)...);
+      const B& self = *static_cast<const B*>(this);
+      [&self](const auto&... values) {
+        if (self.changed(values...)) {
+          gl::uniform(self.id(), values...);
+        }
+      }(static_cast<std::add_const_t<Ts>>(args)...);
     }
   };
 
   template <class B>
   struct bind_impl<B, sampler2D> {
+    constexpr static inline std::uint32_t value_size = sizeof(gl::int_t);
+
     template <class T>
     void bind(T&& t, gl::texture_name name) const {
       bind(name);
       gl::active_texture(name);
       t.bind();
     }
+    // Also binds a sampler (see sampler.hpp) to the unit, overriding the
+    // parameters of the texture.
+    template <class T, class S>
+    void bind(T&& t, const S& sampler, gl::texture_name name) const {
+      bind(std::forward<T>(t), name);
+      sampler.bind(name);
+    }
+    // Binds 't' to whichever unit 'units' (see texture_units.hpp) picks, which
+    // costs nothing when it is already resident.
+    template <class T,
+              class Units,
+              class = decltype(std::declval<Units&>().bind(
+                  std::declval<const std::decay_t<T>&>()))>
+    void bind(T&& t, Units& units) const {
+      bind(units.bind(std::as_const(t)));
+    }
+    // Same, with a sampler bound to the unit picked.
+    template <class T,
+              class S,
+              class Units,
+              class = decltype(std::declval<Units&>().bind(
+                  std::declval<const std::decay_t<T>&>()))>
+    void bind(T&& t, const S& sampler, Units& units) const {
+      const auto name = units.bind(std::as_const(t));
+      bind(name);
+      sampler.bind(name);
+    }
     void bind(gl::texture_name name) const {
-      gl::uniform(static_cast<const B*>(this)->id(),
-                  static_cast<gl::int_t>(name) -
-                      static_cast<gl::int_t>(gl::texture_name::_0));
+      const B& self = *static_cast<const B*>(this);
+      const auto unit = static_cast<gl::int_t>(name) -
+                        static_cast<gl::int_t>(gl::texture_name::_0);
+      if (self.changed(unit)) {
+        gl::uniform(self.id(), unit);
+      }
     }
   };
 
@@ -117,14 +294,51 @@ class program {
   class uniform : detail::make_bind_impl<bind_impl, uniform, T>::type {
     using base = typename detail::make_bind_impl<bind_impl, uniform, T>::type;
     gl::uniform_location _id;
-    explicit uniform(gl::uniform_location i) : _id{i} {}
+    detail::uniform_shadow* _shadow;
+    detail::uniform_shadow::slot _slot;
+
+    // 'shadow' is null when shadowing is disabled, in which case no slot is
+    // allocated and every value is uploaded.
+    uniform(gl::uniform_location i, detail::uniform_shadow* shadow)
+        : _id{i},
+          _shadow{shadow},
+          _slot{shadow != nullptr ? shadow->allocate(i, base::value_size)
+                                  : detail::uniform_shadow::slot{}} {}
     friend class program;
 
+    template <class... Vs>
+    [[nodiscard]] bool changed(const Vs&... values) const noexcept {
+      if (_shadow == nullptr) {
+        return true;
+      }
+      std::array<std::byte, (sizeof(Vs) + ...)> bytes;  // NOLINT
+      std::size_t offset = 0;
+      ((std::memcpy(bytes.data() + offset, &values, sizeof(Vs)),  // NOLINT
+        offset += sizeof(Vs)),
+       ...);
+      return _shadow->changed(_slot, bytes.data());
+    }
+
    public:
     using base::bind;
     [[nodiscard]] gl::uniform_location id() const noexcept { return _id; }
   };
 
+  // Lookup in the table built at link time. Fails if the uniform isn't active
+  // or if its type doesn't match S.
+  //
+  //    using namespace dpsg::literals;
+  //    auto model = prog.uniform_location<glm::mat4>("model"_u);
+  template <class S>
+  [[nodiscard]] std::optional<uniform<S>> uniform_location(
+      uniform_name name) const noexcept {
+    const auto* info = _reflection.uniforms.find(name);
+    if (info == nullptr || !uniform_type_matches<S>(info->type)) {
+      return {};
+    }
+    return {uniform<S>{info->location, active_shadow()}};
+  }
+
   template <class S>
   [[nodiscard]] std::optional<uniform<S>> uniform_location(
       const char* name) const noexcept {
@@ -132,7 +346,16 @@ class program {
     if (!i.has_value()) {
       return {};
     }
-    return {uniform<S>{i}};
+    return {uniform<S>{i, active_shadow()}};
+  }
+
+  [[nodiscard]] std::optional<gl::attrib_location> attrib_location(
+      uniform_name name) const noexcept {
+    if (const auto* info = _reflection.attributes.find(name);
+        info != nullptr) {
+      return {info->location};
+    }
+    return {};
   }
 
   [[nodiscard]] std::optional<gl::attrib_location> attrib_location(
@@ -143,10 +366,74 @@ class program {
     return {};
   }
 
+  // Connects the uniform block 'name' to a binding point, from which it will
+  // read the buffer bound with gl::bind_buffer_base. Returns false if the
+  // program has no active block with that name.
+  bool uniform_block_binding(const char* name,
+                             gl::buffer_binding binding) const noexcept {
+    auto i = gl::get_uniform_block_index(_id, name);
+    if (!i.has_value()) {
+      return false;
+    }
+    gl::uniform_block_binding(_id, i, binding);
+    return true;
+  }
+
+  bool uniform_block_binding(uniform_name name,
+                             gl::buffer_binding binding) const noexcept {
+    const auto* i = _reflection.blocks.find(name);
+    if (i == nullptr) {
+      return false;
+    }
+    gl::uniform_block_binding(_id, *i, binding);
+    return true;
+  }
+
+  // Keeps a copy of the last value uploaded through each uniform handle of
+  // this program, and drops uploads of identical values. Only the handles
+  // looked up while shadowing is enabled are affected, so call this before
+  // querying the uniform locations. Only correct as long as every upload goes
+  // through the handles: call forget_uniforms after setting uniforms by other
+  // means. The handles must not outlive the program.
+  void shadow_uniforms(bool enabled = true) const {
+    if (!_shadow) {
+      if (!enabled) {
+        return;
+      }
+      _shadow = std::make_unique<detail::uniform_shadow>();
+    }
+    _shadow->enable(enabled);
+  }
+
+  void forget_uniforms() const noexcept {
+    if (_shadow) {
+      _shadow->forget();
+    }
+  }
+
+  // Uploads issued and skipped by the handles while shadowing was enabled.
+  [[nodiscard]] const uniform_upload_stats& uniform_stats() const noexcept {
+    constexpr static uniform_upload_stats none{};
+    return _shadow ? _shadow->stats() : none;
+  }
+
+  // Active interface of the program, empty for programs that weren't created
+  // through create, link or from_linked.
+  [[nodiscard]] const program_reflection& reflection() const noexcept {
+    return _reflection;
+  }
+
   [[nodiscard]] constexpr gl::program_id id() const { return _id; }
 
  private:
+  [[nodiscard]] detail::uniform_shadow* active_shadow() const noexcept {
+    return _shadow && _shadow->enabled() ? _shadow.get() : nullptr;
+  }
+
   gl::program_id _id;
+  program_reflection _reflection;
+  // Only allocated once shadow_uniforms is called.
+  mutable std::unique_ptr<detail::uniform_shadow> _shadow;
 };
 }  // namespace dpsg
 
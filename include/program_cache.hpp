@@ -0,0 +1,244 @@
+#ifndef GUARD_DPSG_PROGRAM_CACHE_HEADER
+#define GUARD_DPSG_PROGRAM_CACHE_HEADER
+
+#include "load_shaders.hpp"
+#include "opengl.hpp"
+#include "program.hpp"
+#include "result.hpp"
+#include "shaders.hpp"
+#include "utility.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+namespace detail {
+inline bool has_program_binary() noexcept {
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+  bool supported = false;
+#if defined(GL_VERSION_4_1)
+  supported = supported || GLAD_GL_VERSION_4_1;
+#endif
+#if defined(GL_ARB_get_program_binary)
+  supported = supported || GLAD_GL_ARB_get_program_binary;
+#endif
+  if (!supported) {
+    return false;
+  }
+  // Some drivers expose the entry points but no format at all.
+  gl::int_t formats{0};
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  return formats > 0;
+#else
+  return false;
+#endif
+}
+}  // namespace detail
+
+struct program_cache_stats {
+  std::size_t hits{0};
+  std::size_t misses{0};
+  // Binaries found on disk but refused by the driver.
+  std::size_t rejected{0};
+};
+
+// On-disk cache of linked programs, keyed by a hash of the shader sources and
+// of the driver identification strings. A hit skips compilation and linking
+// entirely. A miss, or a binary the driver refuses, compiles the program from
+// source and (re)writes the cache entry.
+//
+// Without GL 4.1 or ARB_get_program_binary, every request is a miss and
+// nothing is written.
+//
+//    program_cache cache{"shader_cache"};
+//    auto prog = cache.load(vs_filename{"a.vs"}, fs_filename{"a.fs"});
+class program_cache {
+ public:
+  explicit program_cache(std::filesystem::path directory)
+      : _directory{std::move(directory)},
+        _enabled{detail::has_program_binary()} {
+    if (_enabled) {
+      std::error_code ec;
+      std::filesystem::create_directories(_directory, ec);
+      _enabled = !ec;
+      _driver = driver_hash();
+    }
+  }
+
+  template <class T, class U>
+  [[nodiscard]] result<program, gl_error> get(const vs_source<T>& vs,
+                                              const fs_source<U>& fs) {
+    if (!_enabled) {
+      ++_stats.misses;
+      return create_program(vs, fs);
+    }
+
+    const auto path = entry_path(vs.c_str(), fs.c_str());
+    if (auto cached = read(path); cached) {
+      ++_stats.hits;
+      return result<program, gl_error>{in_place_success, std::move(*cached)};
+    }
+    ++_stats.misses;
+
+    return vertex_shader::create(vs).then([&](auto&& vshader) {
+      return fragment_shader::create(fs).then([&](auto&& fshader) {
+        auto id = gl::create_program();
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+        gl::program_binary_retrievable_hint(id);
+#endif
+        auto linked =
+            result<program, gl_error>(program::link(id, vshader, fshader));
+        if (linked.has_value()) {
+          write(path, linked.value());
+        }
+        return linked;
+      });
+    });
+  }
+
+  template <class T, class U>
+  [[nodiscard]] result<program, loading_error> load(const vs_filename<T>& vs,
+                                                    const fs_filename<U>& fs) {
+    return dpsg::load(vs).then([&](auto&& vshader_source) {
+      return dpsg::load(fs).then([&](auto&& fshader_source) {
+        return get(vshader_source, fshader_source)
+            .map_error([&](gl_error&& error) -> loading_error {
+              const std::string name =
+                  std::string{c_str(vs)} + ", " + c_str(fs);
+              return loading_error(name.c_str(),
+                                   error.error_message().c_str());
+            });
+      });
+    });
+  }
+
+  // Whether programs are actually cached on this context.
+  [[nodiscard]] bool enabled() const noexcept { return _enabled; }
+
+  [[nodiscard]] const program_cache_stats& stats() const noexcept {
+    return _stats;
+  }
+
+  [[nodiscard]] const std::filesystem::path& directory() const noexcept {
+    return _directory;
+  }
+
+ private:
+  // Entry layout: magic, binary format, binary length, binary.
+  constexpr static inline std::uint32_t magic = 0x47525044;  // "DPRG"
+
+  static std::uint64_t driver_hash() noexcept {
+    std::uint64_t hash = fnv1a("");
+    for (auto name : {gl::string_name::vendor,
+                      gl::string_name::renderer,
+                      gl::string_name::version}) {
+      const char* str = gl::get_string(name);
+      hash = fnv1a(str == nullptr ? "" : str, hash);
+      hash = fnv1a(std::string_view{"", 1}, hash);
+    }
+    return hash;
+  }
+
+  [[nodiscard]] std::filesystem::path entry_path(const char* vs,
+                                                 const char* fs) const {
+    // The separators keep "ab" + "c" and "a" + "bc" apart.
+    std::uint64_t hash = fnv1a(vs, _driver);
+    hash = fnv1a(std::string_view{"", 1}, hash);
+    hash = fnv1a(fs, hash);
+
+    char name[21];  // NOLINT
+    std::snprintf(static_cast<char*>(name),
+                  sizeof(name),
+                  "%016llx.bin",
+                  static_cast<unsigned long long>(hash));  // NOLINT
+    return _directory / static_cast<const char*>(name);
+  }
+
+  std::optional<program> read(const std::filesystem::path& path) {
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+    std::ifstream file{path, std::ios::binary};
+    if (!file.is_open()) {
+      return std::nullopt;
+    }
+    std::uint32_t header[3]{};  // NOLINT
+    if (!file.read(reinterpret_cast<char*>(header),  // NOLINT
+                   sizeof(header)) ||
+        header[0] != magic) {
+      return std::nullopt;
+    }
+    // The length comes from the file, so check it against what the file
+    // actually holds before allocating anything.
+    const auto start = file.tellg();
+    file.seekg(0, std::ios::end);
+    const auto remaining = file.tellg() - start;
+    file.seekg(start);
+    if (!file || remaining != static_cast<std::streamoff>(header[2])) {
+      return std::nullopt;
+    }
+    std::vector<char> data(header[2]);
+    if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+      return std::nullopt;
+    }
+
+    auto p = program::from_binary(gl::binary_format{header[1]},
+                                  data.data(),
+                                  static_cast<gl::size_t>(data.size()));
+    if (!p.has_value()) {
+      ++_stats.rejected;
+      return std::nullopt;
+    }
+    return std::move(p).value();
+#else
+    (void)path;
+    return std::nullopt;
+#endif
+  }
+
+  // Failing to write only costs a recompilation next time, so errors are
+  // ignored. The entry is written to a temporary file first so that a crash
+  // never leaves a truncated entry behind.
+  static void write([[maybe_unused]] const std::filesystem::path& path,
+                    [[maybe_unused]] const program& p) {
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+    gl::binary_format format{0};
+    const auto data = p.binary(format);
+    if (data.empty()) {
+      return;
+    }
+
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+      std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+      const std::uint32_t header[3]{
+          magic, format.value, static_cast<std::uint32_t>(data.size())};
+      file.write(reinterpret_cast<const char*>(header),  // NOLINT
+                 sizeof(header));
+      file.write(reinterpret_cast<const char*>(data.data()),  // NOLINT
+                 static_cast<std::streamsize>(data.size()));
+      if (!file) {
+        return;
+      }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+#endif
+  }
+
+  std::filesystem::path _directory;
+  bool _enabled;
+  std::uint64_t _driver{0};
+  program_cache_stats _stats;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_PROGRAM_CACHE_HEADER
\ No newline at end of file
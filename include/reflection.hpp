@@ -0,0 +1,393 @@
+#ifndef GUARD_DPSG_REFLECTION_HEADER
+#define GUARD_DPSG_REFLECTION_HEADER
+
+#include "glsl_type.hpp"
+#include "opengl.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+struct sampler2D;
+
+// Hash of the name of a uniform, attribute or uniform block, computed at
+// compile time with "name"_u.
+struct uniform_name {
+  std::uint64_t hash;
+};
+
+namespace literals {
+constexpr uniform_name operator""_u(const char* name,
+                                    std::size_t length) noexcept {
+  return uniform_name{fnv1a(std::string_view{name, length})};
+}
+}  // namespace literals
+
+// Immutable hash table from names to T. The table is built with hash and
+// displace: keys are spread in buckets, and each bucket gets a seed placing
+// all of its keys in free slots, so that every lookup is a single probe.
+template <class T>
+class name_table {
+ public:
+  name_table() noexcept = default;
+
+  explicit name_table(std::vector<std::pair<uniform_name, T>> entries) {
+    std::sort(entries.begin(), entries.end(), [](const auto& l, const auto& r) {
+      return l.first.hash < r.first.hash;
+    });
+    entries.erase(std::unique(entries.begin(),
+                              entries.end(),
+                              [](const auto& l, const auto& r) {
+                                return l.first.hash == r.first.hash;
+                              }),
+                  entries.end());
+    if (entries.empty()) {
+      return;
+    }
+
+    std::size_t capacity = 1;
+    while (capacity < entries.size()) {
+      capacity *= 2;
+    }
+    while (!build(entries, capacity)) {
+      capacity *= 2;
+    }
+  }
+
+  [[nodiscard]] const T* find(uniform_name name) const noexcept {
+    if (_slots.empty()) {
+      return nullptr;
+    }
+    const std::uint64_t h = mix(name.hash);
+    const auto& s = _slots[slot(h, _seeds[bucket(h)])];
+    return s.used && s.hash == name.hash ? &s.value : nullptr;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+ private:
+  struct entry {
+    std::uint64_t hash{0};
+    bool used{false};
+    T value{};
+  };
+
+  // Largest seed tried for a bucket before growing the table.
+  constexpr static inline std::uint32_t max_seed = 1024;
+
+  // splitmix64 finalizer.
+  static std::uint64_t mix(std::uint64_t h) noexcept {
+    h ^= h >> 30U;
+    h *= 0xbf58476d1ce4e5b9;
+    h ^= h >> 27U;
+    h *= 0x94d049bb133111eb;
+    h ^= h >> 31U;
+    return h;
+  }
+
+  [[nodiscard]] std::size_t bucket(std::uint64_t h) const noexcept {
+    return static_cast<std::size_t>(h >> 32U) & (_seeds.size() - 1);
+  }
+
+  [[nodiscard]] std::size_t slot(std::uint64_t h,
+                                 std::uint32_t seed) const noexcept {
+    return static_cast<std::size_t>(mix(h + seed)) & (_slots.size() - 1);
+  }
+
+  bool build(const std::vector<std::pair<uniform_name, T>>& entries,
+             std::size_t capacity) {
+    _slots.assign(capacity, entry{});
+    _seeds.assign(std::max<std::size_t>(capacity / 4, 1), 0);
+    _size = entries.size();
+
+    std::vector<std::vector<std::size_t>> buckets(_seeds.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      buckets[bucket(mix(entries[i].first.hash))].push_back(i);
+    }
+    std::vector<std::size_t> order(buckets.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    // Biggest buckets first, while there is still room.
+    std::stable_sort(order.begin(), order.end(), [&](auto l, auto r) {
+      return buckets[l].size() > buckets[r].size();
+    });
+
+    std::vector<std::size_t> placed;
+    for (std::size_t b : order) {
+      const auto& keys = buckets[b];
+      if (keys.empty()) {
+        break;
+      }
+      std::uint32_t seed = 0;
+      for (; seed < max_seed; ++seed) {
+        placed.clear();
+        for (std::size_t k : keys) {
+          const std::size_t s = slot(mix(entries[k].first.hash), seed);
+          if (_slots[s].used ||
+              std::find(placed.begin(), placed.end(), s) != placed.end()) {
+            break;
+          }
+          placed.push_back(s);
+        }
+        if (placed.size() == keys.size()) {
+          break;
+        }
+      }
+      if (seed == max_seed) {
+        return false;
+      }
+      _seeds[b] = seed;
+      for (std::size_t i = 0; i < keys.size(); ++i) {
+        _slots[placed[i]] =
+            entry{entries[keys[i]].first.hash, true, entries[keys[i]].second};
+      }
+    }
+    return true;
+  }
+
+  std::vector<entry> _slots;
+  std::vector<std::uint32_t> _seeds;
+  std::size_t _size{0};
+};
+
+struct uniform_info {
+  gl::uniform_location location{-1};
+  gl::enum_t type{0};
+  gl::int_t size{0};
+};
+
+struct attribute_info {
+  gl::attrib_location location{-1};
+  gl::enum_t type{0};
+  gl::int_t size{0};
+};
+
+// Active uniforms, attributes and uniform blocks of a linked program. Arrays
+// can be looked up both as "name[0]" and "name".
+struct program_reflection {
+  name_table<uniform_info> uniforms;
+  name_table<attribute_info> attributes;
+  name_table<gl::uniform_block_index> blocks;
+};
+
+namespace detail {
+template <class F>
+inline void for_each_active(gl::program_id id,
+                            gl::program_parameter count,
+                            gl::program_parameter max_length,
+                            F&& f) {
+  const gl::int_t n = gl::get_program(id, count);
+  std::string name(
+      static_cast<std::size_t>(std::max(gl::get_program(id, max_length), 1)),
+      '\0');
+  for (gl::int_t i = 0; i < n; ++i) {
+    f(static_cast<gl::uint_t>(i), name);
+  }
+}
+
+// Registers 'name' and, for arrays, the name without the "[0]" suffix.
+template <class T>
+inline void add_names(std::vector<std::pair<uniform_name, T>>& out,
+                      std::string_view name,
+                      const T& value) {
+  out.emplace_back(uniform_name{fnv1a(name)}, value);
+  constexpr std::string_view suffix = "[0]";
+  if (name.size() > suffix.size() &&
+      name.substr(name.size() - suffix.size()) == suffix) {
+    out.emplace_back(
+        uniform_name{fnv1a(name.substr(0, name.size() - suffix.size()))},
+        value);
+  }
+}
+}  // namespace detail
+
+inline program_reflection reflect(gl::program_id id) {
+  using gl::program_parameter;
+  std::vector<std::pair<uniform_name, uniform_info>> uniforms;
+  detail::for_each_active(
+      id,
+      program_parameter::active_uniforms,
+      program_parameter::active_uniform_max_length,
+      [&](gl::uint_t i, std::string& buffer) {
+        const auto v = gl::get_active_uniform(
+            id, i, static_cast<gl::size_t>(buffer.size()), buffer.data());
+        // Members of uniform blocks have no location.
+        const auto location = gl::get_uniform_location(id, buffer.c_str());
+        if (location.has_value()) {
+          detail::add_names(
+              uniforms,
+              std::string_view{buffer.data(),
+                               static_cast<std::size_t>(v.name_length)},
+              uniform_info{location, v.type, v.size});
+        }
+      });
+
+  std::vector<std::pair<uniform_name, attribute_info>> attributes;
+  detail::for_each_active(
+      id,
+      program_parameter::active_attributes,
+      program_parameter::active_attribute_max_length,
+      [&](gl::uint_t i, std::string& buffer) {
+        const auto v = gl::get_active_attrib(
+            id, i, static_cast<gl::size_t>(buffer.size()), buffer.data());
+        detail::add_names(
+            attributes,
+            std::string_view{buffer.data(),
+                             static_cast<std::size_t>(v.name_length)},
+            attribute_info{gl::get_attrib_location(id, buffer.c_str()),
+                           v.type,
+                           v.size});
+      });
+
+  std::vector<std::pair<uniform_name, gl::uniform_block_index>> blocks;
+  detail::for_each_active(
+      id,
+      program_parameter::active_uniform_blocks,
+      program_parameter::active_uniform_block_max_name_length,
+      [&](gl::uint_t i, std::string& buffer) {
+        const gl::uniform_block_index index{i};
+        const auto length = gl::get_active_uniform_block_name(
+            id, index, static_cast<gl::size_t>(buffer.size()), buffer.data());
+        blocks.emplace_back(
+            uniform_name{fnv1a(std::string_view{
+                buffer.data(), static_cast<std::size_t>(length)})},
+            index);
+      });
+
+  return program_reflection{name_table<uniform_info>{std::move(uniforms)},
+                            name_table<attribute_info>{std::move(attributes)},
+                            name_table<gl::uniform_block_index>{
+                                std::move(blocks)}};
+}
+
+namespace detail {
+// GL type reported by the reflection for a uniform<T>, 0 when unknown.
+template <class T, class = void>
+struct uniform_gl_type : std::integral_constant<gl::enum_t, 0> {};
+
+constexpr gl::enum_t gl_type_of(gl::enum_t scalar,
+                                std::size_t rows,
+                                std::size_t columns) noexcept {
+  constexpr gl::enum_t floats[3][3] = {
+      {GL_FLOAT_MAT2, GL_FLOAT_MAT2x3, GL_FLOAT_MAT2x4},
+      {GL_FLOAT_MAT3x2, GL_FLOAT_MAT3, GL_FLOAT_MAT3x4},
+      {GL_FLOAT_MAT4x2, GL_FLOAT_MAT4x3, GL_FLOAT_MAT4}};
+  constexpr gl::enum_t vectors[3][4] = {
+      {GL_FLOAT, GL_FLOAT_VEC2, GL_FLOAT_VEC3, GL_FLOAT_VEC4},
+      {GL_INT, GL_INT_VEC2, GL_INT_VEC3, GL_INT_VEC4},
+      {GL_UNSIGNED_INT,
+       GL_UNSIGNED_INT_VEC2,
+       GL_UNSIGNED_INT_VEC3,
+       GL_UNSIGNED_INT_VEC4}};
+  if (rows < 1 || rows > 4 || columns < 1 || columns > 4) {
+    return 0;
+  }
+  if (columns > 1) {
+    return scalar == GL_FLOAT && rows > 1 ? floats[columns - 2][rows - 2] : 0;
+  }
+  switch (scalar) {
+    case GL_FLOAT:
+      return vectors[0][rows - 1];
+    case GL_INT:
+      return vectors[1][rows - 1];
+    case GL_UNSIGNED_INT:
+      return vectors[2][rows - 1];
+    default:
+      return 0;
+  }
+}
+
+template <class T>
+struct uniform_gl_type<T, std::void_t<decltype(glsl_type<T>::rows)>>
+    : std::integral_constant<
+          gl::enum_t,
+          gl_type_of(gl::detail::deduce_gl_enum_v<
+                         typename glsl_type<T>::scalar_type>,
+                     glsl_type<T>::rows,
+                     glsl_type<T>::columns)> {};
+
+template <std::size_t N, class T>
+struct uniform_gl_type<gl::vec_t<N, T>>
+    : std::integral_constant<
+          gl::enum_t,
+          gl_type_of(gl::detail::deduce_gl_enum_v<T>, N, 1)> {};
+
+template <>
+struct uniform_gl_type<sampler2D>
+    : std::integral_constant<gl::enum_t, GL_SAMPLER_2D> {};
+
+// Booleans and samplers are set through integer uniforms.
+constexpr bool accepts_integer(gl::enum_t type) noexcept {
+  switch (type) {
+    case GL_INT:
+    case GL_BOOL:
+    case GL_SAMPLER_1D:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_1D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_1D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE:
+    case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_BUFFER:
+    case GL_SAMPLER_2D_RECT:
+    case GL_SAMPLER_2D_RECT_SHADOW:
+    case GL_INT_SAMPLER_1D:
+    case GL_INT_SAMPLER_2D:
+    case GL_INT_SAMPLER_3D:
+    case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY:
+    case GL_INT_SAMPLER_2D_ARRAY:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_INT_SAMPLER_BUFFER:
+    case GL_INT_SAMPLER_2D_RECT:
+    case GL_UNSIGNED_INT_SAMPLER_1D:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_3D:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE:
+    case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+    case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+      return true;
+    default:
+      return false;
+  }
+}
+}  // namespace detail
+
+// Whether a uniform<T> may be bound to a uniform of the given reflected type.
+// Types the reflection doesn't know about are always accepted.
+template <class T>
+constexpr bool uniform_type_matches(gl::enum_t type) noexcept {
+  constexpr gl::enum_t expected = detail::uniform_gl_type<T>::value;
+  if constexpr (expected == 0) {
+    return true;
+  }
+  else if constexpr (expected == GL_INT) {
+    return detail::accepts_integer(type);
+  }
+  else {
+    return type == expected;
+  }
+}
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_REFLECTION_HEADER
\ No newline at end of file
@@ -0,0 +1,243 @@
+#ifndef GUARD_DPSG_SAMPLER_HEADER
+#define GUARD_DPSG_SAMPLER_HEADER
+
+#include "opengl.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace dpsg {
+
+// Every parameter of a sampler object. The defaults are those of the GL.
+struct sampler_state {
+  gl::wrap_mode wrap_s{gl::wrap_mode::repeat};
+  gl::wrap_mode wrap_t{gl::wrap_mode::repeat};
+  gl::wrap_mode wrap_r{gl::wrap_mode::repeat};
+  gl::min_filter min{gl::min_filter::nearest_mipmap_linear};
+  gl::mag_filter mag{gl::mag_filter::linear};
+  float min_lod{-1000.F};  // NOLINT
+  float max_lod{1000.F};   // NOLINT
+  float lod_bias{0.F};
+  // 1 disables anisotropic filtering. Ignored when the context doesn't
+  // support it.
+  float max_anisotropy{1.F};
+  gl::compare_mode compare{gl::compare_mode::none};
+  gl::compare_function compare_function{gl::compare_function::lequal};
+  std::array<float, 4> border_color{};
+
+  friend bool operator==(const sampler_state& lhs,
+                         const sampler_state& rhs) noexcept {
+    return lhs.wrap_s == rhs.wrap_s && lhs.wrap_t == rhs.wrap_t &&
+           lhs.wrap_r == rhs.wrap_r && lhs.min == rhs.min &&
+           lhs.mag == rhs.mag && lhs.min_lod == rhs.min_lod &&
+           lhs.max_lod == rhs.max_lod && lhs.lod_bias == rhs.lod_bias &&
+           lhs.max_anisotropy == rhs.max_anisotropy &&
+           lhs.compare == rhs.compare &&
+           lhs.compare_function == rhs.compare_function &&
+           lhs.border_color == rhs.border_color;
+  }
+
+  friend bool operator!=(const sampler_state& lhs,
+                         const sampler_state& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+};
+
+// Sampler counterparts of texture_options.
+namespace sampler_states {
+constexpr static inline sampler_state repeat_linear{
+    gl::wrap_mode::repeat,
+    gl::wrap_mode::repeat,
+    gl::wrap_mode::repeat,
+    gl::min_filter::linear,
+    gl::mag_filter::linear};
+
+constexpr static inline sampler_state repeat_trilinear{
+    gl::wrap_mode::repeat,
+    gl::wrap_mode::repeat,
+    gl::wrap_mode::repeat,
+    gl::min_filter::linear_mipmap_linear,
+    gl::mag_filter::linear};
+
+constexpr static inline sampler_state clamp_linear{
+    gl::wrap_mode::clamp_to_edge,
+    gl::wrap_mode::clamp_to_edge,
+    gl::wrap_mode::clamp_to_edge,
+    gl::min_filter::linear,
+    gl::mag_filter::linear};
+
+constexpr static inline sampler_state clamp_nearest{
+    gl::wrap_mode::clamp_to_edge,
+    gl::wrap_mode::clamp_to_edge,
+    gl::wrap_mode::clamp_to_edge,
+    gl::min_filter::nearest,
+    gl::mag_filter::nearest};
+}  // namespace sampler_states
+
+struct sampler_state_hash {
+  std::size_t operator()(const sampler_state& state) const noexcept {
+    std::size_t hash = 0;
+    const auto combine = [&hash](auto value) {
+      // boost::hash_combine
+      hash ^= std::hash<decltype(value)>{}(value) + 0x9e3779b9 +  // NOLINT
+              (hash << 6U) + (hash >> 2U);                        // NOLINT
+    };
+    combine(static_cast<gl::enum_t>(state.wrap_s));
+    combine(static_cast<gl::enum_t>(state.wrap_t));
+    combine(static_cast<gl::enum_t>(state.wrap_r));
+    combine(static_cast<gl::enum_t>(state.min));
+    combine(static_cast<gl::enum_t>(state.mag));
+    combine(state.min_lod);
+    combine(state.max_lod);
+    combine(state.lod_bias);
+    combine(state.max_anisotropy);
+    combine(static_cast<gl::enum_t>(state.compare));
+    combine(static_cast<gl::enum_t>(state.compare_function));
+    for (float c : state.border_color) {
+      combine(c);
+    }
+    return hash;
+  }
+};
+
+// Owns a sampler object. Bound to a texture unit, it overrides the filtering
+// and wrapping parameters of whatever texture is bound there, so textures
+// can be shared between differently sampled uses.
+class sampler {
+ public:
+  explicit sampler(const sampler_state& state) noexcept
+      : _id{gl::gen_sampler()} {
+    apply(state);
+  }
+  sampler(const sampler&) = delete;
+  sampler(sampler&& other) noexcept
+      : _id{std::exchange(other._id, gl::sampler_id{0})} {}
+  sampler& operator=(const sampler&) = delete;
+  sampler& operator=(sampler&& other) noexcept {
+    std::swap(_id, other._id);
+    return *this;
+  }
+  ~sampler() noexcept {
+    if (_id.value != 0) {
+      gl::delete_sampler(_id);
+    }
+  }
+
+  // Replaces every parameter. Units the sampler is bound to see the change
+  // on their next use.
+  void apply(const sampler_state& state) const noexcept {
+    gl::sampler_parameter(_id, gl::wrap_target::s, state.wrap_s);
+    gl::sampler_parameter(_id, gl::wrap_target::t, state.wrap_t);
+    gl::sampler_parameter(_id, gl::wrap_target::r, state.wrap_r);
+    gl::sampler_parameter(_id, state.min);
+    gl::sampler_parameter(_id, state.mag);
+    gl::sampler_parameter(_id, gl::lod_parameter::min, state.min_lod);
+    gl::sampler_parameter(_id, gl::lod_parameter::max, state.max_lod);
+    gl::sampler_parameter(_id, gl::lod_parameter::bias, state.lod_bias);
+    gl::sampler_parameter(_id, state.compare);
+    gl::sampler_parameter(_id, state.compare_function);
+    float border[4];  // NOLINT
+    std::copy(state.border_color.begin(), state.border_color.end(), border);
+    gl::sampler_parameter(_id, border);
+#if defined(GL_VERSION_4_6) || defined(GL_EXT_texture_filter_anisotropic)
+    if (gl::has_anisotropic_filtering()) {
+      gl::sampler_parameter(_id, gl::max_anisotropy{state.max_anisotropy});
+    }
+#endif
+  }
+
+  void bind(gl::texture_name unit) const noexcept {
+    gl::bind_sampler(unit, _id);
+  }
+
+  [[nodiscard]] gl::sampler_id id() const noexcept { return _id; }
+
+ private:
+  gl::sampler_id _id;
+};
+
+// Settings applied on top of every state of a sampler_cache, typically from
+// the graphics options of the application.
+struct sampler_quality {
+  // Upper bound of the anisotropy of every sampler.
+  float max_anisotropy{16.F};  // NOLINT
+  // Whether trilinear filtering is downgraded to bilinear, blending two
+  // mipmap levels no longer.
+  bool bilinear{false};
+  // Added to the LOD bias of every sampler. Positive values select smaller
+  // levels, which is blurrier but cheaper.
+  float lod_bias{0.F};
+};
+
+// Creates one sampler object per distinct sampler_state, shared by every
+// texture sampled that way, and binds them to texture units.
+//
+// Changing the quality settings re-applies the states of the existing
+// samplers, which costs one set of parameters per distinct state rather than
+// one per texture.
+//
+//    sampler_cache samplers;
+//    samplers.bind(gl::texture_name::_0, sampler_states::repeat_trilinear);
+//    ...
+//    samplers.set_quality(sampler_quality{4.F, true});
+class sampler_cache {
+ public:
+  sampler_cache() = default;
+  explicit sampler_cache(const sampler_quality& quality) noexcept
+      : _quality{quality} {}
+
+  // The sampler for 'state', created on first use. References stay valid
+  // as long as the cache.
+  const sampler& get(const sampler_state& state) {
+    auto it = _samplers.find(state);
+    if (it == _samplers.end()) {
+      it = _samplers.emplace(state, sampler{adjust(state)}).first;
+    }
+    return it->second;
+  }
+
+  void bind(gl::texture_name unit, const sampler_state& state) {
+    get(state).bind(unit);
+  }
+
+  void set_quality(const sampler_quality& quality) noexcept {
+    _quality = quality;
+    for (const auto& [state, s] : _samplers) {
+      s.apply(adjust(state));
+    }
+  }
+
+  [[nodiscard]] const sampler_quality& quality() const noexcept {
+    return _quality;
+  }
+
+  // Number of distinct states, hence of sampler objects.
+  [[nodiscard]] std::size_t size() const noexcept { return _samplers.size(); }
+
+ private:
+  [[nodiscard]] sampler_state adjust(sampler_state state) const noexcept {
+    state.max_anisotropy =
+        std::min(state.max_anisotropy, std::max(_quality.max_anisotropy, 1.F));
+    state.lod_bias += _quality.lod_bias;
+    if (_quality.bilinear) {
+      if (state.min == gl::min_filter::linear_mipmap_linear) {
+        state.min = gl::min_filter::linear_mipmap_nearest;
+      }
+      else if (state.min == gl::min_filter::nearest_mipmap_linear) {
+        state.min = gl::min_filter::nearest_mipmap_nearest;
+      }
+    }
+    return state;
+  }
+
+  sampler_quality _quality;
+  std::unordered_map<sampler_state, sampler, sampler_state_hash> _samplers;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_SAMPLER_HEADER
\ No newline at end of file
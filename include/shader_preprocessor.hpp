@@ -0,0 +1,429 @@
+#ifndef GUARD_DPSG_SHADER_PREPROCESSOR_HEADER
+#define GUARD_DPSG_SHADER_PREPROCESSOR_HEADER
+
+#include "loading_error.hpp"
+#include "mapped_file.hpp"
+#include "result.hpp"
+#include "utility.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+// Shader source with every #include expanded.
+struct preprocessed_shader {
+  std::string source;
+  // Combination of the content hashes of every file that went into 'source',
+  // in inclusion order.
+  std::uint64_t hash;
+  // Files that went into 'source'. The index of a file is the source string
+  // number used in the #line directives, and thus the number the driver
+  // reports in its error messages.
+  std::vector<std::filesystem::path> files;
+};
+
+namespace detail {
+constexpr std::string_view trim_left(std::string_view str) noexcept {
+  const auto first = str.find_first_not_of(" \t");
+  return first == std::string_view::npos ? std::string_view{}
+                                         : str.substr(first);
+}
+
+// Token following a '#' at the start of the line, or an empty view.
+constexpr std::string_view directive(std::string_view line) noexcept {
+  line = trim_left(line);
+  if (line.empty() || line.front() != '#') {
+    return {};
+  }
+  line = trim_left(line.substr(1));
+  const auto end = line.find_first_of(" \t\"<");
+  return line.substr(0, end);
+}
+
+// Argument of an '#include "file"' directive.
+constexpr std::optional<std::string_view> include_argument(
+    std::string_view line) noexcept {
+  if (directive(line) != "include") {
+    return std::nullopt;
+  }
+  line = trim_left(line);
+  line = trim_left(trim_left(line.substr(1)).substr(7));  // NOLINT
+  if (line.empty() || line.front() != '"') {
+    return std::nullopt;
+  }
+  const auto close = line.find('"', 1);
+  if (close == std::string_view::npos) {
+    return std::nullopt;
+  }
+  return line.substr(1, close - 1);
+}
+
+// Calls f(line, line_number) for every line of 'text', without the line
+// terminators. Line numbers start at 1.
+template <class F>
+void for_each_line(std::string_view text, F&& f) {
+  std::size_t number = 1;
+  while (!text.empty()) {
+    auto end = text.find('\n');
+    auto line = text.substr(0, end);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    f(line, number++);
+    if (end == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(end + 1);
+  }
+}
+// Content of a file being expanded, and its hash.
+struct source_text {
+  std::string_view content;
+  std::uint64_t hash;
+};
+
+struct include_expansion {
+  std::string out;
+  std::uint64_t hash{fnv1a("")};
+  std::vector<std::filesystem::path> files;
+  std::unordered_set<std::string> included;
+  std::vector<std::string> stack;
+};
+
+inline void line_directive(std::string& out,
+                           std::size_t line,
+                           std::size_t file) {
+  out += "#line ";
+  out += std::to_string(line);
+  out += ' ';
+  out += std::to_string(file);
+  out += '\n';
+}
+
+// Appends 'key' to 'state.out', recursively replacing its #include
+// directives with the content of the included files. 'resolve(from, name)'
+// returns the key of the file called 'name' included by 'from', if it
+// exists, and 'open(key)' returns a result<source_text, loading_error>.
+template <class Resolve, class Open>
+std::optional<loading_error> expand_includes(const std::string& key,
+                                             include_expansion& state,
+                                             const Resolve& resolve,
+                                             const Open& open) {
+  auto opened = open(key);
+  if (!opened.has_value()) {
+    return std::move(opened).error();
+  }
+  const source_text text = opened.value();
+
+  const auto index = state.files.size();
+  state.files.emplace_back(key);
+  state.included.insert(key);
+  state.stack.push_back(key);
+  const auto* hash_bytes = reinterpret_cast<const char*>(&text.hash);  // NOLINT
+  state.hash =
+      fnv1a(std::string_view{hash_bytes, sizeof(text.hash)}, state.hash);
+  if (index != 0) {
+    line_directive(state.out, 1, index);
+  }
+
+  std::optional<loading_error> error;
+  for_each_line(text.content, [&](std::string_view line, std::size_t number) {
+    if (error) {
+      return;
+    }
+    if (index != 0 && directive(line) == "version") {
+      state.out += '\n';
+      return;
+    }
+    const auto name = include_argument(line);
+    if (!name) {
+      state.out.append(line.data(), line.size());
+      state.out += '\n';
+      return;
+    }
+
+    const std::optional<std::string> included = resolve(key, *name);
+    if (!included) {
+      const std::string message = "line " + std::to_string(number) +
+                                  ": cannot find \"" + std::string{*name} +
+                                  '"';
+      error.emplace(key.c_str(), message.c_str());
+      return;
+    }
+    for (const auto& parent : state.stack) {
+      if (parent == *included) {
+        const std::string message = "line " + std::to_string(number) +
+                                    ": recursive inclusion of \"" +
+                                    std::string{*name} + '"';
+        error.emplace(key.c_str(), message.c_str());
+        return;
+      }
+    }
+    if (state.included.count(*included) != 0) {
+      state.out += '\n';
+      return;
+    }
+    error = expand_includes(*included, state, resolve, open);
+    line_directive(state.out, number + 1, index);
+  });
+
+  state.stack.pop_back();
+  return error;
+}
+}  // namespace detail
+
+// Resolves '#include "file"' directives in GLSL sources and keeps track of
+// which file includes which, so that shared code lives in a single place and
+// only the programs depending on an edited file are rebuilt.
+//
+// Includes are looked up relative to the including file first, then in each
+// of the include directories, in order. A file included several times by the
+// same shader is only expanded the first time. '#version' directives are
+// dropped from included files, and '#line' directives are emitted around each
+// inclusion so that compiler errors point to the right file and line.
+//
+// Files are read once and kept in memory. refresh() checks modification
+// times and reports the top level files whose expansion changed.
+//
+//    include_graph graph{{"shaders/common"}};
+//    auto fs = graph.preprocess("shaders/basic_lighting.fs");
+//    ...
+//    for (const auto& file : graph.refresh()) {
+//      // 'file' or one of its includes changed, rebuild the programs using it
+//    }
+class include_graph {
+ public:
+  include_graph() = default;
+  explicit include_graph(std::vector<std::filesystem::path> include_dirs)
+      : _include_dirs{std::move(include_dirs)} {}
+
+  [[nodiscard]] result<preprocessed_shader, loading_error> preprocess(
+      const std::filesystem::path& file) {
+    auto key = normalize(file);
+    auto root = node_for(key);
+    if (!root.has_value()) {
+      return failure{std::move(root).error()};
+    }
+    _roots.insert(key);
+
+    detail::include_expansion state;
+    if (auto error = expand(key, state); error) {
+      return failure{std::move(*error)};
+    }
+    return success{preprocessed_shader{std::move(state.out),
+                                       state.hash,
+                                       std::move(state.files)}};
+  }
+
+  // Rereads the files modified since they were last read, and returns the
+  // files given to preprocess() that include, directly or not, a file whose
+  // content changed. Files that can't be read anymore count as changed and
+  // are dropped from the graph, so that the next preprocess() reports them.
+  std::vector<std::filesystem::path> refresh() {
+    std::unordered_set<std::string> changed;
+    for (auto it = _nodes.begin(); it != _nodes.end();) {
+      auto& [key, n] = *it;
+      std::error_code ec;
+      const auto time = std::filesystem::last_write_time(key, ec);
+      if (!ec && time == n.write_time) {
+        ++it;
+        continue;
+      }
+      std::optional<node> reloaded;
+      if (!ec) {
+        auto r = read(key);
+        if (r.has_value()) {
+          reloaded = std::move(r).value();
+        }
+      }
+      if (!reloaded.has_value()) {
+        changed.insert(key);
+        it = _nodes.erase(it);
+        continue;
+      }
+      if (reloaded->hash != n.hash) {
+        changed.insert(key);
+      }
+      n = std::move(*reloaded);
+      ++it;
+    }
+
+    std::vector<std::filesystem::path> stale;
+    if (changed.empty()) {
+      return stale;
+    }
+    for (const auto& root : _roots) {
+      std::unordered_set<std::string> visited;
+      if (depends_on(root, changed, visited)) {
+        stale.emplace_back(root);
+      }
+    }
+    return stale;
+  }
+
+  // Files given to preprocess() that include 'file', directly or not. A file
+  // given to preprocess() depends on itself.
+  [[nodiscard]] std::vector<std::filesystem::path> dependents(
+      const std::filesystem::path& file) const {
+    const std::unordered_set<std::string> target{normalize(file)};
+    std::vector<std::filesystem::path> result;
+    for (const auto& root : _roots) {
+      std::unordered_set<std::string> visited;
+      if (depends_on(root, target, visited)) {
+        result.emplace_back(root);
+      }
+    }
+    return result;
+  }
+
+  // Hash of the content of 'file' as last read, if it is part of the graph.
+  [[nodiscard]] std::optional<std::uint64_t> hash(
+      const std::filesystem::path& file) const {
+    const auto it = _nodes.find(normalize(file));
+    if (it == _nodes.end()) {
+      return std::nullopt;
+    }
+    return it->second.hash;
+  }
+
+  // Name under which 'file' is known to the graph, and reported by refresh()
+  // and dependents().
+  static std::string normalize(const std::filesystem::path& file) {
+    std::error_code ec;
+    auto canonical = std::filesystem::weakly_canonical(file, ec);
+    return (ec ? file.lexically_normal() : canonical).string();
+  }
+
+  // Every file read so far, top level or included.
+  [[nodiscard]] std::vector<std::filesystem::path> files() const {
+    std::vector<std::filesystem::path> result;
+    result.reserve(_nodes.size());
+    for (const auto& [key, n] : _nodes) {
+      result.emplace_back(key);
+    }
+    return result;
+  }
+
+  [[nodiscard]] const std::vector<std::filesystem::path>& include_dirs()
+      const noexcept {
+    return _include_dirs;
+  }
+
+ private:
+  struct node {
+    std::string content;
+    std::uint64_t hash;
+    std::filesystem::file_time_type write_time;
+    // Direct includes, resolved.
+    std::vector<std::string> includes;
+  };
+
+  [[nodiscard]] std::optional<std::string> resolve(
+      const std::string& from,
+      std::string_view name) const {
+    const std::filesystem::path relative{name};
+    auto candidate = std::filesystem::path{from}.parent_path() / relative;
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(candidate, ec)) {
+      return normalize(candidate);
+    }
+    for (const auto& dir : _include_dirs) {
+      candidate = dir / relative;
+      if (std::filesystem::is_regular_file(candidate, ec)) {
+        return normalize(candidate);
+      }
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] result<node, loading_error> read(const std::string& key) const {
+    std::error_code ec;
+    const auto time = std::filesystem::last_write_time(key, ec);
+    auto file = mapped_file::open(key.c_str());
+    if (!file.has_value()) {
+      return failure{std::move(file).error()};
+    }
+
+    // Copied once, straight from the mapping. The mapping itself isn't
+    // kept, so that the file isn't locked while the graph lives.
+    node n{std::string{file.value().view()}, 0, time, {}};
+    n.hash = fnv1a(n.content);
+    detail::for_each_line(n.content, [&](std::string_view line, std::size_t) {
+      if (auto name = detail::include_argument(line); name) {
+        if (auto resolved = resolve(key, *name); resolved) {
+          n.includes.push_back(std::move(*resolved));
+        }
+      }
+    });
+    return success{std::move(n)};
+  }
+
+  result<const node*, loading_error> node_for(const std::string& key) {
+    if (auto it = _nodes.find(key); it != _nodes.end()) {
+      return success{&it->second};
+    }
+    auto r = read(key);
+    if (!r.has_value()) {
+      return failure{std::move(r).error()};
+    }
+    auto [it, inserted] = _nodes.emplace(key, std::move(r).value());
+    return success{&it->second};
+  }
+
+  std::optional<loading_error> expand(const std::string& key,
+                                      detail::include_expansion& state) {
+    const auto resolve = [this](const std::string& from,
+                                std::string_view name) {
+      return this->resolve(from, name);
+    };
+    const auto open =
+        [this](const std::string& file) -> result<detail::source_text,
+                                                  loading_error> {
+      auto found = node_for(file);
+      if (!found.has_value()) {
+        return failure{std::move(found).error()};
+      }
+      return success{
+          detail::source_text{found.value()->content, found.value()->hash}};
+    };
+    return detail::expand_includes(key, state, resolve, open);
+  }
+
+  bool depends_on(const std::string& key,
+                  const std::unordered_set<std::string>& targets,
+                  std::unordered_set<std::string>& visited) const {
+    if (targets.count(key) != 0) {
+      return true;
+    }
+    if (!visited.insert(key).second) {
+      return false;
+    }
+    const auto it = _nodes.find(key);
+    if (it == _nodes.end()) {
+      return false;
+    }
+    for (const auto& include : it->second.includes) {
+      if (depends_on(include, targets, visited)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<std::filesystem::path> _include_dirs;
+  std::unordered_map<std::string, node> _nodes;
+  std::unordered_set<std::string> _roots;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_SHADER_PREPROCESSOR_HEADER
\ No newline at end of file
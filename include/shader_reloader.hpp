@@ -0,0 +1,359 @@
+#ifndef GUARD_DPSG_SHADER_RELOADER_HEADER
+#define GUARD_DPSG_SHADER_RELOADER_HEADER
+
+#include "c_str.hpp"
+#include "compile_queue.hpp"
+#include "load_shaders.hpp"
+#include "loading_error.hpp"
+#include "program.hpp"
+#include "result.hpp"
+#include "shader_preprocessor.hpp"
+#include "shaders.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace dpsg {
+
+namespace detail {
+// State of one program managed by a shader_reloader. The filenames are only
+// read by the watcher thread after construction, 'current', 'pending' and
+// 'generation' are only touched by the thread calling update().
+struct live_entry {
+  std::string vs;
+  std::string fs;
+  std::string vs_key;
+  std::string fs_key;
+  std::function<void(const program&)> setup;
+  program current;
+  std::optional<pending_program> pending;
+  std::size_t generation{0};
+  // Set when the last rebuild failed to read or preprocess a file, so that it
+  // is attempted again after any change.
+  bool failed{false};
+  std::string last_error;
+
+  [[nodiscard]] std::string name() const { return vs + ", " + fs; }
+};
+
+// Blocks until something happens in one of the watched directories, or until
+// 'timeout' expires. Returns true if something happened. Without inotify,
+// always sleeps for the whole timeout and returns false.
+class directory_watcher {
+ public:
+  directory_watcher() noexcept {
+#if defined(__linux__)
+    _fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+  }
+  directory_watcher(const directory_watcher&) = delete;
+  directory_watcher(directory_watcher&&) = delete;
+  directory_watcher& operator=(const directory_watcher&) = delete;
+  directory_watcher& operator=(directory_watcher&&) = delete;
+  ~directory_watcher() noexcept {
+#if defined(__linux__)
+    if (_fd >= 0) {
+      close(_fd);
+    }
+#endif
+  }
+
+  // Whether changes are notified by the system. Otherwise files have to be
+  // polled.
+  [[nodiscard]] bool notifies() const noexcept { return _fd >= 0; }
+
+  void watch([[maybe_unused]] const std::filesystem::path& directory) {
+#if defined(__linux__)
+    if (_fd < 0 || !_watched.insert(directory.string()).second) {
+      return;
+    }
+    // Editors often save by writing a temporary file and renaming it over
+    // the original, so the whole directory is watched rather than the file.
+    inotify_add_watch(_fd,
+                      directory.c_str(),
+                      IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+#endif
+  }
+
+  bool wait(std::chrono::milliseconds timeout) noexcept {
+#if defined(__linux__)
+    if (_fd >= 0) {
+      pollfd fd{_fd, POLLIN, 0};
+      if (poll(&fd, 1, static_cast<int>(timeout.count())) <= 0) {
+        return false;
+      }
+      alignas(inotify_event) char buffer[4096];  // NOLINT
+      while (read(_fd, static_cast<char*>(buffer), sizeof(buffer)) > 0) {
+      }
+      return true;
+    }
+#endif
+    std::this_thread::sleep_for(timeout);
+    return false;
+  }
+
+ private:
+  int _fd{-1};
+  std::unordered_set<std::string> _watched;
+};
+}  // namespace detail
+
+// Handle to a program that may be rebuilt by a shader_reloader. The program
+// only changes during shader_reloader::update(), so references obtained
+// between two updates stay valid until the next one.
+class live_program {
+ public:
+  [[nodiscard]] const program& operator*() const noexcept {
+    return _entry->current;
+  }
+  [[nodiscard]] const program* operator->() const noexcept {
+    return &_entry->current;
+  }
+
+  // Number of times the program was swapped. Uniform locations obtained
+  // from an older generation must be queried again.
+  [[nodiscard]] std::size_t generation() const noexcept {
+    return _entry->generation;
+  }
+
+ private:
+  friend class shader_reloader;
+  explicit live_program(std::shared_ptr<detail::live_entry> entry) noexcept
+      : _entry{std::move(entry)} {}
+
+  std::shared_ptr<detail::live_entry> _entry;
+};
+
+// Rebuilds programs when their shaders, or the files they include, are
+// edited.
+//
+// A background thread waits for changes (inotify on Linux, polling
+// elsewhere) and, once no change has been seen for 'debounce', rereads the
+// modified files and preprocesses the affected shaders. Compilation needs the
+// GL context, so it is started by update(), which must be called on the
+// rendering thread, typically once per frame. Programs are compiled through
+// a compile_queue and only swapped in once the driver reports them ready, so
+// a rebuild doesn't stall the frame when KHR_parallel_shader_compile is
+// available. If a rebuild fails, the previous program stays in use and the
+// error is returned by update().
+//
+// Like compile_queue, it must be created on the rendering thread once the
+// context is current.
+//
+//    shader_reloader reloader;
+//    auto prog = reloader.load(vs_filename{"shaders/basic_projection.vs"},
+//                              fs_filename{"shaders/uniform.fs"})
+//                    .value();
+//    while (!window.should_close()) {
+//      for (const auto& error : reloader.update()) {
+//        std::cerr << error.what() << std::endl;
+//      }
+//      prog->use();
+//      ...
+//    }
+class shader_reloader {
+ public:
+  explicit shader_reloader(
+      std::chrono::milliseconds debounce = std::chrono::milliseconds{100},
+      std::vector<std::filesystem::path> include_dirs = {})
+      : _debounce{debounce}, _graph{std::move(include_dirs)} {
+    _watcher = std::thread{[this] { watch(); }};
+  }
+  shader_reloader(const shader_reloader&) = delete;
+  shader_reloader(shader_reloader&&) = delete;
+  shader_reloader& operator=(const shader_reloader&) = delete;
+  shader_reloader& operator=(shader_reloader&&) = delete;
+  ~shader_reloader() noexcept {
+    _stop = true;
+    _watcher.join();
+  }
+
+  // Loads a program and keeps it up to date. 'setup' is called with the
+  // program now and after each swap, to restore state that doesn't survive
+  // relinking, such as uniform block bindings.
+  template <class T, class U>
+  [[nodiscard]] result<live_program, loading_error> load(
+      const vs_filename<T>& vs,
+      const fs_filename<U>& fs,
+      std::function<void(const program&)> setup = {}) {
+    std::lock_guard lock{_mutex};
+    auto loaded = dpsg::load(_graph, vs, fs);
+    watch_graph();
+    if (!loaded.has_value()) {
+      return failure{std::move(loaded).error()};
+    }
+
+    auto entry = std::make_shared<detail::live_entry>(detail::live_entry{
+        c_str(vs),
+        c_str(fs),
+        include_graph::normalize(c_str(vs)),
+        include_graph::normalize(c_str(fs)),
+        std::move(setup),
+        std::move(loaded).value(),
+        std::nullopt,
+        0,
+        false,
+        {}});
+    if (entry->setup) {
+      entry->setup(entry->current);
+    }
+    _entries.push_back(entry);
+    return success{live_program{std::move(entry)}};
+  }
+
+  // Starts compiling the shaders rebuilt since the last call and swaps in the
+  // programs that are done. Returns the errors encountered along the way.
+  [[nodiscard]] std::vector<loading_error> update() {
+    std::vector<rebuilt> sources;
+    std::vector<loading_error> errors;
+    {
+      std::lock_guard lock{_mutex};
+      sources.swap(_rebuilt);
+      errors.swap(_errors);
+    }
+
+    for (auto& r : sources) {
+      // A newer version supersedes the one still compiling, if any, which
+      // keeps its place in _compiling.
+      const bool compiling = r.entry->pending.has_value();
+      r.entry->pending = _queue.submit(vs_source{std::move(r.vs)},
+                                       fs_source{std::move(r.fs)});
+      if (!compiling) {
+        _compiling.push_back(std::move(r.entry));
+      }
+    }
+    _queue.link();
+
+    for (auto it = _compiling.begin(); it != _compiling.end();) {
+      auto& entry = **it;
+      if (!entry.pending || !entry.pending->ready()) {
+        ++it;
+        continue;
+      }
+      auto linked = std::move(*entry.pending).get();
+      entry.pending.reset();
+      if (linked.has_value()) {
+        entry.current = std::move(linked).value();
+        ++entry.generation;
+        if (entry.setup) {
+          entry.setup(entry.current);
+        }
+      }
+      else {
+        errors.emplace_back(entry.name().c_str(),
+                            linked.error().error_message().c_str());
+      }
+      it = _compiling.erase(it);
+    }
+    return errors;
+  }
+
+  [[nodiscard]] std::chrono::milliseconds debounce() const noexcept {
+    return _debounce;
+  }
+
+ private:
+  struct rebuilt {
+    std::shared_ptr<detail::live_entry> entry;
+    std::string vs;
+    std::string fs;
+  };
+
+  void watch() {
+    bool changed = false;
+    while (!_stop) {
+      if (_directories.wait(_debounce)) {
+        // Wait for a full quiet period, so that a burst of saves leads to a
+        // single rebuild.
+        changed = true;
+        continue;
+      }
+      if (changed || !_directories.notifies()) {
+        changed = false;
+        rebuild();
+      }
+    }
+  }
+
+  // Called with the mutex held.
+  void watch_graph() {
+    for (const auto& file : _graph.files()) {
+      _directories.watch(file.parent_path());
+    }
+    for (const auto& dir : _graph.include_dirs()) {
+      _directories.watch(dir);
+    }
+  }
+
+  void rebuild() {
+    std::lock_guard lock{_mutex};
+    std::unordered_set<std::string> stale;
+    for (auto& file : _graph.refresh()) {
+      stale.insert(file.string());
+    }
+
+    for (const auto& entry : _entries) {
+      if (!entry->failed && stale.count(entry->vs_key) == 0 &&
+          stale.count(entry->fs_key) == 0) {
+        continue;
+      }
+      auto vs = detail::load_from_disk(_graph, entry->vs.c_str());
+      auto fs = detail::load_from_disk(_graph, entry->fs.c_str());
+      if (vs.has_value() && fs.has_value()) {
+        entry->failed = false;
+        entry->last_error.clear();
+        _rebuilt.push_back(
+            rebuilt{entry, std::move(vs).value(), std::move(fs).value()});
+        continue;
+      }
+      // Failed entries are retried after every change, including unrelated
+      // ones, so the same error is only reported once.
+      auto error = vs.has_value() ? std::move(fs).error()
+                                  : std::move(vs).error();
+      entry->failed = true;
+      if (entry->last_error != error.what()) {
+        entry->last_error = error.what();
+        _errors.push_back(std::move(error));
+      }
+    }
+    watch_graph();
+  }
+
+  std::chrono::milliseconds _debounce;
+  std::atomic<bool> _stop{false};
+
+  // Shared with the watcher thread.
+  std::mutex _mutex;
+  include_graph _graph;
+  detail::directory_watcher _directories;
+  std::vector<std::shared_ptr<detail::live_entry>> _entries;
+  std::vector<rebuilt> _rebuilt;
+  std::vector<loading_error> _errors;
+
+  // Rendering thread only.
+  compile_queue _queue;
+  std::vector<std::shared_ptr<detail::live_entry>> _compiling;
+
+  std::thread _watcher;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_SHADER_RELOADER_HEADER
\ No newline at end of file
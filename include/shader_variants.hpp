@@ -0,0 +1,206 @@
+#ifndef GUARD_DPSG_SHADER_VARIANTS_HEADER
+#define GUARD_DPSG_SHADER_VARIANTS_HEADER
+
+#include "compile_queue.hpp"
+#include "load_shaders.hpp"
+#include "loading_error.hpp"
+#include "program.hpp"
+#include "result.hpp"
+#include "shader_preprocessor.hpp"
+#include "shaders.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+// Set of features enabled in a variant, one bit per feature.
+using feature_mask = std::uint32_t;
+
+namespace detail {
+// 'source' with a '#define' for each feature of 'mask' inserted after the
+// '#version' directive, followed by a '#line' directive so that line numbers
+// in error messages still match the file.
+inline std::string with_defines(std::string_view source,
+                                const std::vector<std::string>& features,
+                                feature_mask mask) {
+  std::size_t insert_at = 0;
+  std::size_t next_line = 1;
+  for_each_line(source, [&](std::string_view line, std::size_t number) {
+    if (next_line == 1 && directive(line) == "version") {
+      insert_at = static_cast<std::size_t>(line.data() - source.data()) +
+                  line.size();
+      insert_at = source.find('\n', insert_at);
+      insert_at = insert_at == std::string_view::npos ? source.size()
+                                                      : insert_at + 1;
+      next_line = number + 1;
+    }
+  });
+
+  std::string result{source.substr(0, insert_at)};
+  if (!result.empty() && result.back() != '\n') {
+    result += '\n';
+  }
+  for (std::size_t i = 0; i < features.size(); ++i) {
+    if ((mask & (feature_mask{1} << i)) != 0) {
+      result += "#define ";
+      result += features[i];
+      result += '\n';
+    }
+  }
+  result += "#line ";
+  result += std::to_string(next_line);
+  result += '\n';
+  result.append(source.substr(insert_at));
+  return result;
+}
+}  // namespace detail
+
+// Programs built from a single pair of shaders, in which optional parts are
+// enabled with preprocessor definitions, instead of one near identical file
+// per combination:
+//
+//    layout (location = 0) in vec3 aPos;
+//    #ifdef COLOR
+//    layout (location = 1) in vec3 aColor;
+//    #endif
+//
+// Each feature is given a bit, in the order of the list passed at
+// construction. A variant is compiled the first time it is requested and
+// cached, including when compilation fails, so a broken variant isn't
+// recompiled on every call. Variants known in advance can be precompiled
+// through a compile_queue while the application is loading.
+//
+//    auto variants =
+//        shader_variants::load(vs_filename{"shaders/attributes.vs"},
+//                              fs_filename{"shaders/basic.fs"},
+//                              {"COLOR", "TEXCOORD"})
+//            .value();
+//    const auto color = variants.mask("COLOR");
+//    variants.precompile({color, variants.mask("COLOR", "TEXCOORD")});
+//    ...
+//    variants.get(color).value().use();
+class shader_variants {
+ public:
+  constexpr static inline std::size_t max_features = sizeof(feature_mask) * 8;
+
+  template <class T, class U>
+  shader_variants(const vs_source<T>& vs,
+                  const fs_source<U>& fs,
+                  std::vector<std::string> features)
+      : _vs{vs.c_str()}, _fs{fs.c_str()}, _features{std::move(features)} {
+    if (_features.size() > max_features) {
+      _features.resize(max_features);
+    }
+  }
+
+  template <class T, class U>
+  [[nodiscard]] static result<shader_variants, loading_error> load(
+      const vs_filename<T>& vs,
+      const fs_filename<U>& fs,
+      std::vector<std::string> features) {
+    include_graph graph;
+    return dpsg::load(graph, vs).then([&](auto&& vshader_source) {
+      return dpsg::load(graph, fs).then([&](auto&& fshader_source) {
+        return result<shader_variants, loading_error>{in_place_success,
+                                                      vshader_source,
+                                                      fshader_source,
+                                                      std::move(features)};
+      });
+    });
+  }
+
+  // Bit of the feature called 'name', or 0 if there is no such feature.
+  [[nodiscard]] feature_mask feature(std::string_view name) const noexcept {
+    for (std::size_t i = 0; i < _features.size(); ++i) {
+      if (_features[i] == name) {
+        return feature_mask{1} << i;
+      }
+    }
+    return 0;
+  }
+
+  template <class... Names>
+  [[nodiscard]] feature_mask mask(const Names&... names) const noexcept {
+    return (feature_mask{0} | ... | feature(names));
+  }
+
+  // Program of the variant with the features in 'mask'. Compiles it if it
+  // was neither requested nor precompiled before, otherwise waits for its
+  // precompilation to finish if needed.
+  [[nodiscard]] const result<program, gl_error>& get(feature_mask mask) {
+    if (auto it = _variants.find(mask); it != _variants.end()) {
+      return it->second;
+    }
+    if (auto it = _pending.find(mask); it != _pending.end()) {
+      auto linked = std::move(it->second).get();
+      _pending.erase(it);
+      return _variants.emplace(mask, std::move(linked)).first->second;
+    }
+    return _variants
+        .emplace(mask,
+                 create_program(vs_source{source(_vs, mask)},
+                                fs_source{source(_fs, mask)}))
+        .first->second;
+  }
+
+  // Starts compiling the given variants, without waiting for the result.
+  // Variants already compiled or compiling are skipped.
+  void precompile(std::initializer_list<feature_mask> masks) {
+    for (auto mask : masks) {
+      if (_variants.count(mask) != 0 || _pending.count(mask) != 0) {
+        continue;
+      }
+      _pending.emplace(mask,
+                       _queue.submit(vs_source{source(_vs, mask)},
+                                     fs_source{source(_fs, mask)}));
+    }
+    _queue.link();
+  }
+
+  // Moves the precompiled variants that are done to the cache, without
+  // blocking. Returns the number of variants still compiling.
+  std::size_t poll() {
+    for (auto it = _pending.begin(); it != _pending.end();) {
+      if (!it->second.ready()) {
+        ++it;
+        continue;
+      }
+      _variants.emplace(it->first, std::move(it->second).get());
+      it = _pending.erase(it);
+    }
+    return _pending.size();
+  }
+
+  // Whether get(mask) would return without compiling or waiting.
+  [[nodiscard]] bool compiled(feature_mask mask) const noexcept {
+    return _variants.count(mask) != 0;
+  }
+
+  [[nodiscard]] const std::vector<std::string>& features() const noexcept {
+    return _features;
+  }
+
+ private:
+  [[nodiscard]] std::string source(const std::string& base,
+                                   feature_mask mask) const {
+    return detail::with_defines(base, _features, mask);
+  }
+
+  std::string _vs;
+  std::string _fs;
+  std::vector<std::string> _features;
+  std::unordered_map<feature_mask, result<program, gl_error>> _variants;
+  std::unordered_map<feature_mask, pending_program> _pending;
+  compile_queue _queue;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_SHADER_VARIANTS_HEADER
\ No newline at end of file
@@ -9,11 +9,24 @@
 
 #include <optional>
 #include <stdexcept>
+#include <string_view>
 #include <type_traits>
 
 namespace dpsg {
 struct sampler2D;
 
+namespace detail {
+template <class T, class = void>
+struct has_size : std::false_type {};
+template <class T>
+struct has_size<T,
+                std::void_t<decltype(std::declval<T>().data()),
+                            decltype(std::declval<T>().size())>>
+    : std::true_type {};
+template <class T>
+constexpr static inline bool has_size_v = has_size<T>::value;
+}  // namespace detail
+
 class gl_error : public std::exception {
  public:
   [[nodiscard]] const char* what() const override {
@@ -54,6 +67,17 @@ class shader_source {
   constexpr explicit shader_source(I&& v) noexcept
       : _value(std::forward<T>(v)){};
   const auto* c_str() const noexcept { return ::dpsg::c_str(_value); }
+
+  // Source and its length when the underlying string knows it, so that the
+  // driver doesn't have to look for the terminating null.
+  [[nodiscard]] std::string_view view() const noexcept {
+    if constexpr (detail::has_size_v<const T&>) {
+      return std::string_view{_value.data(), _value.size()};
+    }
+    else {
+      return std::string_view{c_str()};
+    }
+  }
 };
 
 template <class T>
@@ -103,13 +127,32 @@ class shader {
   template <class Str>
   [[nodiscard]] static result<shader, shader_error> create(
       shader_source<Type, Str> source) noexcept {
+    return from_compiled(compile(source));
+  }
+
+  // Starts compiling 'source' without waiting for the outcome, which the
+  // driver may then compute in the background.
+  template <class Str>
+  [[nodiscard]] static id_type compile(
+      const shader_source<Type, Str>& source) noexcept {
     auto shader_id = gl::create_shader<Type>();
-    gl::shader_source(shader_id, c_str(source));
+    const auto text = source.view();
+    gl::shader_source(
+        shader_id, text.data(), static_cast<gl::int_t>(text.size()));
     gl::compile_shader(shader_id);
+    return shader_id;
+  }
+
+  // Takes ownership of a shader returned by compile() and checks the outcome,
+  // waiting for the compilation to complete if needed.
+  [[nodiscard]] static result<shader, shader_error> from_compiled(
+      id_type shader_id) noexcept {
     int success = 0;
     glGetShaderiv(shader_id.value, GL_COMPILE_STATUS, &success);
     if (success == GL_FALSE) {
-      return result<shader, shader_error>{in_place_error, shader_id};
+      result<shader, shader_error> error{in_place_error, shader_id};
+      gl::delete_shader(shader_id);
+      return error;
     }
     return result<shader, shader_error>{in_place_success, shader_id};
   }
@@ -0,0 +1,108 @@
+#ifndef GUARD_DPSG_SIMD_HEADER
+#define GUARD_DPSG_SIMD_HEADER
+
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define DPSG_SIMD_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace dpsg::simd {
+
+// Alignment that lets the kernels below use aligned loads on their natural
+// register width. The kernels themselves accept unaligned input.
+#if defined(__AVX__)
+constexpr static inline std::size_t alignment = 32;
+#else
+constexpr static inline std::size_t alignment = 16;
+#endif
+
+// out = lhs * rhs, for column major 4x4 matrices of floats. 'out' may alias
+// either operand.
+inline void mat4_multiply(const float* lhs,
+                          const float* rhs,
+                          float* out) noexcept {
+  // Each column of the result is a linear combination of the columns of
+  // lhs, weighted by the elements of the matching column of rhs.
+#if defined(__AVX__)
+  const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs));
+  const __m256 c1 =
+      _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs + 4));  // NOLINT
+  const __m256 c2 =
+      _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs + 8));  // NOLINT
+  const __m256 c3 =
+      _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs + 12));  // NOLINT
+  // Two columns of rhs per iteration, one in each 128 bit lane.
+  for (std::size_t j = 0; j < 16; j += 8) {  // NOLINT
+    const __m256 r = _mm256_loadu_ps(rhs + j);  // NOLINT
+#if defined(__FMA__)
+    __m256 acc = _mm256_mul_ps(c0, _mm256_shuffle_ps(r, r, 0x00));
+    acc = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(r, r, 0x55), acc);  // NOLINT
+    acc = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(r, r, 0xAA), acc);  // NOLINT
+    acc = _mm256_fmadd_ps(c3, _mm256_shuffle_ps(r, r, 0xFF), acc);  // NOLINT
+#else
+    __m256 acc = _mm256_mul_ps(c0, _mm256_shuffle_ps(r, r, 0x00));
+    acc = _mm256_add_ps(
+        acc, _mm256_mul_ps(c1, _mm256_shuffle_ps(r, r, 0x55)));  // NOLINT
+    acc = _mm256_add_ps(
+        acc, _mm256_mul_ps(c2, _mm256_shuffle_ps(r, r, 0xAA)));  // NOLINT
+    acc = _mm256_add_ps(
+        acc, _mm256_mul_ps(c3, _mm256_shuffle_ps(r, r, 0xFF)));  // NOLINT
+#endif
+    _mm256_storeu_ps(out + j, acc);  // NOLINT
+  }
+#elif defined(DPSG_SIMD_SSE)
+  const __m128 c0 = _mm_loadu_ps(lhs);
+  const __m128 c1 = _mm_loadu_ps(lhs + 4);   // NOLINT
+  const __m128 c2 = _mm_loadu_ps(lhs + 8);   // NOLINT
+  const __m128 c3 = _mm_loadu_ps(lhs + 12);  // NOLINT
+  for (std::size_t j = 0; j < 16; j += 4) {  // NOLINT
+    const __m128 r = _mm_loadu_ps(rhs + j);  // NOLINT
+    __m128 acc = _mm_mul_ps(c0, _mm_shuffle_ps(r, r, 0x00));
+    acc = _mm_add_ps(acc,
+                     _mm_mul_ps(c1, _mm_shuffle_ps(r, r, 0x55)));  // NOLINT
+    acc = _mm_add_ps(acc,
+                     _mm_mul_ps(c2, _mm_shuffle_ps(r, r, 0xAA)));  // NOLINT
+    acc = _mm_add_ps(acc,
+                     _mm_mul_ps(c3, _mm_shuffle_ps(r, r, 0xFF)));  // NOLINT
+    _mm_storeu_ps(out + j, acc);  // NOLINT
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t c0 = vld1q_f32(lhs);
+  const float32x4_t c1 = vld1q_f32(lhs + 4);   // NOLINT
+  const float32x4_t c2 = vld1q_f32(lhs + 8);   // NOLINT
+  const float32x4_t c3 = vld1q_f32(lhs + 12);  // NOLINT
+  for (std::size_t j = 0; j < 16; j += 4) {    // NOLINT
+    const float32x4_t r = vld1q_f32(rhs + j);  // NOLINT
+    float32x4_t acc = vmulq_lane_f32(c0, vget_low_f32(r), 0);
+    acc = vmlaq_lane_f32(acc, c1, vget_low_f32(r), 1);
+    acc = vmlaq_lane_f32(acc, c2, vget_high_f32(r), 0);
+    acc = vmlaq_lane_f32(acc, c3, vget_high_f32(r), 1);
+    vst1q_f32(out + j, acc);  // NOLINT
+  }
+#else
+  float result[16];  // NOLINT
+  for (std::size_t j = 0; j < 4; ++j) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      float acc = 0;
+      for (std::size_t k = 0; k < 4; ++k) {
+        acc += lhs[k * 4 + i] * rhs[j * 4 + k];  // NOLINT
+      }
+      result[j * 4 + i] = acc;  // NOLINT
+    }
+  }
+  for (std::size_t i = 0; i < 16; ++i) {  // NOLINT
+    out[i] = result[i];                   // NOLINT
+  }
+#endif
+}
+
+}  // namespace dpsg::simd
+
+#endif  // GUARD_DPSG_SIMD_HEADER
\ No newline at end of file
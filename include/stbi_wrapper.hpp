@@ -2,11 +2,19 @@
 #define GUARD_DPSG_STBI_WRAPPER_HEADER
 
 #include "common.hpp"
+#include "embedded.hpp"
 #include "load_shaders.hpp"
+#include "mapped_file.hpp"
 #include "opengl.hpp"
 #include "stb_image.h"
 #include "texture.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
 namespace dpsg {
 
 template <gl::image_format Format> struct stbi_trait {
@@ -67,15 +75,25 @@ private:
 
 DPSG_LAZY_STR_WRAPPER_IMPL(texture_filename) // NOLINT
 
-template <class TextureTraits, class TextureOptions, class T>
-std::optional<texture_2d> load(const texture_filename<T> &filename,
-                               TextureOptions &&options,
-                               int requested_channels = 0) {
-  int h{};
-  int w{};
-  int c{};
-  stbi_set_flip_vertically_on_load(true);
-  stbi_uc *ptr = stbi_load(filename.c_str(), &w, &h, &c, requested_channels);
+// Image compiled into the executable by dpsg_embed_resources(), decoded
+// straight from memory.
+class texture_embedded {
+public:
+  constexpr explicit texture_embedded(const embedded_file &file) noexcept
+      : _file{&file} {}
+
+  [[nodiscard]] constexpr const embedded_file &file() const noexcept {
+    return *_file;
+  }
+
+private:
+  const embedded_file *_file;
+};
+
+namespace detail {
+template <class TextureTraits, class TextureOptions>
+std::optional<texture_2d> make_texture(stbi_uc *ptr, int w, int h, int c,
+                                       TextureOptions &&options) {
   if (ptr == nullptr) {
     return {};
   }
@@ -85,6 +103,95 @@ std::optional<texture_2d> load(const texture_filename<T> &filename,
       std::forward<TextureOptions>(options)};
 }
 
+struct stbi_deleter {
+  void operator()(stbi_uc *pixels) const noexcept {
+    stbi_image_free(static_cast<void *>(pixels));
+  }
+};
+
+struct decoded_image {
+  std::unique_ptr<stbi_uc, stbi_deleter> pixels;
+  int width{0};
+  int height{0};
+  int channels{0};
+};
+
+#if defined(STBI_NO_THREAD_LOCALS)
+inline void flip_rows(stbi_uc *pixels, int width, int height,
+                      int channels) noexcept {
+  const auto stride = static_cast<std::size_t>(width) * channels;
+  for (int y = 0; y < height / 2; ++y) {
+    auto *top = pixels + stride * y;                   // NOLINT
+    auto *bottom = pixels + stride * (height - 1 - y); // NOLINT
+    std::swap_ranges(top, top + stride, bottom);       // NOLINT
+  }
+}
+#endif
+
+// Decodes an image held in memory. The flip only applies to this call: stb's
+// flag is set for the calling thread only, so images can be decoded from
+// several threads with different settings.
+inline decoded_image decode_image(const unsigned char *data, std::size_t size,
+                                  bool flip, int requested_channels) {
+  decoded_image image;
+  if (size == 0) {
+    return image;
+  }
+#if defined(STBI_NO_THREAD_LOCALS)
+  // The global flag is left alone, so it must not be set elsewhere.
+  stbi_uc *ptr = stbi_load_from_memory(data, static_cast<int>(size),
+                                       &image.width, &image.height,
+                                       &image.channels, requested_channels);
+  if (ptr != nullptr && flip) {
+    flip_rows(ptr, image.width, image.height,
+              requested_channels != 0 ? requested_channels : image.channels);
+  }
+#else
+  stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+  stbi_uc *ptr = stbi_load_from_memory(data, static_cast<int>(size),
+                                       &image.width, &image.height,
+                                       &image.channels, requested_channels);
+#endif
+  image.pixels.reset(ptr);
+  return image;
+}
+
+template <class TextureTraits, class TextureOptions>
+std::optional<texture_2d> decode_texture(const unsigned char *data,
+                                         std::size_t size,
+                                         TextureOptions &&options,
+                                         int requested_channels) {
+  auto image = decode_image(data, size, true, requested_channels);
+  return make_texture<TextureTraits>(image.pixels.release(), image.width,
+                                     image.height, image.channels,
+                                     std::forward<TextureOptions>(options));
+}
+} // namespace detail
+
+// The file is mapped in memory and decoded from there, rather than read
+// through stdio buffers.
+template <class TextureTraits, class TextureOptions, class T>
+std::optional<texture_2d> load(const texture_filename<T> &filename,
+                               TextureOptions &&options,
+                               int requested_channels = 0) {
+  auto file = mapped_file::open(filename.c_str());
+  if (!file.has_value()) {
+    return {};
+  }
+  return detail::decode_texture<TextureTraits>(
+      file.value().data(), file.value().size(),
+      std::forward<TextureOptions>(options), requested_channels);
+}
+
+template <class TextureTraits, class TextureOptions>
+std::optional<texture_2d> load(const texture_embedded &texture,
+                               TextureOptions &&options,
+                               int requested_channels = 0) {
+  return detail::decode_texture<TextureTraits>(
+      texture.file().data, texture.file().size,
+      std::forward<TextureOptions>(options), requested_channels);
+}
+
 template <class TextureTraits, class T>
 std::optional<texture_2d> load(const texture_filename<T> &filename,
                                int requested_channels = 0) {
@@ -92,6 +199,13 @@ std::optional<texture_2d> load(const texture_filename<T> &filename,
                              requested_channels);
 }
 
+template <class TextureTraits>
+std::optional<texture_2d> load(const texture_embedded &texture,
+                               int requested_channels = 0) {
+  return load<TextureTraits>(texture, texture_options::no_options,
+                             requested_channels);
+}
+
 } // namespace dpsg
 
 #endif // GUARD_DPSG_STBI_WRAPPER_HEADER
\ No newline at end of file
@@ -111,7 +111,15 @@ public:
             gl::index first = gl::index{0},
             gl::element_count count = element_count) const noexcept {
     assert(first.value + count.value <= element_count.value);
-    gl::draw_arrays(mode, first, element_count);
+    gl::draw_arrays(mode, first, count);
+  }
+
+  void draw_instanced(gl::instance_count instances,
+                      gl::drawing_mode mode = gl::drawing_mode::triangles,
+                      gl::index first = gl::index{0},
+                      gl::element_count count = element_count) const noexcept {
+    assert(first.value + count.value <= element_count.value);
+    gl::draw_arrays_instanced(mode, first, count, instances);
   }
 };
 
@@ -122,6 +130,77 @@ fixed_size_structured_buffer(Layout, Input (&data)[N])
         detail::decayed_layout<Input, Layout>,
         N / detail::decayed_layout<Input, Layout>::count.value>;
 
+// Per-instance attributes for up to N instances, stored in their own buffer
+// and attached after the per-vertex attributes of a structured_buffer. The
+// content is expected to change every frame, hence the dynamic hint and the
+// partial updates.
+//
+//    using matrices = instanced<packed<group<4>, group<4>, group<4>,
+//                                      group<4>>>;
+//    fixed_size_instance_buffer<layout<float, matrices>, 64> instances;
+//    instances.attach(mesh);
+//    instances.update(data, gl::instance_count{n});
+//    mesh.draw_instanced(gl::instance_count{n});
+template <class Layout, std::size_t N> struct fixed_size_instance_buffer {
+  using layout_type = typename Layout::layout_type;
+  using value_type = typename Layout::value_type;
+  constexpr static inline gl::instance_count capacity{N};
+  constexpr static inline gl::element_count layout_count = Layout::count;
+  constexpr static inline gl::element_count buffer_count{layout_count.value *
+                                                         N};
+
+  explicit fixed_size_instance_buffer(
+      gl::data_hint hint = gl::data_hint::dynamic_draw) {
+    vbo.bind();
+    gl::buffer_data(gl::buffer_type::array,
+                    gl::byte_size{buffer_count.value * sizeof(value_type)},
+                    hint);
+  }
+
+  template <class Input, std::size_t M,
+            std::enable_if_t<std::is_same_v<value_type, std::decay_t<Input>>,
+                             int> = 0>
+  // NOLINTNEXTLINE
+  explicit fixed_size_instance_buffer(Input (&data)[M],
+                                      gl::data_hint hint =
+                                          gl::data_hint::static_draw) {
+    static_assert(M == buffer_count.value,
+                  "Invalid array dimension: the input array must hold exactly "
+                  "N instances");
+    vbo.bind();
+    vbo.set_data(data, hint);
+  }
+
+  // Adds the instance attributes to the vertex array of 'vertices', right
+  // after its own attributes.
+  template <class VertexLayout>
+  void attach(const structured_buffer<VertexLayout> &vertices) const noexcept {
+    constexpr std::size_t first = VertexLayout::attribute_count;
+    vertices.bind();
+    vbo.bind();
+    Layout::template set_attrib_pointer<buffer_count.value, first>();
+    Layout::template enable<first>();
+  }
+
+  // Overwrites the attributes of the first 'instances' instances.
+  void update(const value_type *data,
+              gl::instance_count instances) const noexcept {
+    assert(instances.value <= capacity.value);
+    vbo.bind();
+    gl::buffer_sub_data(gl::buffer_type::array, gl::byte_offset{0},
+                        gl::byte_size{instances.value * layout_count.value *
+                                      sizeof(value_type)},
+                        data);
+  }
+
+  [[nodiscard]] const vertex_buffer &get_vertex_buffer() const { return vbo; }
+
+private:
+  static_assert(is_instanced_v<layout_type>,
+                "Instance buffers must be described by an instanced layout");
+  vertex_buffer vbo;
+};
+
 } // namespace dpsg
 
 #endif // GUARD_DPSG_STRUCTURED_BUFFERS_HEADER
\ No newline at end of file
@@ -3,11 +3,111 @@
 
 #include "opengl.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <optional>
+#include <type_traits>
 
 namespace dpsg {
 
+// Size and format of a texture allocated once, with undefined content, to be
+// filled with basic_texture::update().
+struct texture_storage {
+  gl::sized_internal_format format;
+  gl::width width;
+  gl::height height;
+  // Layers of an array texture, ignored otherwise.
+  gl::depth layers{1};
+  // 0 for a full mipmap chain, down to 1x1.
+  gl::level_count levels{0};
+};
+
+// One mipmap level of an image already in a GPU compressed format.
+struct compressed_level {
+  gl::width width;
+  gl::height height;
+  const void *data;
+  gl::byte_size size;
+};
+
+// One mipmap level of an uncompressed image with 8 bits per component, each
+// row starting on a 4 byte boundary (the default unpack alignment).
+struct image_level {
+  gl::width width;
+  gl::height height;
+  const gl::ubyte_t *pixels;
+};
+
+namespace detail {
+inline bool has_texture_storage() noexcept {
+#if defined(GL_VERSION_4_2)
+  if (GLAD_GL_VERSION_4_2) {
+    return true;
+  }
+#endif
+#if defined(GL_ARB_texture_storage)
+  if (GLAD_GL_ARB_texture_storage) {
+    return true;
+  }
+#endif
+  return false;
+}
+
+constexpr inline gl::level_count level_count(
+    const texture_storage &storage) noexcept {
+  if (storage.levels.value != 0) {
+    return storage.levels;
+  }
+  unsigned int levels = 1;
+  for (auto size = std::max(storage.width.value, storage.height.value);
+       size > 1; size /= 2) {
+    ++levels;
+  }
+  return gl::level_count{levels};
+}
+
+// Client format that may be passed along with a null pointer when allocating
+// a mutable image. Depth and stencil formats need texture storage.
+constexpr inline gl::image_format
+allocation_format(gl::sized_internal_format format) noexcept {
+  using f = gl::sized_internal_format;
+  switch (format) {
+  case f::depth_component16:
+  case f::depth_component24:
+  case f::depth_component32f:
+    return gl::image_format::depth_component;
+  case f::rgb10_a2ui:
+  case f::r8i:
+  case f::r8ui:
+  case f::r16i:
+  case f::r16ui:
+  case f::r32i:
+  case f::r32ui:
+  case f::rg8i:
+  case f::rg8ui:
+  case f::rg16i:
+  case f::rg16ui:
+  case f::rg32i:
+  case f::rg32ui:
+  case f::rgb8i:
+  case f::rgb8ui:
+  case f::rgb16i:
+  case f::rgb16ui:
+  case f::rgb32i:
+  case f::rgb32ui:
+  case f::rgba8i:
+  case f::rgba8ui:
+  case f::rgba16i:
+  case f::rgba16ui:
+  case f::rgba32i:
+  case f::rgba32ui:
+    return gl::image_format::rgba_integer;
+  default:
+    return gl::image_format::rgba;
+  }
+}
+} // namespace detail
+
 namespace texture_traits {
 template <gl::texture_target Target> struct base_traits {
   constexpr inline static gl::texture_target texture_target = Target;
@@ -25,6 +125,30 @@ template <gl::texture_target Target> struct base_traits {
   static void generate_mipmap() noexcept {
     gl::generate_mipmap(texture_target);
   }
+
+  // Allocates storage with glTexStorage* when available. Otherwise every
+  // level is specified as a mutable image, and the level range is clamped
+  // so that the texture is complete.
+  template <class Derived>
+  static void allocate(const texture_storage &storage) noexcept {
+    const auto levels = detail::level_count(storage);
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_storage)
+    if (detail::has_texture_storage()) {
+      Derived::allocate_storage(levels, storage);
+      return;
+    }
+#endif
+    const auto format = detail::allocation_format(storage.format);
+    for (unsigned int level = 0; level < levels.value; ++level) {
+      Derived::allocate_level(
+          gl::mipmap_level{level}, storage.format,
+          gl::width{std::max(storage.width.value >> level, 1U)},
+          gl::height{std::max(storage.height.value >> level, 1U)},
+          storage.layers, format);
+    }
+    gl::tex_parameter(texture_target, gl::texture_level::max,
+                      static_cast<int>(levels.value - 1));
+  }
 };
 
 struct _2d : base_traits<gl::texture_target::_2d> {
@@ -33,6 +157,75 @@ struct _2d : base_traits<gl::texture_target::_2d> {
     gl::tex_image_2D(gl::texture_image_target::_2d,
                      std::forward<Args>(args)...);
   }
+
+  template <class... Args> static void update_image(Args &&... args) noexcept {
+    gl::tex_sub_image_2D(gl::texture_image_target::_2d,
+                         std::forward<Args>(args)...);
+  }
+
+  static void
+  generate_compressed_image(gl::mipmap_level level,
+                            gl::compressed_internal_format format,
+                            const compressed_level &image) noexcept {
+    gl::compressed_tex_image_2D(gl::texture_image_target::_2d, level, format,
+                                image.width, image.height, image.size,
+                                image.data);
+  }
+
+  static void allocate(const texture_storage &storage) noexcept {
+    base_traits::allocate<_2d>(storage);
+  }
+
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_storage)
+  static void allocate_storage(gl::level_count levels,
+                               const texture_storage &storage) noexcept {
+    gl::tex_storage_2D(texture_target, levels, storage.format, storage.width,
+                       storage.height);
+  }
+#endif
+
+  static void allocate_level(gl::mipmap_level level,
+                             gl::sized_internal_format internal,
+                             gl::width width, gl::height height,
+                             [[maybe_unused]] gl::depth layers,
+                             gl::image_format format) noexcept {
+    generate_image(level, internal, width, height, format,
+                   static_cast<const gl::ubyte_t *>(nullptr));
+  }
+};
+
+// Layers of identically sized images, bound and sampled as one texture
+// (sampler2DArray), the layer being the third texture coordinate.
+struct _2d_array : base_traits<gl::texture_target::_2d_array> {
+  template <class... Args>
+  static void generate_image(Args &&... args) noexcept {
+    gl::tex_image_3D(texture_target, std::forward<Args>(args)...);
+  }
+
+  template <class... Args> static void update_image(Args &&... args) noexcept {
+    gl::tex_sub_image_3D(texture_target, std::forward<Args>(args)...);
+  }
+
+  static void allocate(const texture_storage &storage) noexcept {
+    base_traits::allocate<_2d_array>(storage);
+  }
+
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_storage)
+  static void allocate_storage(gl::level_count levels,
+                               const texture_storage &storage) noexcept {
+    gl::tex_storage_3D(texture_target, levels, storage.format, storage.width,
+                       storage.height, storage.layers);
+  }
+#endif
+
+  static void allocate_level(gl::mipmap_level level,
+                             gl::sized_internal_format internal,
+                             gl::width width, gl::height height,
+                             gl::depth layers,
+                             gl::image_format format) noexcept {
+    generate_image(level, internal, width, height, layers, format,
+                   static_cast<const gl::ubyte_t *>(nullptr));
+  }
 };
 
 } // namespace texture_traits
@@ -53,23 +246,85 @@ constexpr static inline auto no_options =
 
 template <class Traits> class basic_texture : private Traits {
   using Traits::generate_image;
-  using Traits::generate_mipmap;
   using Traits::set_parameter;
+  using Traits::update_image;
 
 public:
+  using Traits::texture_target;
+
   template <class Image> explicit basic_texture(Image &&i) noexcept {
     gl::gen_texture(_id);
     bind();
     generate_image(i.width(), i.height(), i.image_format(), i.texture());
-    generate_mipmap();
+    Traits::generate_mipmap();
   }
 
-  template <class Image, class F> basic_texture(Image &&i, F &&f) noexcept {
+  template <class Image, class F,
+            std::enable_if_t<
+                !std::is_same_v<std::decay_t<Image>, texture_storage>, int> = 0>
+  basic_texture(Image &&i, F &&f) noexcept {
     gl::gen_texture(_id);
     bind();
     std::forward<F>(f)(set_parameter);
     generate_image(i.width(), i.height(), i.image_format(), i.texture());
-    generate_mipmap();
+    Traits::generate_mipmap();
+  }
+
+  // Allocates an image with undefined content, to be filled with update().
+  template <class T = gl::ubyte_t, class F>
+  basic_texture(gl::width width, gl::height height, gl::image_format format,
+                F &&f) noexcept {
+    gl::gen_texture(_id);
+    bind();
+    std::forward<F>(f)(set_parameter);
+    generate_image(width, height, format, static_cast<const T *>(nullptr));
+    Traits::generate_mipmap();
+  }
+
+  // Allocates immutable storage when the context supports it, see
+  // texture_storage.
+  template <class F>
+  basic_texture(const texture_storage &storage, F &&f) noexcept {
+    gl::gen_texture(_id);
+    bind();
+    std::forward<F>(f)(set_parameter);
+    Traits::allocate(storage);
+  }
+
+  // Uploads every level in 'levels', a range of compressed_level starting
+  // with the base level, as is: the GPU samples the compressed data directly.
+  // Levels missing from the chain are excluded from sampling.
+  template <class Levels, class F>
+  basic_texture(gl::compressed_internal_format format, const Levels &levels,
+                F &&f) noexcept {
+    gl::gen_texture(_id);
+    bind();
+    std::forward<F>(f)(set_parameter);
+    unsigned int level = 0;
+    for (const compressed_level &image : levels) {
+      Traits::generate_compressed_image(gl::mipmap_level{level++}, format,
+                                        image);
+    }
+    gl::tex_parameter(Traits::texture_target, gl::texture_level::max,
+                      static_cast<int>(level == 0 ? 0 : level - 1));
+  }
+
+  // Uploads every level in 'levels', a range of image_level starting with the
+  // base level, instead of letting the driver generate the mipmaps. Levels
+  // missing from the chain are excluded from sampling.
+  template <class Levels, class F>
+  basic_texture(gl::image_format format, const Levels &levels,
+                F &&f) noexcept {
+    gl::gen_texture(_id);
+    bind();
+    std::forward<F>(f)(set_parameter);
+    unsigned int level = 0;
+    for (const image_level &image : levels) {
+      generate_image(gl::mipmap_level{level++}, image.width, image.height,
+                     format, image.pixels);
+    }
+    gl::tex_parameter(Traits::texture_target, gl::texture_level::max,
+                      static_cast<int>(level == 0 ? 0 : level - 1));
   }
 
   basic_texture() = default;
@@ -86,11 +341,38 @@ public:
   void bind() const noexcept { Traits::bind(_id); }
   [[nodiscard]] gl::texture_id id() const noexcept { return _id; }
 
+  // Copies pixels from client memory into a region of the base level. The
+  // copy is synchronous, see texture_stream to stream without stalling.
+  // Mipmaps are left as they were until generate_mipmap() is called.
+  template <class T>
+  void update(gl::x_offset x, gl::y_offset y, gl::width width,
+              gl::height height, gl::image_format format,
+              const T *pixels) const noexcept {
+    bind();
+    update_image(x, y, width, height, format, pixels);
+  }
+
+  // Copies pixels from client memory into a region of one layer of an array
+  // texture.
+  template <class T>
+  void update(gl::x_offset x, gl::y_offset y, gl::z_offset layer,
+              gl::width width, gl::height height, gl::image_format format,
+              const T *pixels) const noexcept {
+    bind();
+    update_image(x, y, layer, width, height, gl::depth{1}, format, pixels);
+  }
+
+  void generate_mipmap() const noexcept {
+    bind();
+    Traits::generate_mipmap();
+  }
+
 private:
   gl::texture_id _id{};
 };
 
 using texture_2d = basic_texture<texture_traits::_2d>;
+using texture_2d_array = basic_texture<texture_traits::_2d_array>;
 
 } // namespace dpsg
 
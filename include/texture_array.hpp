@@ -0,0 +1,176 @@
+#ifndef GUARD_DPSG_TEXTURE_ARRAY_HEADER
+#define GUARD_DPSG_TEXTURE_ARRAY_HEADER
+
+#include "embedded.hpp"
+#include "loading_error.hpp"
+#include "mapped_file.hpp"
+#include "opengl.hpp"
+#include "result.hpp"
+#include "stbi_wrapper.hpp"
+#include "texture.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+namespace detail {
+// Internal format matching 8 bits per component client data.
+constexpr inline gl::sized_internal_format unorm8_format(
+    gl::image_format format) noexcept {
+  switch (format) {
+    case gl::image_format::rg:
+      return gl::sized_internal_format::rg8;
+    case gl::image_format::rgb:
+    case gl::image_format::bgr:
+      return gl::sized_internal_format::rgb8;
+    case gl::image_format::rgba:
+    case gl::image_format::bgra:
+      return gl::sized_internal_format::rgba8;
+    default:
+      return gl::sized_internal_format::r8;
+  }
+}
+}  // namespace detail
+
+// Where an image was packed by a texture_array_packer: the index of the array
+// texture in the vector returned by build(), and the layer within it.
+struct texture_layer {
+  std::size_t array;
+  unsigned int layer;
+};
+
+// Packs images of the same size and format into array textures, so that
+// materials using them share a single binding and can be drawn in the same
+// batch, selecting their image with the layer index.
+//
+// Images are decoded as they are added, each one going into the first array
+// with the same size and format that has room left, or starting a new one.
+// Nothing is created on the GL side until build().
+//
+//    texture_array_packer packer;
+//    auto wall = packer.add<texture_rgb>(texture_filename{"wall.jpg"});
+//    auto floor = packer.add<texture_rgb>(texture_filename{"floor.jpg"});
+//    auto arrays = packer.build(texture_options::repeat_linear);
+//    arrays[wall.value().array].bind();
+//    prog.set("layer", wall.value().layer);
+class texture_array_packer {
+ public:
+  // 256 is the minimum of GL_MAX_ARRAY_TEXTURE_LAYERS in OpenGL 3.3.
+  explicit texture_array_packer(unsigned int max_layers = 256) noexcept
+      : _max_layers{max_layers == 0 ? 1 : max_layers} {}
+
+  template <class TextureTraits, class T>
+  result<texture_layer, loading_error> add(const texture_filename<T>& filename,
+                                           bool flip = true) {
+    auto file = mapped_file::open(filename.c_str());
+    if (!file.has_value()) {
+      return failure{std::move(file).error()};
+    }
+    return add(detail::decode_image(
+                   file.value().data(),
+                   file.value().size(),
+                   flip,
+                   channels(TextureTraits::image_format())),
+               TextureTraits::image_format(),
+               filename.c_str());
+  }
+
+  template <class TextureTraits>
+  result<texture_layer, loading_error> add(const texture_embedded& texture,
+                                           bool flip = true) {
+    const auto& file = texture.file();
+    return add(detail::decode_image(file.data,
+                                    file.size,
+                                    flip,
+                                    channels(TextureTraits::image_format())),
+               TextureTraits::image_format(),
+               std::string{file.name}.c_str());
+  }
+
+  // Creates one array texture per group of images, with immutable storage
+  // when available and a full mipmap chain, then releases the decoded
+  // images. The packer can be reused afterwards, indices starting over.
+  template <class TextureOptions>
+  [[nodiscard]] std::vector<texture_2d_array> build(TextureOptions&& options) {
+    std::vector<texture_2d_array> arrays;
+    arrays.reserve(_groups.size());
+    for (auto& g : _groups) {
+      const auto layers = static_cast<unsigned int>(g.images.size());
+      auto& array = arrays.emplace_back(
+          texture_storage{detail::unorm8_format(g.format),
+                          g.width,
+                          g.height,
+                          gl::depth{layers}},
+          options);
+      for (unsigned int layer = 0; layer < layers; ++layer) {
+        array.update(gl::x_offset{0},
+                     gl::y_offset{0},
+                     gl::z_offset{static_cast<gl::int_t>(layer)},
+                     g.width,
+                     g.height,
+                     g.format,
+                     g.images[layer].pixels.get());
+      }
+      array.generate_mipmap();
+    }
+    _groups.clear();
+    return arrays;
+  }
+
+  [[nodiscard]] std::vector<texture_2d_array> build() {
+    return build(texture_options::no_options);
+  }
+
+  // Number of array textures build() would create.
+  [[nodiscard]] std::size_t arrays() const noexcept { return _groups.size(); }
+
+ private:
+  struct group {
+    gl::width width;
+    gl::height height;
+    gl::image_format format;
+    std::vector<detail::decoded_image> images;
+  };
+
+  // Decoding to the component count of the format ensures that every layer
+  // of an array has the same layout, whatever the source files contain.
+  static int channels(gl::image_format format) noexcept {
+    return static_cast<int>(gl::component_count(format));
+  }
+
+  result<texture_layer, loading_error> add(detail::decoded_image image,
+                                           gl::image_format format,
+                                           const char* name) {
+    if (!image.pixels) {
+      const char* reason = stbi_failure_reason();
+      return failure{name, reason != nullptr ? reason : "empty file"};
+    }
+    const gl::width width{static_cast<unsigned int>(image.width)};
+    const gl::height height{static_cast<unsigned int>(image.height)};
+    std::size_t index = 0;
+    for (; index < _groups.size(); ++index) {
+      const auto& g = _groups[index];
+      if (g.width.value == width.value && g.height.value == height.value &&
+          g.format == format && g.images.size() < _max_layers) {
+        break;
+      }
+    }
+    if (index == _groups.size()) {
+      _groups.push_back(group{width, height, format, {}});
+    }
+    auto& images = _groups[index].images;
+    images.push_back(std::move(image));
+    return success{texture_layer{
+        index, static_cast<unsigned int>(images.size() - 1)}};
+  }
+
+  unsigned int _max_layers;
+  std::vector<group> _groups;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_TEXTURE_ARRAY_HEADER
\ No newline at end of file
@@ -0,0 +1,431 @@
+#ifndef GUARD_DPSG_TEXTURE_ATLAS_HEADER
+#define GUARD_DPSG_TEXTURE_ATLAS_HEADER
+
+#include "embedded.hpp"
+#include "layout.hpp"
+#include "loading_error.hpp"
+#include "mapped_file.hpp"
+#include "mipmap.hpp"
+#include "opengl.hpp"
+#include "result.hpp"
+#include "stbi_wrapper.hpp"
+#include "texture.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+// Where an image landed in a texture_atlas, as the texture coordinates of its
+// corners. Coordinates (u, v) of the original image become
+// (u0 + u * (u1 - u0), v0 + v * (v1 - v0)) in the atlas.
+struct atlas_region {
+  float u0;
+  float v0;
+  float u1;
+  float v1;
+  // Size of the image, in pixels.
+  gl::width width;
+  gl::height height;
+
+  [[nodiscard]] constexpr float u(float s) const noexcept {
+    return u0 + s * (u1 - u0);
+  }
+  [[nodiscard]] constexpr float v(float t) const noexcept {
+    return v0 + t * (v1 - v0);
+  }
+
+  // Rewrites in place the texture coordinates of 'count' vertices laid out
+  // as 'layout', the attribute at index 'Attribute' being the 2 component
+  // texture coordinates.
+  //
+  //    using layout = packed<group<3>, group<3>, group<2>>;
+  //    atlas.regions[face].remap<2>(layout{}, vertices);
+  template <std::size_t Attribute, std::size_t... Args, class T>
+  void remap([[maybe_unused]] packed<group<Args>...> layout,
+             T* vertices,
+             std::size_t count) const noexcept {
+    static_assert(detail::at_v<Attribute, Args...> == 2,
+                  "Texture coordinates must have 2 components");
+    constexpr std::size_t stride = (Args + ...);
+    constexpr std::size_t offset = detail::sum_to_v<Attribute, Args...>;
+    for (std::size_t i = 0; i < count; ++i) {
+      T* uv = vertices + i * stride + offset;  // NOLINT
+      uv[0] = static_cast<T>(u(static_cast<float>(uv[0])));  // NOLINT
+      uv[1] = static_cast<T>(v(static_cast<float>(uv[1])));  // NOLINT
+    }
+  }
+
+  template <std::size_t Attribute, class Layout, class T, std::size_t N>
+  void remap(Layout layout, T (&vertices)[N]) const noexcept {  // NOLINT
+    remap<Attribute>(layout, vertices, N / layout_stride(layout));
+  }
+
+ private:
+  template <std::size_t... Args>
+  constexpr static std::size_t layout_stride(
+      [[maybe_unused]] packed<group<Args>...> layout) noexcept {
+    return (Args + ...);
+  }
+};
+
+// Single texture holding many small images, so that everything drawn with
+// them shares one binding. See texture_atlas_builder.
+struct texture_atlas {
+  texture_2d texture;
+  gl::width width;
+  gl::height height;
+  // In the order the images were added.
+  std::vector<atlas_region> regions;
+};
+
+namespace detail {
+struct atlas_rect {
+  unsigned int x;
+  unsigned int y;
+};
+
+// Skyline bottom-left bin packing: the top of the rectangles placed so far is
+// kept as a list of horizontal segments, and each rectangle goes where its
+// top edge ends up the lowest. Not as tight as MaxRects, but linear in the
+// number of segments, which stays small.
+class skyline_packer {
+ public:
+  skyline_packer(unsigned int width, unsigned int height)
+      : _width{width}, _height{height}, _skyline{{0, 0, width}} {}
+
+  std::optional<atlas_rect> insert(unsigned int width, unsigned int height) {
+    std::size_t best = _skyline.size();
+    unsigned int best_top = ~0U;
+    unsigned int best_span = ~0U;
+    unsigned int best_y = 0;
+    for (std::size_t i = 0; i < _skyline.size(); ++i) {
+      const auto y = fit(i, width, height);
+      if (!y) {
+        continue;
+      }
+      const unsigned int top = *y + height;
+      if (top < best_top ||
+          (top == best_top && _skyline[i].width < best_span)) {
+        best = i;
+        best_top = top;
+        best_span = _skyline[i].width;
+        best_y = *y;
+      }
+    }
+    if (best == _skyline.size()) {
+      return std::nullopt;
+    }
+    const unsigned int x = _skyline[best].x;
+    place(best, x, best_top, width);
+    return atlas_rect{x, best_y};
+  }
+
+ private:
+  struct segment {
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+  };
+
+  // Height at which a rectangle starting at segment 'index' rests, if it
+  // fits at all.
+  [[nodiscard]] std::optional<unsigned int> fit(std::size_t index,
+                                                unsigned int width,
+                                                unsigned int height) const {
+    const unsigned int x = _skyline[index].x;
+    if (x + width > _width) {
+      return std::nullopt;
+    }
+    unsigned int y = 0;
+    unsigned int covered = 0;
+    for (std::size_t i = index; covered < width; ++i) {
+      y = std::max(y, _skyline[i].y);
+      if (y + height > _height) {
+        return std::nullopt;
+      }
+      covered += _skyline[i].width;
+    }
+    return y;
+  }
+
+  void place(std::size_t index,
+             unsigned int x,
+             unsigned int top,
+             unsigned int width) {
+    _skyline.insert(_skyline.begin() + static_cast<std::ptrdiff_t>(index),
+                    segment{x, top, width});
+    // Trim the segments now under the new one.
+    const unsigned int end = x + width;
+    for (std::size_t i = index + 1; i < _skyline.size();) {
+      auto& s = _skyline[i];
+      if (s.x >= end) {
+        break;
+      }
+      const unsigned int hidden = std::min(end - s.x, s.width);
+      s.x += hidden;
+      s.width -= hidden;
+      if (s.width == 0) {
+        _skyline.erase(_skyline.begin() + static_cast<std::ptrdiff_t>(i));
+      }
+      else {
+        break;
+      }
+    }
+    // Merge neighbours at the same height.
+    for (std::size_t i = 0; i + 1 < _skyline.size();) {
+      if (_skyline[i].y == _skyline[i + 1].y) {
+        _skyline[i].width += _skyline[i + 1].width;
+        _skyline.erase(_skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+      }
+      else {
+        ++i;
+      }
+    }
+  }
+
+  unsigned int _width;
+  unsigned int _height;
+  std::vector<segment> _skyline;
+};
+
+struct atlas_layout {
+  unsigned int width;
+  unsigned int height;
+  // Top left corner of each padded image, in the order of the input.
+  std::vector<atlas_rect> positions;
+};
+
+// Finds the smallest power of two atlas, growing one side at a time, that
+// holds rectangles of the given sizes. Tall rectangles are placed first.
+inline std::optional<atlas_layout> pack_atlas(
+    const std::vector<std::pair<unsigned int, unsigned int>>& sizes,
+    unsigned int max_size) {
+  std::vector<std::size_t> order(sizes.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&](auto lhs, auto rhs) {
+    return sizes[lhs].second != sizes[rhs].second
+               ? sizes[lhs].second > sizes[rhs].second
+               : sizes[lhs].first > sizes[rhs].first;
+  });
+
+  std::size_t area = 0;
+  unsigned int widest = 1;
+  unsigned int tallest = 1;
+  for (const auto& [w, h] : sizes) {
+    area += static_cast<std::size_t>(w) * h;
+    widest = std::max(widest, w);
+    tallest = std::max(tallest, h);
+  }
+  unsigned int width = 1;
+  unsigned int height = 1;
+  while (width < widest || static_cast<std::size_t>(width) * width < area) {
+    width *= 2;
+  }
+  while (height < tallest || static_cast<std::size_t>(width) * height < area) {
+    height *= 2;
+  }
+
+  while (width <= max_size && height <= max_size) {
+    skyline_packer packer{width, height};
+    atlas_layout layout{width, height, std::vector<atlas_rect>(sizes.size())};
+    bool packed = true;
+    for (auto i : order) {
+      const auto rect = packer.insert(sizes[i].first, sizes[i].second);
+      if (!rect) {
+        packed = false;
+        break;
+      }
+      layout.positions[i] = *rect;
+    }
+    if (packed) {
+      return layout;
+    }
+    if (width <= height) {
+      width *= 2;
+    }
+    else {
+      height *= 2;
+    }
+  }
+  return std::nullopt;
+}
+
+// Copies an image into the atlas at (x + padding, y + padding), its edge
+// pixels repeated over the padding around it so that filtering near the
+// border of the image doesn't pick up its neighbours.
+inline void blit_extruded(const unsigned char* image,
+                          unsigned int width,
+                          unsigned int height,
+                          unsigned int channels,
+                          unsigned int padding,
+                          unsigned char* atlas,
+                          unsigned int atlas_width,
+                          atlas_rect position) noexcept {
+  const std::size_t row = static_cast<std::size_t>(width) * channels;
+  const std::size_t atlas_row =
+      static_cast<std::size_t>(atlas_width) * channels;
+  for (unsigned int y = 0; y < height + 2 * padding; ++y) {
+    const unsigned int source_y =
+        std::min(y < padding ? 0 : y - padding, height - 1);
+    const unsigned char* source = image + source_y * row;  // NOLINT
+    unsigned char* destination =
+        atlas + (position.y + y) * atlas_row +             // NOLINT
+        static_cast<std::size_t>(position.x) * channels;
+    for (unsigned int x = 0; x < padding; ++x) {
+      std::memcpy(destination + x * channels, source, channels);  // NOLINT
+      std::memcpy(destination + (padding + width + x) * channels,  // NOLINT
+                  source + row - channels,                         // NOLINT
+                  channels);
+    }
+    std::memcpy(destination + padding * channels, source, row);  // NOLINT
+  }
+}
+}  // namespace detail
+
+// Packs many small images, such as sprites, icons or glyphs, into a single
+// texture_2d, along with the texture coordinates of each image in it.
+//
+// Images are kept on the CPU until build() packs them, with 'padding' pixels
+// around each one, into the smallest power of two texture that holds them
+// all, then uploads it with mipmaps built by build_mip_chain(). The padding
+// repeats the edge pixels of each image, so that bilinear filtering, and the
+// mipmap levels down to about log2(padding), don't bleed from one image into
+// the other.
+//
+// All the images must have the component count of TextureTraits' format.
+//
+//    texture_atlas_builder<texture_rgba> builder;
+//    auto face = builder.add(texture_filename{"assets/awesomeface.png"});
+//    auto atlas = builder.build(texture_options::repeat_linear).value();
+//    atlas.regions[face.value()].remap<2>(layout{}, vertices);
+template <class TextureTraits>
+class texture_atlas_builder {
+ public:
+  // 4096 is well within GL_MAX_TEXTURE_SIZE on any hardware that runs
+  // OpenGL 3.3, and 2 pixels cover bilinear filtering and the first mipmap.
+  explicit texture_atlas_builder(unsigned int padding = 2,
+                                 unsigned int max_size = 4096) noexcept
+      : _padding{padding}, _max_size{max_size} {}
+
+  // Returns the index of the image in texture_atlas::regions.
+  std::size_t add(stbi_wrapper<TextureTraits> image) {
+    _images.push_back(std::move(image));
+    return _images.size() - 1;
+  }
+
+  template <class T>
+  result<std::size_t, loading_error> add(const texture_filename<T>& filename,
+                                         bool flip = true) {
+    auto file = mapped_file::open(filename.c_str());
+    if (!file.has_value()) {
+      return failure{std::move(file).error()};
+    }
+    return add(
+        detail::decode_image(
+            file.value().data(), file.value().size(), flip, channels()),
+        filename.c_str());
+  }
+
+  result<std::size_t, loading_error> add(const texture_embedded& texture,
+                                         bool flip = true) {
+    const auto& file = texture.file();
+    return add(detail::decode_image(file.data, file.size, flip, channels()),
+               std::string{file.name}.c_str());
+  }
+
+  // Packs and uploads the images, then releases them. Returns nothing, and
+  // keeps the images, if they don't fit in max_size x max_size.
+  template <class TextureOptions>
+  [[nodiscard]] std::optional<texture_atlas> build(TextureOptions&& options,
+                                                   mip_options mips = {}) {
+    std::vector<std::pair<unsigned int, unsigned int>> sizes;
+    sizes.reserve(_images.size());
+    for (const auto& image : _images) {
+      sizes.emplace_back(image.width().value + 2 * _padding,
+                         image.height().value + 2 * _padding);
+    }
+    const auto layout = detail::pack_atlas(sizes, _max_size);
+    if (!layout) {
+      return std::nullopt;
+    }
+
+    const auto c = static_cast<unsigned int>(channels());
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(layout->width) *
+                                      layout->height * c);
+    const auto w = static_cast<float>(layout->width);
+    const auto h = static_cast<float>(layout->height);
+    std::vector<atlas_region> regions;
+    regions.reserve(_images.size());
+    for (std::size_t i = 0; i < _images.size(); ++i) {
+      const auto& image = _images[i];
+      const auto position = layout->positions[i];
+      detail::blit_extruded(image.texture(),
+                            image.width().value,
+                            image.height().value,
+                            c,
+                            _padding,
+                            pixels.data(),
+                            layout->width,
+                            position);
+      const auto x = static_cast<float>(position.x + _padding);
+      const auto y = static_cast<float>(position.y + _padding);
+      regions.push_back(
+          atlas_region{x / w,
+                       y / h,
+                       (x + static_cast<float>(image.width().value)) / w,
+                       (y + static_cast<float>(image.height().value)) / h,
+                       image.width(),
+                       image.height()});
+    }
+
+    const auto chain = build_mip_chain(
+        pixels.data(), layout->width, layout->height, c, mips);
+    _images.clear();
+    return texture_atlas{texture_2d{TextureTraits::image_format(),
+                                    chain.image_levels(),
+                                    std::forward<TextureOptions>(options)},
+                         gl::width{layout->width},
+                         gl::height{layout->height},
+                         std::move(regions)};
+  }
+
+  [[nodiscard]] std::optional<texture_atlas> build() {
+    return build(texture_options::no_options);
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return _images.size(); }
+
+ private:
+  static int channels() noexcept {
+    return static_cast<int>(
+        gl::component_count(TextureTraits::image_format()));
+  }
+
+  result<std::size_t, loading_error> add(detail::decoded_image image,
+                                         const char* name) {
+    if (!image.pixels) {
+      const char* reason = stbi_failure_reason();
+      return failure{name, reason != nullptr ? reason : "empty file"};
+    }
+    return success{add(
+        stbi_wrapper<TextureTraits>{image.pixels.release(),
+                                    static_cast<unsigned int>(image.width),
+                                    static_cast<unsigned int>(image.height),
+                                    image.channels})};
+  }
+
+  unsigned int _padding;
+  unsigned int _max_size;
+  std::vector<stbi_wrapper<TextureTraits>> _images;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_TEXTURE_ATLAS_HEADER
\ No newline at end of file
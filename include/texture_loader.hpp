@@ -0,0 +1,346 @@
+#ifndef GUARD_DPSG_TEXTURE_LOADER_HEADER
+#define GUARD_DPSG_TEXTURE_LOADER_HEADER
+
+#include "embedded.hpp"
+#include "loading_error.hpp"
+#include "mapped_file.hpp"
+#include "result.hpp"
+#include "stbi_wrapper.hpp"
+#include "texture.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dpsg {
+
+namespace detail {
+// Unbounded multiple producers, single consumer queue. Producers push nodes
+// with a compare and swap on the head of a list, and the consumer takes the
+// whole list at once, so there is no ABA problem and no node is ever touched
+// by two threads at the same time.
+template <class T>
+class mpsc_queue {
+ public:
+  mpsc_queue() noexcept = default;
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue(mpsc_queue&&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(mpsc_queue&&) = delete;
+  ~mpsc_queue() noexcept {
+    auto* n = _head.exchange(nullptr, std::memory_order_acquire);
+    while (n != nullptr) {
+      delete std::exchange(n, n->next);  // NOLINT
+    }
+  }
+
+  void push(T value) {
+    auto* n = new node{std::move(value), nullptr};  // NOLINT
+    n->next = _head.load(std::memory_order_relaxed);
+    while (!_head.compare_exchange_weak(n->next,
+                                        n,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  // Appends everything pushed so far to 'out', in the order it was pushed.
+  // Must only be called from one thread at a time.
+  template <class Container>
+  void pop_all(Container& out) {
+    auto* n = _head.exchange(nullptr, std::memory_order_acquire);
+    node* reversed = nullptr;
+    while (n != nullptr) {
+      reversed = std::exchange(n, std::exchange(n->next, reversed));
+    }
+    while (reversed != nullptr) {
+      out.push_back(std::move(reversed->value));
+      delete std::exchange(reversed, reversed->next);  // NOLINT
+    }
+  }
+
+ private:
+  struct node {
+    T value;
+    node* next;
+  };
+
+  std::atomic<node*> _head{nullptr};
+};
+
+// State shared between a pending_texture and the loader. 'texture' is only
+// written by the thread calling texture_loader::upload(), before 'done' is
+// set.
+struct texture_request {
+  std::function<std::optional<texture_2d>(decoded_image&&)> create;
+  std::optional<result<texture_2d, loading_error>> texture;
+  std::atomic<bool> done{false};
+};
+
+struct decode_job {
+  std::shared_ptr<texture_request> request;
+  std::string filename;
+  const embedded_file* embedded;
+  bool flip;
+  int requested_channels;
+};
+
+struct decoded_job {
+  std::shared_ptr<texture_request> request;
+  std::string filename;
+  decoded_image image;
+  std::optional<loading_error> error;
+};
+}  // namespace detail
+
+// Texture being decoded by a texture_loader, or waiting for its upload.
+class pending_texture {
+ public:
+  // Whether get() can be called. Can be called from any thread.
+  [[nodiscard]] bool ready() const noexcept {
+    return _request->done.load(std::memory_order_acquire);
+  }
+
+  // The texture, or the reason it couldn't be loaded. Can only be called
+  // once, after ready() returned true.
+  [[nodiscard]] result<texture_2d, loading_error> get() noexcept {
+    assert(ready());
+    auto request = std::exchange(_request, nullptr);
+    return std::move(*request->texture);
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return _request != nullptr; }
+
+ private:
+  friend class texture_loader;
+  explicit pending_texture(
+      std::shared_ptr<detail::texture_request> request) noexcept
+      : _request{std::move(request)} {}
+
+  std::shared_ptr<detail::texture_request> _request;
+};
+
+// Loads textures without blocking the rendering thread. Files are read and
+// decoded by a pool of worker threads, and the decoded images are handed back
+// through a lock free queue. Creating the textures needs the GL context, so
+// it is done by upload(), which must be called on the rendering thread,
+// typically once per frame, with the time it may spend uploading.
+//
+// Textures are flipped, or not, per request: workers only set stb's flag for
+// their own thread.
+//
+//    texture_loader loader;
+//    auto wall = loader.load<texture_rgb>(texture_filename{"wall.jpg"},
+//                                         texture_options::repeat_linear);
+//    while (!window.should_close()) {
+//      loader.upload(std::chrono::milliseconds{2});
+//      if (wall.ready()) {
+//        texture = wall.get().value();
+//      }
+//      ...
+//    }
+class texture_loader {
+ public:
+  explicit texture_loader(std::size_t threads = default_threads()) {
+    threads = threads == 0 ? 1 : threads;
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      _workers.emplace_back([this] { work(); });
+    }
+  }
+  texture_loader(const texture_loader&) = delete;
+  texture_loader(texture_loader&&) = delete;
+  texture_loader& operator=(const texture_loader&) = delete;
+  texture_loader& operator=(texture_loader&&) = delete;
+  ~texture_loader() noexcept {
+    {
+      std::lock_guard lock{_mutex};
+      _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers) {
+      worker.join();
+    }
+  }
+
+  // Queues the file for decoding. Can be called from any thread.
+  template <class TextureTraits,
+            class T,
+            class TextureOptions = decltype(texture_options::no_options)&>
+  [[nodiscard]] pending_texture load(
+      const texture_filename<T>& filename,
+      TextureOptions&& options = texture_options::no_options,
+      bool flip = true,
+      int requested_channels = 0) {
+    return submit<TextureTraits>(filename.c_str(),
+                                 nullptr,
+                                 std::forward<TextureOptions>(options),
+                                 flip,
+                                 requested_channels);
+  }
+
+  template <class TextureTraits,
+            class TextureOptions = decltype(texture_options::no_options)&>
+  [[nodiscard]] pending_texture load(
+      const texture_embedded& texture,
+      TextureOptions&& options = texture_options::no_options,
+      bool flip = true,
+      int requested_channels = 0) {
+    return submit<TextureTraits>(std::string{texture.file().name},
+                                 &texture.file(),
+                                 std::forward<TextureOptions>(options),
+                                 flip,
+                                 requested_channels);
+  }
+
+  // Creates the decoded textures, oldest first, until 'budget' is spent. At
+  // least one texture is created per call, if any is available, so that
+  // loading always progresses. Returns the number of textures still being
+  // decoded or waiting for upload.
+  std::size_t upload(std::chrono::microseconds budget) {
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    _decoded.pop_all(_uploads);
+    bool first = true;
+    while (!_uploads.empty() &&
+           (first || std::chrono::steady_clock::now() < deadline)) {
+      auto job = std::move(_uploads.front());
+      _uploads.pop_front();
+      finish(job);
+      first = false;
+    }
+    return _in_flight.load(std::memory_order_relaxed);
+  }
+
+  // Number of textures still being decoded or waiting for upload.
+  [[nodiscard]] std::size_t in_flight() const noexcept {
+    return _in_flight.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] static std::size_t default_threads() noexcept {
+    const auto cores = std::thread::hardware_concurrency();
+    // One core is left to the rendering thread.
+    return cores > 1 ? cores - 1 : 1;
+  }
+
+ private:
+  template <class TextureTraits, class TextureOptions>
+  pending_texture submit(std::string filename,
+                         const embedded_file* embedded,
+                         TextureOptions&& options,
+                         bool flip,
+                         int requested_channels) {
+    auto request = std::make_shared<detail::texture_request>();
+    request->create =
+        [options = std::decay_t<TextureOptions>{std::forward<TextureOptions>(
+             options)}](detail::decoded_image&& image) {
+          return detail::make_texture<TextureTraits>(image.pixels.release(),
+                                                     image.width,
+                                                     image.height,
+                                                     image.channels,
+                                                     options);
+        };
+    _in_flight.fetch_add(1, std::memory_order_relaxed);
+    {
+      std::lock_guard lock{_mutex};
+      _jobs.push_back(detail::decode_job{request,
+                                         std::move(filename),
+                                         embedded,
+                                         flip,
+                                         requested_channels});
+    }
+    _wake.notify_one();
+    return pending_texture{std::move(request)};
+  }
+
+  void work() {
+    for (;;) {
+      std::unique_lock lock{_mutex};
+      _wake.wait(lock, [this] { return _stop || !_jobs.empty(); });
+      if (_stop) {
+        return;
+      }
+      auto job = std::move(_jobs.front());
+      _jobs.pop_front();
+      lock.unlock();
+      _decoded.push(decode(std::move(job)));
+    }
+  }
+
+  static detail::decoded_job decode(detail::decode_job job) {
+    detail::decoded_job decoded{
+        std::move(job.request), std::move(job.filename), {}, std::nullopt};
+    // Nobody is waiting for this texture anymore.
+    if (decoded.request.use_count() == 1) {
+      return decoded;
+    }
+    if (job.embedded != nullptr) {
+      decoded.image = detail::decode_image(job.embedded->data,
+                                           job.embedded->size,
+                                           job.flip,
+                                           job.requested_channels);
+    }
+    else {
+      auto file = mapped_file::open(decoded.filename.c_str());
+      if (!file.has_value()) {
+        decoded.error.emplace(std::move(file).error());
+        return decoded;
+      }
+      decoded.image = detail::decode_image(file.value().data(),
+                                           file.value().size(),
+                                           job.flip,
+                                           job.requested_channels);
+    }
+    if (!decoded.image.pixels) {
+      // The failure reason is kept per thread by stb.
+      const char* reason = stbi_failure_reason();
+      decoded.error.emplace(decoded.filename.c_str(),
+                            reason != nullptr ? reason : "empty file");
+    }
+    return decoded;
+  }
+
+  // Rendering thread only.
+  void finish(detail::decoded_job& job) {
+    auto& request = *job.request;
+    if (job.request.use_count() > 1) {
+      if (job.error) {
+        request.texture.emplace(failure{std::move(*job.error)});
+      }
+      else {
+        auto texture = request.create(std::move(job.image));
+        request.texture.emplace(success{std::move(texture).value()});
+      }
+      request.done.store(true, std::memory_order_release);
+    }
+    _in_flight.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  std::atomic<std::size_t> _in_flight{0};
+  detail::mpsc_queue<detail::decoded_job> _decoded;
+
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::deque<detail::decode_job> _jobs;
+  bool _stop{false};
+
+  // Rendering thread only.
+  std::deque<detail::decoded_job> _uploads;
+
+  std::vector<std::thread> _workers;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_TEXTURE_LOADER_HEADER
\ No newline at end of file
@@ -0,0 +1,181 @@
+#ifndef GUARD_DPSG_TEXTURE_STREAM_HEADER
+#define GUARD_DPSG_TEXTURE_STREAM_HEADER
+
+#include "buffers.hpp"
+#include "opengl.hpp"
+#include "texture.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dpsg {
+
+namespace detail {
+// Upload recorded by a texture_stream, applied once the staging memory is
+// visible to the GL.
+struct staged_update {
+  void (*apply)(const staged_update&) noexcept;
+  gl::texture_id texture;
+  gl::x_offset x;
+  gl::y_offset y;
+  gl::width width;
+  gl::height height;
+  gl::image_format format;
+  gl::byte_offset offset;
+};
+
+template <class Traits, class T>
+void apply_staged_update(const staged_update& u) noexcept {
+  Traits::bind(u.texture);
+  // With a pixel unpack buffer bound, the pointer is an offset in the buffer.
+  Traits::update_image(u.x,
+                       u.y,
+                       u.width,
+                       u.height,
+                       u.format,
+                       reinterpret_cast<const T*>(  // NOLINT
+                           static_cast<std::uintptr_t>(u.offset.value)));
+}
+
+// Rows are padded to 4 bytes, the default unpack alignment.
+constexpr inline std::size_t staged_row_size(std::size_t row_size) noexcept {
+  return (row_size + 3) / 4 * 4;
+}
+}  // namespace detail
+
+// Streams texture content that changes every frame, such as video or
+// procedurally generated images, without stalling on the copy.
+//
+// Pixels are written into a ring of pixel unpack buffers (a
+// streaming_buffer bound to buffer_type::pixel_unpack), and the texture
+// updates are sourced from there at end_frame(). The driver then copies from
+// GPU visible memory asynchronously, and each region of the ring is only
+// written again once the GPU is done with it.
+//
+// Every texture updated during a frame must outlive its end_frame().
+//
+//    texture_2d video{width, height, format, texture_options::repeat_linear};
+//    texture_stream<> stream{gl::byte_size{width * height * 4}};
+//    while (!window.should_close()) {
+//      stream.begin_frame();
+//      stream.update(video, {0}, {0}, width, height, format, decoder.frame());
+//      stream.end_frame();
+//      ...
+//    }
+template <std::size_t Regions = 3>
+class texture_stream {
+ public:
+  explicit texture_stream(gl::byte_size region_size) noexcept
+      : _staging{gl::buffer_type::pixel_unpack, region_size} {
+    gl::unbind_buffer(gl::buffer_type::pixel_unpack);
+  }
+
+  // Waits for the GPU to release the next staging region.
+  void begin_frame() noexcept {
+    _staging.begin_frame();
+    // The region stays mapped, but client memory uploads made elsewhere
+    // during the frame must not source from the staging buffer.
+    gl::unbind_buffer(gl::buffer_type::pixel_unpack);
+  }
+
+  // Reserves room for a region of 'texture' and returns where its pixels
+  // must be written, rows first and each row starting on a 4 byte boundary
+  // (see row_size()). Returns nullptr if the staging region is full for this
+  // frame. Only valid between begin_frame() and end_frame().
+  template <class T = gl::ubyte_t, class Traits>
+  [[nodiscard]] void* stage(const basic_texture<Traits>& texture,
+                            gl::x_offset x,
+                            gl::y_offset y,
+                            gl::width width,
+                            gl::height height,
+                            gl::image_format format) noexcept {
+    const std::size_t size =
+        row_size<T>(width, format) * static_cast<std::size_t>(height.value);
+    auto allocation =
+        _staging.allocate(gl::byte_size{static_cast<gl::size_t>(size)},
+                          alignof(T) < 4 ? 4 : alignof(T));
+    if (!allocation) {
+      return nullptr;
+    }
+    _updates.push_back(
+        detail::staged_update{&detail::apply_staged_update<Traits, T>,
+                              texture.id(),
+                              x,
+                              y,
+                              width,
+                              height,
+                              format,
+                              allocation->offset});
+    return allocation->data;
+  }
+
+  // Copies tightly packed pixels into the staging region. Returns false if
+  // the region is full for this frame, in which case nothing is updated.
+  template <class T, class Traits>
+  bool update(const basic_texture<Traits>& texture,
+              gl::x_offset x,
+              gl::y_offset y,
+              gl::width width,
+              gl::height height,
+              gl::image_format format,
+              const T* pixels) noexcept {
+    auto* destination = static_cast<std::byte*>(
+        stage<T>(texture, x, y, width, height, format));
+    if (destination == nullptr) {
+      return false;
+    }
+    const std::size_t packed =
+        static_cast<std::size_t>(width.value) * gl::component_count(format) *
+        sizeof(T);
+    const std::size_t staged = row_size<T>(width, format);
+    if (packed == staged) {
+      std::memcpy(destination, pixels, packed * height.value);
+      return true;
+    }
+    const auto* source = reinterpret_cast<const std::byte*>(pixels);  // NOLINT
+    for (unsigned int row = 0; row < height.value; ++row) {
+      std::memcpy(destination + row * staged,  // NOLINT
+                  source + row * packed,       // NOLINT
+                  packed);
+    }
+    return true;
+  }
+
+  // Makes the staged pixels visible to the GL, copies them to their
+  // textures and fences the region.
+  void end_frame() noexcept {
+    _staging.commit();
+    if (!_updates.empty()) {
+      _staging.bind();
+      for (const auto& u : _updates) {
+        u.apply(u);
+      }
+      gl::unbind_buffer(gl::buffer_type::pixel_unpack);
+      _updates.clear();
+    }
+    _staging.end_frame();
+  }
+
+  // Bytes between the start of two rows in staging memory.
+  template <class T = gl::ubyte_t>
+  [[nodiscard]] constexpr static std::size_t row_size(
+      gl::width width,
+      gl::image_format format) noexcept {
+    return detail::staged_row_size(static_cast<std::size_t>(width.value) *
+                                   gl::component_count(format) * sizeof(T));
+  }
+
+  [[nodiscard]] gl::byte_size region_size() const noexcept {
+    return _staging.region_size();
+  }
+
+ private:
+  streaming_buffer<Regions> _staging;
+  std::vector<detail::staged_update> _updates;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_TEXTURE_STREAM_HEADER
\ No newline at end of file
@@ -0,0 +1,207 @@
+#ifndef GUARD_DPSG_TEXTURE_UNITS_HEADER
+#define GUARD_DPSG_TEXTURE_UNITS_HEADER
+
+#include "opengl.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace dpsg {
+
+// Hands out texture units to textures and remembers what each unit holds, so
+// that drawing again with a resident texture binds nothing, and a material's
+// textures keep their units from one draw to the next.
+//
+// Units are assigned in least recently used order among [first, first +
+// count()). The units below 'first' are left to the rest of the code: the
+// texture constructors, update() and anything else calling bind() directly
+// work on the active unit, which this class never leaves inside its range.
+//
+// When the context supports it (GL 4.4 or ARB_multi_bind), the units changed
+// by a call are rebound with a single glBindTextures. Otherwise each one goes
+// through glActiveTexture and glBindTexture, and the active unit is moved
+// back to unit 0 afterwards.
+//
+// What a unit holds is only known as long as it is modified through this
+// class. Call forget() after binding textures to its units by other means,
+// and forget(id) before deleting a texture that may still be resident, as
+// the driver may hand its name out again.
+//
+//    texture_units units;
+//    ...
+//    diffuse_u.bind(diffuse, units);
+//    // or, for textures drawn together
+//    auto [d, n] = units.bind(diffuse, normals);
+class texture_units {
+ public:
+  // Uses every unit from 'first' up to what the context supports.
+  explicit texture_units(gl::texture_name first = gl::texture_name::_1) noexcept
+      : texture_units(first, supported_units(first)) {}
+
+  texture_units(gl::texture_name first, std::size_t count) noexcept
+      : _first{first},
+        _count{std::min(count, supported_units(first))}
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_multi_bind)
+        ,
+        _multi_bind{gl::has_multi_bind()}
+#endif
+  {
+  }
+
+  // Makes 'texture' resident in some unit and returns that unit. count() must
+  // not be 0.
+  template <class Texture>
+  gl::texture_name bind(const Texture& texture) noexcept {
+    ++_clock;
+    const auto name = place(Texture::texture_target, texture.id());
+    flush();
+    return name;
+  }
+
+  // Makes all the textures resident at once, in different units, so that
+  // none of them evicts another. At most count() textures.
+  template <class... Textures>
+  std::array<gl::texture_name, sizeof...(Textures)> bind(
+      const Textures&... textures) noexcept {
+    static_assert(sizeof...(Textures) <= max_units,
+                  "More textures than texture units");
+    assert(sizeof...(Textures) <= _count);
+    ++_clock;
+    std::array<gl::texture_name, sizeof...(Textures)> names{
+        place(Textures::texture_target, textures.id())...};
+    flush();
+    return names;
+  }
+
+  // Whether 'texture' currently sits in a unit.
+  [[nodiscard]] bool resident(gl::texture_id texture) const noexcept {
+    return std::any_of(_units.begin(),
+                       _units.begin() + _count,
+                       [texture](const unit& u) {
+                         return u.texture.value == texture.value;
+                       });
+  }
+
+  // Forgets where 'texture' is, e.g. before deleting it.
+  void forget(gl::texture_id texture) noexcept {
+    for (std::size_t i = 0; i < _count; ++i) {
+      if (_units[i].texture.value == texture.value) {
+        _units[i] = unit{};
+      }
+    }
+  }
+
+  // Forgets everything, after units were rebound behind this object's back.
+  void forget() noexcept { _units.fill(unit{}); }
+
+  [[nodiscard]] std::size_t count() const noexcept { return _count; }
+
+  [[nodiscard]] const gl::state_cache_stats& stats() const noexcept {
+    return _stats;
+  }
+
+ private:
+  // texture_name stops at GL_TEXTURE31.
+  constexpr static inline std::size_t max_units = 32;
+
+  struct unit {
+    gl::texture_id texture{0};
+    gl::texture_target target{gl::texture_target::_2d};
+    std::uint64_t last_use{0};
+  };
+
+  static std::size_t supported_units(gl::texture_name first) noexcept {
+    gl::int_t supported{0};
+    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &supported);
+    const auto offset =
+        static_cast<std::size_t>(first) - static_cast<std::size_t>(GL_TEXTURE0);
+    const auto total =
+        std::min(static_cast<std::size_t>(std::max(supported, 0)), max_units);
+    return total > offset ? total - offset : 0;
+  }
+
+  [[nodiscard]] gl::texture_name name(std::size_t index) const noexcept {
+    return static_cast<gl::texture_name>(static_cast<gl::enum_t>(_first) +
+                                         static_cast<gl::enum_t>(index));
+  }
+
+  gl::texture_name place(gl::texture_target target,
+                         gl::texture_id texture) noexcept {
+    // Otherwise unit 0 would be handed out, outside of the managed range, and
+    // never bound by flush().
+    assert(_count > 0);
+    std::size_t victim = 0;
+    for (std::size_t i = 0; i < _count; ++i) {
+      auto& u = _units[i];
+      if (u.texture.value == texture.value && u.target == target) {
+        u.last_use = _clock;
+        ++_stats.elided;
+        return name(i);
+      }
+      // Units already claimed by the current call are never evicted.
+      if (_units[victim].last_use == _clock ||
+          (u.last_use != _clock && u.last_use < _units[victim].last_use)) {
+        victim = i;
+      }
+    }
+    _units[victim] = unit{texture, target, _clock};
+    _dirty |= 1U << victim;
+    ++_stats.issued;
+    return name(victim);
+  }
+
+  void flush() noexcept {
+    if (_dirty == 0) {
+      return;
+    }
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_multi_bind)
+    if (_multi_bind) {
+      // One call over the span of changed units. The unchanged units in
+      // between are rebound to what they already hold.
+      std::size_t low = 0;
+      while ((_dirty & (1U << low)) == 0) {
+        ++low;
+      }
+      std::size_t high = max_units - 1;
+      while ((_dirty & (1U << high)) == 0) {
+        --high;
+      }
+      std::array<gl::texture_target, max_units> targets{};
+      std::array<gl::texture_id, max_units> textures{};
+      for (std::size_t i = low; i <= high; ++i) {
+        targets[i - low] = _units[i].target;
+        textures[i - low] = _units[i].texture;
+      }
+      gl::bind_textures(
+          name(low), high - low + 1, targets.data(), textures.data());
+      _dirty = 0;
+      return;
+    }
+#endif
+    for (std::size_t i = 0; i < _count; ++i) {
+      if ((_dirty & (1U << i)) != 0) {
+        gl::active_texture(name(i));
+        gl::bind_texture(_units[i].target, _units[i].texture);
+      }
+    }
+    gl::active_texture(gl::texture_name::_0);
+    _dirty = 0;
+  }
+
+  gl::texture_name _first;
+  std::size_t _count;
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_multi_bind)
+  bool _multi_bind;
+#endif
+  std::array<unit, max_units> _units{};
+  std::uint64_t _clock{0};
+  std::uint32_t _dirty{0};
+  gl::state_cache_stats _stats;
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_TEXTURE_UNITS_HEADER
\ No newline at end of file
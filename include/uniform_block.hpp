@@ -0,0 +1,212 @@
+#ifndef GUARD_DPSG_UNIFORM_BLOCK_HEADER
+#define GUARD_DPSG_UNIFORM_BLOCK_HEADER
+
+#include "buffers.hpp"
+#include "glsl_type.hpp"
+#include "opengl.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace dpsg {
+
+// Memory layouts of interface blocks, as described in section 7.6.2.2 of the
+// OpenGL 4.6 specification. std430 is only valid for shader storage blocks.
+struct std140 {};
+struct std430 {};
+
+// List of the data members making up a block, in declaration order:
+//
+//    struct frame {
+//      glm::mat4 projected_view;
+//      glm::vec3 camera_position;
+//    };
+//    template <>
+//    struct dpsg::block_members<frame>
+//        : dpsg::members<&frame::projected_view, &frame::camera_position> {};
+template <auto... Members>
+struct members {
+  using type = members;
+};
+
+template <class Struct>
+struct block_members;
+
+namespace detail {
+constexpr std::size_t round_up(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+template <class M>
+struct member_pointer_traits;
+template <class C, class T>
+struct member_pointer_traits<T C::*> {
+  using type = T;
+};
+
+// Alignment and size of T in the given layout. 'stride' is the distance
+// between two array elements or matrix columns.
+template <class T, class Layout, class = void>
+struct block_type_layout {
+ private:
+  using glsl = glsl_type<T>;
+  constexpr static inline std::size_t scalar_size =
+      sizeof(typename glsl::scalar_type);
+  static_assert(sizeof(T) == glsl::rows * glsl::columns * scalar_size,
+                "Block members must be tightly packed");
+
+  constexpr static inline std::size_t vector_alignment =
+      (glsl::rows == 1 ? 1 : glsl::rows == 2 ? 2 : 4) * scalar_size;
+
+ public:
+  constexpr static inline std::size_t column_size = glsl::rows * scalar_size;
+  constexpr static inline std::size_t columns = glsl::columns;
+  constexpr static inline std::size_t stride =
+      columns == 1 ? column_size
+      : std::is_same_v<Layout, std140>
+          ? round_up(vector_alignment, 4 * sizeof(gl::float_t))
+          : vector_alignment;
+  constexpr static inline std::size_t alignment =
+      columns == 1 ? vector_alignment : stride;
+  constexpr static inline std::size_t size =
+      columns == 1 ? column_size : columns * stride;
+
+  static void write(gl::ubyte_t* out, const T& value) noexcept {
+    const auto* in = reinterpret_cast<const gl::ubyte_t*>(&value);  // NOLINT
+    for (std::size_t c = 0; c < columns; ++c) {
+      std::memcpy(
+          out + c * stride, in + c * column_size, column_size);  // NOLINT
+    }
+  }
+};
+
+template <class T, std::size_t N, class Layout>
+struct block_type_layout<T[N], Layout> {  // NOLINT
+ private:
+  using element = block_type_layout<T, Layout>;
+  constexpr static inline std::size_t std140_alignment =
+      4 * sizeof(gl::float_t);
+
+ public:
+  constexpr static inline std::size_t alignment =
+      std::is_same_v<Layout, std140>
+          ? round_up(element::alignment, std140_alignment)
+          : element::alignment;
+  constexpr static inline std::size_t stride =
+      round_up(element::size, alignment);
+  constexpr static inline std::size_t size = N * stride;
+
+  static void write(gl::ubyte_t* out,
+                    const T (&value)[N]) noexcept {  // NOLINT
+    for (std::size_t i = 0; i < N; ++i) {
+      element::write(out + i * stride, value[i]);  // NOLINT
+    }
+  }
+};
+
+template <class Struct, class Layout, class Members>
+struct block_layout_impl;
+
+template <class Struct, class Layout, auto... Members>
+struct block_layout_impl<Struct, Layout, members<Members...>> {
+  template <auto M>
+  using member_layout = block_type_layout<
+      typename member_pointer_traits<decltype(M)>::type,
+      Layout>;
+
+  constexpr static inline std::array<std::size_t, sizeof...(Members)>
+      offsets = [] {
+        std::array<std::size_t, sizeof...(Members)> result{};
+        std::size_t end = 0;
+        std::size_t i = 0;
+        ((result[i] = round_up(end, member_layout<Members>::alignment),
+          end = result[i] + member_layout<Members>::size,
+          ++i),
+         ...);
+        return result;
+      }();
+
+  constexpr static inline std::size_t size = [] {
+    std::size_t end = 0;
+    ((end = round_up(end, member_layout<Members>::alignment) +
+            member_layout<Members>::size),
+     ...);
+    return round_up(end, 4 * sizeof(gl::float_t));
+  }();
+
+  static void pack(const Struct& s, gl::ubyte_t* out) noexcept {
+    std::size_t i = 0;
+    (member_layout<Members>::write(out + offsets[i++], s.*Members),  // NOLINT
+     ...);
+  }
+};
+}  // namespace detail
+
+// Offsets and size of Struct when laid out according to Layout, as computed
+// by the GLSL compiler for the matching block declaration. pack() converts
+// an instance to that representation.
+template <class Struct, class Layout = std140>
+struct block_layout
+    : detail::block_layout_impl<Struct,
+                                Layout,
+                                typename block_members<Struct>::type> {};
+
+// Backing storage for a uniform block. The data is packed in std140 on the
+// CPU side and sent with a single glBufferSubData, so values shared by
+// several programs (camera, lights...) are uploaded once per frame rather
+// than once per program and per draw.
+//
+//    uniform_block<frame> frame_block{gl::buffer_binding{0}};
+//    prog.uniform_block_binding("frame", gl::buffer_binding{0});
+//    ...
+//    frame_block.update(frame{cam.projected_view(), cam.position()});
+template <class Struct>
+class uniform_block {
+  using layout = block_layout<Struct, std140>;
+
+ public:
+  constexpr static inline gl::byte_size size{layout::size};
+
+  explicit uniform_block(gl::buffer_binding binding,
+                         gl::data_hint hint = gl::data_hint::dynamic_draw)
+      : _binding{binding} {
+    _buffer.bind(gl::buffer_type::uniform);
+    gl::buffer_data(gl::buffer_type::uniform, size, hint);
+    bind();
+  }
+
+  void update(const Struct& s) noexcept {
+    layout::pack(s, _staging.data());
+    _buffer.bind(gl::buffer_type::uniform);
+    gl::buffer_sub_data(gl::buffer_type::uniform,
+                        gl::byte_offset{0},
+                        size,
+                        static_cast<const gl::ubyte_t*>(_staging.data()));
+  }
+
+  // Attaches the buffer to its binding point again, in case something else
+  // was bound to it in the meantime.
+  void bind() const noexcept {
+    gl::bind_buffer_base(gl::buffer_type::uniform, _binding, _buffer.id());
+  }
+
+  [[nodiscard]] gl::buffer_binding binding() const noexcept {
+    return _binding;
+  }
+
+  [[nodiscard]] gl::generic_buffer_id id() const noexcept {
+    return _buffer.id();
+  }
+
+ private:
+  buffer _buffer;
+  gl::buffer_binding _binding;
+  std::array<gl::ubyte_t, layout::size> _staging{};
+};
+
+}  // namespace dpsg
+
+#endif  // GUARD_DPSG_UNIFORM_BLOCK_HEADER
\ No newline at end of file
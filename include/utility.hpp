@@ -1,6 +1,9 @@
 #ifndef GUARD_DPSG_UTILITY_HEADER
 #define GUARD_DPSG_UTILITY_HEADER
 
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
 #include <utility>
 
 namespace dpsg {
@@ -13,6 +16,17 @@ template <class F> struct on_scope_exit_t {
 
 template <class F> on_scope_exit_t(F &&f) -> on_scope_exit_t<F>;
 
+// 64 bit FNV-1a hash. Passing the result of a previous call as 'hash' hashes
+// the concatenation of the inputs.
+constexpr std::uint64_t fnv1a(std::string_view str,
+                              std::uint64_t hash = 0xcbf29ce484222325) {
+  for (char c : str) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
 enum class ExecutionStatus { Success = EXIT_SUCCESS, Failure = EXIT_FAILURE };
 
 } // namespace dpsg
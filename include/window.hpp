@@ -67,6 +67,10 @@ struct window_impl {
       return std::exchange(_window, nullptr);
     }
 
+    [[nodiscard]] static GLADloadproc proc_address_loader() noexcept {
+      return reinterpret_cast<GLADloadproc>(glfwGetProcAddress);  // NOLINT
+    }
+
     void make_context_current() const noexcept {
       glfwMakeContextCurrent(_window);
     }
@@ -0,0 +1,32 @@
+#version 330 core
+
+// Variants, selected with dpsg::shader_variants:
+//   COLOR     per vertex color at location 1
+//   TEXCOORD  texture coordinates at location 2, or 1 without COLOR
+
+layout (location = 0) in vec3 aPos;
+#ifdef COLOR
+layout (location = 1) in vec3 aColor;
+#endif
+#ifdef TEXCOORD
+#ifdef COLOR
+layout (location = 2) in vec2 aTexCoord;
+#else
+layout (location = 1) in vec2 aTexCoord;
+#endif
+out vec2 TexCoord;
+#endif
+
+out vec4 vertexColor;
+
+void main() {
+    gl_Position = vec4(aPos, 1.0);
+#ifdef COLOR
+    vertexColor = vec4(aColor, 1.0);
+#else
+    vertexColor = vec4(0.5, 0.0, 0.0, 1.0);
+#endif
+#ifdef TEXCOORD
+    TexCoord = aTexCoord;
+#endif
+}
\ No newline at end of file
@@ -3,10 +3,9 @@
 in vec3 fragment_normal;
 in vec3 fragment_position;
 
-uniform vec3 light_position;
-uniform vec3 light_color;
+#include "frame.glsl"
+
 uniform vec3 object_color;
-uniform vec3 camera_position;
 uniform float ambient;
 uniform float specular;
 uniform int shininess;
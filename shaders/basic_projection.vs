@@ -2,7 +2,8 @@
 
 layout (location = 0) in vec3 position;
 uniform mat4 model;
-uniform mat4 projected_view;
+
+#include "frame.glsl"
 
 void main() {
  gl_Position = projected_view * model * vec4(position, 1.0);
@@ -1,12 +0,0 @@
-#version 330 core
-
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aColor;
-
-out vec4 vertexColor;
-
-void main()
-{
-    gl_Position = vec4(aPos, 1.0);
-    vertexColor = vec4(aColor, 1.0);
-}
\ No newline at end of file
@@ -0,0 +1,8 @@
+// Per frame values, shared by every program through uniform_block<frame_data>
+// (see examples/lighting.cpp).
+layout (std140) uniform frame {
+    mat4 projected_view;
+    vec3 camera_position;
+    vec3 light_position;
+    vec3 light_color;
+};
\ No newline at end of file
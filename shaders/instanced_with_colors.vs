@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 colors;
+layout (location = 2) in mat4 model;
+
+out vec4 vertexColor;
+
+uniform mat4 projected_view;
+
+void main()
+{
+    gl_Position = projected_view * model * vec4(aPos, 1.0f);
+    vertexColor = colors;
+}
\ No newline at end of file
@@ -4,7 +4,8 @@ layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 
 uniform mat4 model;
-uniform mat4 projected_view;
+
+#include "frame.glsl"
 
 out vec3 fragment_position;
 out vec3 fragment_normal;